@@ -0,0 +1,79 @@
+#ifndef CAPTURE_FORMAT_H
+#define CAPTURE_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+  Raw receiver capture, written by CaptureRecorder and read by
+  tools/capturecat.
+
+  A file is one CaptureHeader followed by frames, little-endian. A frame
+  is a CaptureFrame and then length bytes exactly as the receiver sent
+  them. millis is when the sketch read the first of them; the rest came
+  after it at the line rate given in the header, so a replay can space
+  them out again.
+
+  A nonzero length is how much of the file is in use; the rest is space
+  LogWriter preallocated and has not written yet, which reads as zeros.
+*/
+
+#define CAPTURE_MAGIC "GCAP"
+#define CAPTURE_VERSION 1
+
+#define CAPTURE_SYNC 0xA5
+
+#define CAPTURE_FLAG_GAP 0x01 // bytes were lost before this frame
+
+#pragma pack(push, 1)
+
+struct CaptureHeader
+{
+  char magic[4];
+  uint8_t version;
+  uint8_t headerSize;
+  uint8_t frameHeaderSize;
+  uint8_t reserved0;
+  uint32_t baud;
+  uint32_t length; // bytes in use including the header, 0 if all of the file
+};
+
+struct CaptureFrame
+{
+  uint8_t sync;
+  uint8_t flags;
+  uint16_t length;
+  uint32_t millis;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(CaptureHeader) == 16, "CaptureHeader layout changed");
+static_assert(sizeof(CaptureFrame) == 8, "CaptureFrame layout changed, bump CAPTURE_VERSION");
+static_assert(offsetof(CaptureHeader, length) == 12, "CaptureHeader layout changed");
+
+inline void captureInitHeader(CaptureHeader &h, uint32_t baud)
+{
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, CAPTURE_MAGIC, sizeof(h.magic));
+  h.version = CAPTURE_VERSION;
+  h.headerSize = sizeof(CaptureHeader);
+  h.frameHeaderSize = sizeof(CaptureFrame);
+  h.baud = baud;
+}
+
+// How much of a file of size bytes holds the capture
+inline uint32_t captureLength(const CaptureHeader &h, uint32_t size)
+{
+  return h.length > 0 && h.length < size ? h.length : size;
+}
+
+// True if a reader of this version can take frames from the file
+inline bool captureCheckHeader(const CaptureHeader &h)
+{
+  return memcmp(h.magic, CAPTURE_MAGIC, sizeof(h.magic)) == 0 && h.version >= 1 &&
+         h.headerSize >= sizeof(CaptureHeader) && h.frameHeaderSize >= sizeof(CaptureFrame);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef CAPTURE_RECORDER_H
+#define CAPTURE_RECORDER_H
+
+#include "CaptureFormat.h"
+#include "LogWriter.h"
+
+// Most receiver bytes in one frame
+#ifndef CAPTURE_FRAME_SIZE
+#define CAPTURE_FRAME_SIZE 512
+#endif
+
+// Slack on the line rate before a late byte starts a new frame
+#define CAPTURE_FRAME_MS 20
+
+// File space allocated at a time, about 17 minutes at 9600 baud
+#ifndef CAPTURE_PREALLOC
+#define CAPTURE_PREALLOC (1024 * 1024UL)
+#endif
+
+/*
+  Records the receiver's byte stream to a capture file on its own
+  LogWriter, so the SD writes happen on a writer task in whole 4 KB
+  blocks.
+
+  write() takes the chunks the loop already reads for the parser and
+  copies each into the open frame, so the cost is one memcpy per chunk
+  and nothing per byte. A frame runs on while the bytes keep coming at
+  the line rate, so one stamp times them all. It is handed to the
+  LogWriter when it is full, or once the receiver has paused for more
+  than CAPTURE_FRAME_MS, as found by the next write() or poll().
+*/
+class CaptureRecorder
+{
+public:
+  CaptureRecorder();
+
+  // Opens the first free /capNNNN.gcap and starts the writer
+  bool begin(fs::FS &fs, uint32_t baud);
+  void end();
+  bool isOpen() const { return log.isOpen(); }
+  const char *path() const { return log.path(); }
+
+  void write(const uint8_t *data, size_t len);
+
+  // Marks the next frame as following lost bytes, e.g. a receiver overflow
+  void markGap() { gap = true; }
+
+  // Closes an old frame and applies the writer's age policy
+  void poll();
+
+  uint32_t bytesCaptured() const { return captured; }
+  uint32_t frames() const { return frameCount; }
+  uint32_t framesDropped() const { return dropped; }
+  const LogWriter &writer() const { return log; }
+
+private:
+  bool late(size_t len) const;
+  void closeFrame();
+
+  LogWriter log;
+  uint8_t frame[sizeof(CaptureFrame) + CAPTURE_FRAME_SIZE];
+  size_t used; // bytes after the frame header
+  uint32_t started;
+  uint32_t msPerKByte;
+  bool gap;
+
+  uint32_t captured;
+  uint32_t frameCount;
+  uint32_t dropped;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef GPS_RECEIVER_H
+#define GPS_RECEIVER_H
+
+#include "SpscRing.h"
+
+#if defined(ESP32) || defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <thread>
+#endif
+
+#ifndef GPS_RING_SIZE
+#define GPS_RING_SIZE 4096
+#endif
+
+#define GPS_TASK_CORE 0
+#define GPS_TASK_PRIORITY 5
+#define GPS_TASK_STACK 2048
+
+// A source read from SD, e.g. a ReplaySource, goes through FATFS on the task
+#define GPS_FILE_TASK_STACK 6144
+
+/*
+  Moves bytes from the GPS UART, or any Stream such as a ReplaySource,
+  into a ring buffer on its own task, pinned to the core the Arduino loop
+  does not use, so SD writes and display
+  redraws cannot make the UART FIFO overflow. The loop drains the ring
+  with read() whenever it likes.
+
+  In the native build there is one thread, so read() itself first moves
+  what the stream has into the ring, as much as fits, and nothing is ever
+  dropped. Off target without the Arduino stand-ins the producer is a
+  std::thread reading a file descriptor, e.g. one end of a pipe, so the
+  same ring and counters can be exercised on the host. It stops when the
+  descriptor reaches end of file.
+
+  A UART cannot be held up, so by default bytes that find the ring full
+  are read and dropped, and counted. A source that can wait, such as a
+  ReplaySource running as fast as possible, is read only as fast as the
+  ring empties once setBackpressure() is on.
+*/
+class GpsReceiver
+{
+public:
+  GpsReceiver();
+
+#if defined(ESP32)
+  bool begin(Stream &source, int core = GPS_TASK_CORE, uint32_t stack = GPS_TASK_STACK);
+#elif defined(ARDUINO)
+  bool begin(Stream &source);
+#else
+  bool begin(int fd);
+  void end(); // waits for end of file on the descriptor
+#endif
+
+  // Leave bytes in the source while the ring is full instead of dropping them
+  void setBackpressure(bool on) { backpressure = on; }
+
+  // Consumer side, returns the number of bytes copied into buf
+  size_t read(char *buf, size_t len);
+  size_t available() const { return ring.available(); }
+
+  uint32_t bytesReceived() const { return received; }
+  uint32_t bytesDropped() const { return dropped; }
+  uint32_t overflows() const { return overflowCount; }
+  uint32_t highWater() const { return maxFill; }
+
+private:
+  void store(const uint8_t *data, size_t len);
+
+#if defined(ESP32)
+  static void task(void *arg);
+  Stream *source;
+  TaskHandle_t handle;
+#elif defined(ARDUINO)
+  void poll();
+  Stream *source;
+#else
+  void run();
+  int fd;
+  std::thread thread;
+#endif
+
+  SpscRing<GPS_RING_SIZE> ring;
+  volatile bool backpressure;
+
+  // Written by the producer only
+  volatile uint32_t received;
+  volatile uint32_t dropped;
+  volatile uint32_t overflowCount;
+  volatile uint32_t maxFill;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+  Sidecar index of a log file, kept by LogWriter next to the log, e.g.
+  /17092026.idx for /17092026.trk.
+
+  A file is one LogIndexHeader followed by LogIndexEntries in the order
+  they were written, little-endian. Each entry gives a key, for a track
+  the time of a keyframe, and the offset in the log where a reader can
+  start at that key. An entry is only written once the log bytes it
+  points at are on the card, so a reader never follows one past the end.
+  Keys rise through the file, so a reader finds a time with a binary
+  search of a few entries however long the log has grown.
+*/
+
+#define LOG_INDEX_MAGIC "GIDX"
+#define LOG_INDEX_VERSION 1
+
+#pragma pack(push, 1)
+
+struct LogIndexHeader
+{
+  char magic[4];
+  uint8_t version;
+  uint8_t headerSize;
+  uint8_t entrySize;
+  uint8_t reserved[9];
+};
+
+struct LogIndexEntry
+{
+  int64_t key;     // for a track, ms since 1970-01-01 UTC like TrackRecord::time
+  uint32_t offset; // from the start of the log file
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(LogIndexHeader) == 16, "LogIndexHeader layout changed");
+static_assert(sizeof(LogIndexEntry) == 12, "LogIndexEntry layout changed, bump LOG_INDEX_VERSION");
+
+inline void logIndexInitHeader(LogIndexHeader &h)
+{
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, LOG_INDEX_MAGIC, sizeof(h.magic));
+  h.version = LOG_INDEX_VERSION;
+  h.headerSize = sizeof(LogIndexHeader);
+  h.entrySize = sizeof(LogIndexEntry);
+}
+
+// True if a reader of this version can take entries from the file
+inline bool logIndexCheckHeader(const LogIndexHeader &h)
+{
+  return memcmp(h.magic, LOG_INDEX_MAGIC, sizeof(h.magic)) == 0 && h.version >= 1 &&
+         h.headerSize >= sizeof(LogIndexHeader) && h.entrySize >= sizeof(LogIndexEntry);
+}
+
+/*
+  Binary search for the last of count entries whose key is at or before
+  key, read one at a time with read(i, entry). Sets entry to it and
+  returns true, or returns false if every entry is later or one cannot be
+  read, in which case the caller starts at the beginning of the log.
+*/
+template <class Read>
+bool logIndexFind(uint32_t count, int64_t key, Read read, LogIndexEntry &entry)
+{
+  uint32_t lo = 0, hi = count; // the answer is below hi, entries below lo are at or before key
+  bool found = false;
+
+  while (lo < hi)
+  {
+    uint32_t mid = lo + (hi - lo) / 2;
+    LogIndexEntry probe;
+    if (!read(mid, probe))
+      return false;
+
+    if (probe.key <= key)
+    {
+      entry = probe;
+      found = true;
+      lo = mid + 1;
+    }
+    else
+      hi = mid;
+  }
+
+  return found;
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef LOG_POLICY_H
+#define LOG_POLICY_H
+
+#include "TrackFormat.h"
+
+// Defaults for AdaptivePolicy
+#define POLICY_DISTANCE_M 200          // moved this far from the last logged point
+#define POLICY_HEADING_CDEG 1500       // turned 15 degrees from the last logged course
+#define POLICY_SPEED_CKN 270           // speed changed by 5 km/h
+#define POLICY_MAX_INTERVAL_MS 60000   // longest gap while moving
+#define POLICY_STOP_SPEED_CKN 80       // below 1.5 km/h, may be stopping
+#define POLICY_MOVE_SPEED_CKN 160      // above 3 km/h, moving again
+#define POLICY_STOP_RADIUS_M 15        // jitter allowed while stopped
+#define POLICY_STOP_MS 30000           // this long slow and within the radius is a stop
+#define POLICY_STOP_INTERVAL_MS 600000 // longest gap while stopped
+
+/*
+  Decides which fixes go into the track log.
+
+  log() sees every fix in order and returns true for those to keep. It
+  may set flags on the record, e.g. TRACK_FLAG_STOPPED.
+*/
+class LogPolicy
+{
+public:
+  enum Reason
+  {
+    REASON_NONE,
+    REASON_FIRST,    // the first fix, or the first after a reset
+    REASON_FIX,      // the fix was gained or lost, or the clock went back
+    REASON_DISTANCE,
+    REASON_HEADING,
+    REASON_SPEED,
+    REASON_INTERVAL,
+    REASON_STOP,     // came to a stop
+    REASON_MOVE,     // moving again after a stop
+    REASON_COUNT
+  };
+
+  LogPolicy() : last(REASON_NONE), fixCount(0), loggedCount(0) { memset(reasons, 0, sizeof(reasons)); }
+  virtual ~LogPolicy() {}
+
+  bool log(TrackRecord &rec);
+
+  // Forget the history, the next fix is logged
+  virtual void reset() = 0;
+
+  Reason lastReason() const { return last; }
+  uint32_t fixes() const { return fixCount; }
+  uint32_t logged() const { return loggedCount; }
+  uint32_t loggedFor(Reason reason) const { return reasons[reason]; }
+
+protected:
+  virtual Reason decide(TrackRecord &rec) = 0;
+
+private:
+  Reason last;
+  uint32_t fixCount;
+  uint32_t loggedCount;
+  uint32_t reasons[REASON_COUNT];
+};
+
+// Every fix the receiver reports
+class EveryFixPolicy : public LogPolicy
+{
+public:
+  EveryFixPolicy() : first(true) {}
+  void reset() override { first = true; }
+
+protected:
+  Reason decide(TrackRecord &rec) override;
+
+private:
+  bool first;
+};
+
+// One fix every so often, whatever happens in between
+class IntervalPolicy : public LogPolicy
+{
+public:
+  IntervalPolicy(uint32_t intervalMs = 20000) : interval(intervalMs), first(true) {}
+  void reset() override { first = true; }
+
+protected:
+  Reason decide(TrackRecord &rec) override;
+
+private:
+  uint32_t interval;
+  bool first;
+  int64_t lastTime;
+};
+
+/*
+  Logs when the track does something: it moved a given distance or turned
+  from the last logged point, the speed changed, or too long has passed.
+
+  Slow and within a small radius for long enough is a stop. One record
+  flagged TRACK_FLAG_STOPPED marks it, then only the stopped interval
+  applies until the speed or the distance from the stop says it moves
+  again, so GPS jitter at rest is not logged as a walk around the car.
+
+  Everything is done on the 1e-7 degree integers and single floats in
+  O(1) per fix: the distance is a flat-earth one on squares, with the
+  cosine of the latitude taken once per logged point, and the heading is
+  the receiver's course, not one computed from positions.
+*/
+class AdaptivePolicy : public LogPolicy
+{
+public:
+  struct Thresholds
+  {
+    uint32_t distanceM;
+    uint16_t headingCdeg;
+    uint16_t speedCkn;
+    uint32_t maxIntervalMs;
+    uint16_t stopSpeedCkn;
+    uint16_t moveSpeedCkn;
+    uint32_t stopRadiusM;
+    uint32_t stopMs;
+    uint32_t stopIntervalMs;
+  };
+
+  AdaptivePolicy();
+  AdaptivePolicy(const Thresholds &thresholds);
+
+  void reset() override;
+  bool stopped() const { return isStopped; }
+
+protected:
+  Reason decide(TrackRecord &rec) override;
+
+private:
+  void setThresholds(const Thresholds &t);
+  void anchor(const TrackRecord &rec);
+  float distanceSq(const TrackRecord &rec, int32_t lat, int32_t lng, float cosLat) const;
+
+  Thresholds limits;
+  float distanceSqE7;   // squared thresholds in 1e-7 degrees of latitude
+  float stopRadiusSqE7;
+
+  bool first;
+  TrackRecord prev;     // last logged
+  float prevCos;        // cosine of its latitude
+
+  bool isStopped;
+  bool slow;
+  int64_t slowSince;
+  int32_t stopLat, stopLng; // where the slow spell began
+  float stopCos;
+};
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <atomic>
+
+#include "LogIndex.h"
+#include "LogJournal.h"
+
+#if !defined(ESP32)
+#include <thread>
+#endif
+
+#define LOG_SECTOR_SIZE 512
+
+// Size of each of the two blocks, must be a multiple of the sector size
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE 4096
+#endif
+
+// A journal frame is written from one block
+static_assert(LOG_BUFFER_SIZE <= LOG_FRAME_MAX, "LOG_BUFFER_SIZE is past the longest journal frame");
+
+// Default flush policy
+#define LOG_FLUSH_BYTES 1024
+#define LOG_FLUSH_MS 10000
+
+// Index entries a block can carry, more marks in one block are not indexed
+#ifndef LOG_INDEX_MARKS
+#define LOG_INDEX_MARKS 16
+#endif
+
+// Write times from under 1 ms to 1024 ms and over, a bucket per doubling
+#define LOG_LATENCY_BUCKETS 12
+
+// Where the SD card's FAT volume is mounted, for the VFS calls the Arduino FS lacks
+#ifndef LOG_MOUNT_POINT
+#define LOG_MOUNT_POINT "/sd"
+#endif
+
+// How often an idle writer looks for a block
+#ifndef LOG_POLL_MS
+#define LOG_POLL_MS 1
+#endif
+
+// Below the GPS receiver, which must preempt a long card write
+#define LOG_TASK_CORE 0
+#define LOG_TASK_PRIORITY 1
+#define LOG_TASK_STACK 4096
+
+/*
+  Appends to a log file that stays open, through two RAM blocks and a
+  writer task, so a slow card never holds up the loop.
+
+  Records are printed into the block being filled. Once the policy's byte
+  count is there, the whole sectors are handed to the writer and the rest
+  moves to the other block, so every write ends on a sector boundary of
+  the file and the card never has to read back and merge a partial sector.
+  Once the oldest byte is older than the policy's age, poll() hands over
+  everything, the partial last sector too, and the writer flushes the file
+  so its directory entry is up to date. Data that arrives faster than the
+  age never waits that long, so whole sectors handed over once the age
+  has passed since the last flush are flushed instead.
+
+  Handing over only flips a flag; neither side ever waits for the other.
+  If the writer still has the other block, a record that does not fit is
+  dropped whole and counted. open() and close() are the exception: they
+  wait for the writer to finish, which happens once a day.
+
+  The writer is a FreeRTOS task pinned to the core the loop does not use.
+  Elsewhere, e.g. the native build, it is a std::thread.
+
+  If a write fails the writer drops what is queued and the next write() or
+  poll() closes the file, counting the bytes as lost; open() starts again.
+
+  Given an index path, open() also keeps a sidecar index (LogIndex.h).
+  mark() before a write() makes that record an entry; the entry travels
+  with the block holding the record and the writer appends it to the
+  index right after the block, so both files are written on the same
+  schedule and no entry points past what the card has.
+
+  With setPreallocation() a file is written in place instead of appended
+  to. The writer zero-fills it ahead of the data, the whole allowance at
+  a time, so FAT clusters are allocated in one go off the hot path and
+  the card's writes land on space that is already the file's. Each flush
+  also stores the logical end as a uint32 at the given offset of the
+  file's header. open() finds the true end of a file that was not closed
+  cleanly from there: whole sectors written after the last flush are
+  found because unwritten space reads as zeros, and no log format here
+  has a sector of zeros. close() cuts the unused space off again.
+
+  With setJournal() the data past the format's header goes to the card
+  as LogJournal.h frames, one to each block handed over, the writer
+  adding the sequence number and CRC. A record split across two blocks
+  is split across two frames. open() then ends the file after the last
+  good frame: it reads back up to two blocks before the flushed length to
+  pick up the sequence, and walks on over any whole frames written since,
+  so a torn frame is written over and only the tail of the file is read
+  however long it has grown. Index entries still point at the record; a
+  reader checks the frame holding it and starts there.
+*/
+class LogWriter : public Print
+{
+public:
+  LogWriter();
+#if !defined(ESP32)
+  ~LogWriter();
+#endif
+
+  // Starts the writer, before the first open()
+  bool begin(int core = LOG_TASK_CORE);
+
+  // Appends to path, and its entries to indexPath if given, closing whatever other file was open
+  bool open(fs::FS &fs, const char *path, const char *indexPath = NULL);
+  void close();
+  bool isOpen() const { return file; }
+  const char *path() const { return name; }
+
+  // Length of the file including what is still queued
+  uint32_t size() const { return position + used; }
+
+  // A write is one record, stored whole or dropped whole
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t len) override;
+  using Print::write;
+
+  // Indexes the next record written under key
+  void mark(int64_t key);
+
+  void setFlushPolicy(uint32_t maxAgeMs, size_t maxBytes);
+
+  // Files opened from now on are reserved bytes at a time, the logical end kept at lengthOffset
+  void setPreallocation(uint32_t bytes, uint32_t lengthOffset);
+
+  // Files opened from now on are framed past start, the format's header, which is written on its own
+  void setJournal(uint32_t start);
+
+  // Applies the age policy, call regularly even when nothing is logged
+  void poll();
+
+  // Hands everything to the writer and has it flush the file
+  void flush() override;
+
+  // Waits until the writer has nothing left
+  void drain();
+
+  // Bytes in RAM that the card does not have yet
+  uint32_t queuedBytes() const;
+  uint32_t droppedRecords() const { return dropped; }
+
+  uint32_t bytesWritten() const { return written; }
+  uint32_t bytesLost() const { return lost; }
+  uint32_t writes() const { return writeCount; }
+  uint32_t flushes() const { return flushCount; }
+  uint32_t maxWriteMicros() const { return maxMicros; }
+  uint32_t indexEntries() const { return indexed; }
+
+  // Writes that took under 1 ms for bucket 0, else 2^(bucket-1) to 2^bucket ms
+  uint32_t latency(int bucket) const { return histogram[bucket]; }
+
+  // Preallocation: bytes zero-filled, what it took, and data found past a stale length by open()
+  uint32_t bytesReserved() const { return reservedBytes; }
+  uint32_t reserveMicros() const { return reserveTime; }
+  uint32_t bytesRecovered() const { return recovered; }
+
+  // Journal: bytes at the end of the file open() found in no good frame, e.g. a torn write
+  uint32_t bytesTorn() const { return torn; }
+
+private:
+  struct Block
+  {
+    uint8_t data[LOG_BUFFER_SIZE];
+    size_t len;
+    uint32_t offset;   // in the file of data[0]
+    size_t frameAt;    // where the frame header goes, or len if the block has none
+    uint32_t sequence; // of the frame
+    LogIndexEntry marks[LOG_INDEX_MARKS];
+    size_t markCount;
+    bool sync;
+    std::atomic<bool> queued; // owned by the writer while set
+  };
+
+  bool handOver(size_t len, bool sync);
+  void writeSectors();
+  void checkFailed();
+  uint32_t findEnd();
+  uint32_t findFrames(uint32_t tail, uint32_t limit);
+  bool readFrame(uint32_t pos, LogFrameHeader &h);
+  void service();
+  void reserve(uint32_t end);
+  void writeBlock(Block &block);
+  void writeLength(uint32_t length);
+
+#if defined(ESP32)
+  static void task(void *arg);
+  TaskHandle_t handle;
+#else
+  void run();
+  std::thread thread;
+  std::atomic<bool> stopping;
+#endif
+
+  fs::File file;
+  fs::File index;
+  fs::FS *volume;
+  char name[24];
+
+  // The producer fills blocks[fill], the writer takes them in turn from next
+  Block blocks[2];
+  int fill;
+  int next;
+  size_t used;
+  uint32_t position; // file offset of blocks[fill].data[0]
+  uint32_t oldest;   // millis() when the first byte of the block was stored
+  uint32_t synced;   // millis() of the last flush handed over
+  bool markPending;
+  int64_t markKey;
+
+  uint32_t maxAge;
+  size_t maxBytes;
+
+  uint32_t prealloc;
+  uint32_t lengthOffset;
+  uint32_t reserved; // the file's size as the writer left it
+  uint32_t recovered;
+
+  // Journal framing, the frame being filled starts at frameAt of the fill block
+  bool journal;
+  uint32_t journalStart;
+  bool frameOpen;
+  size_t frameAt;
+  uint32_t sequence;
+  uint32_t torn;
+
+  std::atomic<bool> failed;
+  uint32_t dropped;
+
+  // Written by the writer, lost by both
+  std::atomic<uint32_t> written;
+  std::atomic<uint32_t> lost;
+  std::atomic<uint32_t> writeCount;
+  std::atomic<uint32_t> flushCount;
+  std::atomic<uint32_t> maxMicros;
+  std::atomic<uint32_t> indexed;
+  std::atomic<uint32_t> histogram[LOG_LATENCY_BUCKETS];
+  std::atomic<uint32_t> reservedBytes;
+  std::atomic<uint32_t> reserveTime;
+};
+
+#endif
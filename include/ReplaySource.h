@@ -0,0 +1,119 @@
+#ifndef REPLAY_SOURCE_H
+#define REPLAY_SOURCE_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <atomic>
+
+#include "CaptureFormat.h"
+#include "TrackReader.h"
+
+// Bytes read from the file at a time, and the longest generated sentence pair
+#define REPLAY_CHUNK_SIZE 256
+
+// Line rate for a plain NMEA file, which has no timing of its own
+#ifndef REPLAY_NMEA_BAUD
+#define REPLAY_NMEA_BAUD 9600
+#endif
+
+// Line rate the sentences made from a track arrive at
+#define REPLAY_TRACK_BAUD 9600
+
+/*
+  Plays a recorded file back as the receiver's byte stream, so it can take
+  the place of the GPS UART, e.g. given to GpsReceiver::begin().
+
+  The file may be a capture (CaptureFormat.h), whose bytes come out when
+  their frame's millis() stamp says, at the baud rate it was recorded at;
+  a binary track (TrackFormat.h), from which an RMC and a GGA sentence are
+  made for each record at its time; or plain NMEA, fed at
+  REPLAY_NMEA_BAUD. The recording's clock runs at speed times millis(),
+  0 makes every byte available at once so the consumer sets the pace.
+
+  The same file replays to the same bytes whatever the speed, so a
+  customer's capture reproduces what their receiver sent, and as fast as
+  possible it measures the whole loop of parsing, drawing and logging.
+*/
+class ReplaySource : public Stream
+{
+public:
+  ReplaySource();
+
+  bool begin(fs::FS &fs, const char *path, float speed = 1);
+  void end();
+  void setSpeed(float speed);
+
+  // True once the last byte has been read
+  bool finished() const { return done; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  using Stream::readBytes;
+
+  // Nothing is sent back to a recording
+  size_t write(uint8_t) override { return 0; }
+  size_t write(const uint8_t *, size_t) override { return 0; }
+  using Print::write;
+
+  uint32_t bytesReplayed() const { return replayed; }
+  uint32_t recordsReplayed() const { return records; }
+
+  // Recording time covered so far, and the millis() it took
+  uint32_t recordingMillis() const { return (uint32_t)(chunkStart / 1000); }
+  uint32_t elapsedMillis() const { return (done ? doneAt.load() : millis()) - started; }
+
+private:
+  enum Kind
+  {
+    KIND_NMEA,
+    KIND_CAPTURE,
+    KIND_TRACK
+  };
+
+  uint64_t recordingMicros() const;
+  size_t due();
+  bool nextChunk();
+  bool nextFrame();
+  bool nextRecord();
+  size_t formatRecord(const TrackRecord &rec);
+
+  File file;
+  Kind kind;
+  float speed;
+  uint32_t baud;
+
+  // Where millis() and the recording's clock were when the speed was last set
+  uint32_t started;
+  uint32_t baseMillis;
+  uint64_t baseMicros;
+
+  // The chunk being replayed, its first byte is due at chunkStart and the
+  // line is free again at chunkEnd, both in microseconds of the recording
+  uint8_t chunk[REPLAY_CHUNK_SIZE];
+  size_t chunkLen;
+  size_t chunkPos;
+  uint64_t chunkStart;
+  uint64_t chunkEnd;
+
+  // Capture frame bytes still in the file, and when the next of them is due
+  size_t frameLeft;
+  uint64_t frameNext;
+  uint16_t frameHeaderSize;
+  uint32_t captureEnd; // file offset where the capture ends
+
+  TrackReader track;
+
+  // The first stamp in the file, which replays at time 0
+  int64_t origin;
+  bool haveOrigin;
+
+  // Read by the loop while the receiver's task replays
+  std::atomic<bool> done;
+  std::atomic<uint32_t> doneAt;
+  std::atomic<uint32_t> replayed;
+  std::atomic<uint32_t> records;
+};
+
+#endif
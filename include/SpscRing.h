@@ -0,0 +1,72 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+/*
+  Lock-free byte ring for exactly one producer and one consumer, which may
+  run on different cores. Size must be a power of two. The indices run
+  freely and wrap through the mask, so all Size bytes are usable.
+*/
+template <size_t Size>
+class SpscRing
+{
+  static_assert(Size && (Size & (Size - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+  SpscRing() : head(0), tail(0) {}
+
+  // Producer side, returns the number of bytes stored
+  size_t write(const uint8_t *data, size_t len)
+  {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    uint32_t t = tail.load(std::memory_order_acquire);
+    size_t space = Size - (h - t);
+    if (len > space)
+      len = space;
+
+    size_t offset = h & (Size - 1);
+    size_t first = Size - offset < len ? Size - offset : len;
+    memcpy(buffer + offset, data, first);
+    memcpy(buffer, data + first, len - first);
+
+    head.store(h + len, std::memory_order_release);
+    return len;
+  }
+
+  // Consumer side, returns the number of bytes taken
+  size_t read(uint8_t *data, size_t len)
+  {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+    size_t used = h - t;
+    if (len > used)
+      len = used;
+
+    size_t offset = t & (Size - 1);
+    size_t first = Size - offset < len ? Size - offset : len;
+    memcpy(data, buffer + offset, first);
+    memcpy(data + first, buffer, len - first);
+
+    tail.store(t + len, std::memory_order_release);
+    return len;
+  }
+
+  // Either side; only a snapshot while the other side is running
+  size_t available() const
+  {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  static size_t capacity() { return Size; }
+
+private:
+  std::atomic<uint32_t> head; // written by the producer only
+  std::atomic<uint32_t> tail; // written by the consumer only
+  uint8_t buffer[Size];
+};
+
+#endif
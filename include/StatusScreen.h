@@ -0,0 +1,68 @@
+#ifndef STATUS_SCREEN_H
+#define STATUS_SCREEN_H
+
+#include <TFT_eSPI.h>
+
+#define STATUS_MAX_FIELDS 16
+#define STATUS_MAX_CHARS 34
+
+/*
+  Retained model of a text status screen.
+
+  Each field is a fixed label followed by a value of at most "width"
+  characters, drawn in the GLCD font. The label is drawn once; the value
+  is only redrawn when it differs from what is on the panel, starting at
+  the first changed character, with an opaque background and padding so
+  the old text is overwritten without clearing the screen.
+*/
+class StatusScreen
+{
+public:
+  StatusScreen(TFT_eSPI &tft, uint16_t bgcolor = TFT_BLACK);
+
+  // Returns the field index, or -1 if the table is full
+  int8_t addField(const char *label, int16_t x, int16_t y, uint8_t width,
+                  uint8_t size = 2, uint16_t color = TFT_WHITE);
+
+  // Draw on another display from now on, everything is drawn again
+  void setDisplay(TFT_eSPI &tft);
+
+  void setValue(uint8_t field, const char *value);
+  void setColor(uint8_t field, uint16_t color);
+
+  // Force the labels and every value to be drawn on the next update
+  void invalidate();
+
+  // Draw what changed, returns the number of bytes sent to the panel
+  uint32_t update();
+
+  uint32_t bytesLastUpdate() const { return lastBytes; }
+  uint32_t bytesTotal() const { return totalBytes; }
+  uint8_t fieldsLastUpdate() const { return lastFields; }
+
+private:
+  struct Field
+  {
+    const char *label;
+    int16_t x, y;
+    uint8_t width;
+    uint8_t size;
+    uint16_t color;
+    bool dirty;
+    char value[STATUS_MAX_CHARS + 1];
+    char shown[STATUS_MAX_CHARS + 1];
+  };
+
+  uint32_t drawField(Field &f);
+
+  TFT_eSPI *tft;
+  uint16_t bgcolor;
+  Field fields[STATUS_MAX_FIELDS];
+  uint8_t fieldCount;
+  bool labelsDrawn;
+  uint32_t lastBytes;
+  uint32_t totalBytes;
+  uint8_t lastFields;
+};
+
+#endif
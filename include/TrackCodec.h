@@ -0,0 +1,88 @@
+#ifndef TRACK_CODEC_H
+#define TRACK_CODEC_H
+
+#include "TrackFormat.h"
+
+#include <stddef.h>
+
+// Records between keyframes
+#ifndef TRACK_KEYFRAME_INTERVAL
+#define TRACK_KEYFRAME_INTERVAL 60
+#endif
+
+// Longest frame the encoder produces
+#define TRACK_MAX_FRAME 48
+
+/*
+  Streaming delta encoding of TrackRecords.
+
+  A keyframe is 0xFF 'K', the whole record and a Fletcher-16 of both. It
+  starts a stream, comes back every keyframe interval, and is where a
+  reader may start or pick up again after damage.
+
+  Any other frame is a delta. A mask byte below 0x80 is followed by a
+  zigzag varint for each field whose bit is set, fields with nothing to
+  add are left out:
+    0x01 time       second difference, so a steady rate costs nothing
+    0x02 latitude   second difference, so a steady velocity costs little
+    0x04 longitude  second difference
+    0x08 altitude   difference
+    0x10 speed      difference
+    0x20 course     difference
+    0x40 quality    hdop difference, then satellites and flags as bytes
+  Second differences restart from zero after each keyframe.
+*/
+class TrackEncoder
+{
+public:
+  TrackEncoder(uint16_t keyframeInterval = TRACK_KEYFRAME_INTERVAL);
+
+  // Writes the frame for rec to out, at least TRACK_MAX_FRAME bytes, returns its length
+  size_t encode(const TrackRecord &rec, uint8_t *out);
+
+  // The next record is a keyframe, e.g. for a new file or after lost data
+  void reset() { sinceKeyframe = interval; }
+  bool lastWasKeyframe() const { return sinceKeyframe == 0; }
+
+private:
+  size_t keyframe(const TrackRecord &rec, uint8_t *out);
+
+  uint16_t interval;
+  uint16_t sinceKeyframe;
+  TrackRecord prev;
+  int64_t timeStep, latStep, lngStep;
+};
+
+class TrackDecoder
+{
+public:
+  TrackDecoder();
+
+  /*
+    Decodes the frame at the start of data and returns the bytes it used,
+    0 if data ends inside the frame, in which case the caller should come
+    back with more. have is set when rec holds a new record. Bytes that do
+    not make a frame are skipped until the next good keyframe.
+  */
+  size_t decode(const uint8_t *data, size_t len, TrackRecord &rec, bool &have);
+
+  // Forget the stream, e.g. after seeking; decoding resumes at a keyframe
+  void reset() { synced = false; }
+
+  uint32_t records() const { return recordCount; }
+  uint32_t keyframes() const { return keyframeCount; }
+  uint32_t resyncs() const { return resyncCount; }
+  uint32_t skippedBytes() const { return skipped; }
+
+private:
+  bool synced;
+  TrackRecord prev;
+  int64_t timeStep, latStep, lngStep;
+
+  uint32_t recordCount;
+  uint32_t keyframeCount;
+  uint32_t resyncCount;
+  uint32_t skipped;
+};
+
+#endif
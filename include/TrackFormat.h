@@ -0,0 +1,146 @@
+#ifndef TRACK_FORMAT_H
+#define TRACK_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+  Binary track log, written by the firmware and read by tools/trackconv.
+
+  A file is one TrackHeader followed by the records, all little-endian
+  like the ESP32 and the usual host. With TRACK_ENCODING_FIXED they are
+  fixed-size TrackRecords: readers take the record size from the header
+  and ignore any bytes past the fields they know, so a later version may
+  append fields without breaking them. With TRACK_ENCODING_DELTA they are
+  TrackEncoder frames, see TrackCodec.h.
+
+  A nonzero length is how much of the file is in use; the rest is space
+  LogWriter preallocated and has not written yet, which reads as zeros.
+
+  With TRACK_FRAMING_JOURNAL everything after the header is LogJournal.h
+  frames, and the records are what their data makes when joined up.
+*/
+
+#define TRACK_MAGIC "GTRK"
+#define TRACK_VERSION 3
+
+#define TRACK_ENCODING_FIXED 0 // version 1 files are always fixed
+#define TRACK_ENCODING_DELTA 1
+
+#define TRACK_FRAMING_NONE 0 // before version 3 files are never framed
+#define TRACK_FRAMING_JOURNAL 1
+
+#define TRACK_FLAG_FIX 0x01     // position, altitude, speed and course are current
+#define TRACK_FLAG_DATE 0x02    // time includes the date, else it is since midnight
+#define TRACK_FLAG_STOPPED 0x04 // at rest, logged only now and then until it moves
+
+#pragma pack(push, 1)
+
+struct TrackHeader
+{
+  char magic[4];
+  uint8_t version;
+  uint8_t headerSize;
+  uint8_t recordSize;
+  uint8_t encoding;
+  uint32_t length; // bytes in use including the header, 0 if all of the file
+  uint8_t framing;
+  uint8_t reserved[3];
+};
+
+struct TrackRecord
+{
+  int64_t time;        // ms since 1970-01-01 UTC
+  int32_t latE7;       // degrees * 1e7, south is negative
+  int32_t lngE7;       // degrees * 1e7, west is negative
+  int32_t altitude;    // 1/100 meter above mean sea level
+  uint16_t speed;      // 1/100 knot
+  uint16_t course;     // 1/100 degree
+  uint16_t hdop;       // 1/100
+  uint8_t satellites;
+  uint8_t flags;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(TrackHeader) == 16, "TrackHeader layout changed");
+static_assert(sizeof(TrackRecord) == 28, "TrackRecord layout changed, bump TRACK_VERSION");
+static_assert(offsetof(TrackHeader, length) == 8, "TrackHeader layout changed");
+
+inline void trackInitHeader(TrackHeader &h, uint8_t encoding = TRACK_ENCODING_FIXED,
+                            uint8_t framing = TRACK_FRAMING_NONE)
+{
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, TRACK_MAGIC, sizeof(h.magic));
+  h.version = TRACK_VERSION;
+  h.headerSize = sizeof(TrackHeader);
+  h.recordSize = sizeof(TrackRecord);
+  h.encoding = encoding;
+  h.framing = framing;
+}
+
+inline uint8_t trackEncoding(const TrackHeader &h)
+{
+  return h.version >= 2 ? h.encoding : TRACK_ENCODING_FIXED;
+}
+
+inline uint8_t trackFraming(const TrackHeader &h)
+{
+  return h.version >= 3 ? h.framing : TRACK_FRAMING_NONE;
+}
+
+// How much of a file of size bytes holds the track
+inline uint32_t trackLength(const TrackHeader &h, uint32_t size)
+{
+  return h.length > 0 && h.length < size ? h.length : size;
+}
+
+// True if a reader of this version can take records from the file
+inline bool trackCheckHeader(const TrackHeader &h)
+{
+  return memcmp(h.magic, TRACK_MAGIC, sizeof(h.magic)) == 0 && h.version >= 1 &&
+         h.headerSize >= sizeof(TrackHeader) && h.recordSize >= sizeof(TrackRecord) &&
+         trackEncoding(h) <= TRACK_ENCODING_DELTA && trackFraming(h) <= TRACK_FRAMING_JOURNAL;
+}
+
+// Days from 1970-01-01 to a Gregorian date, valid for any year
+inline int32_t trackDaysFromCivil(int32_t y, uint32_t m, uint32_t d)
+{
+  y -= m <= 2;
+  int32_t era = (y >= 0 ? y : y - 399) / 400;
+  uint32_t yoe = (uint32_t)(y - era * 400);
+  uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+// Inverse of trackDaysFromCivil
+inline void trackCivilFromDays(int32_t z, int32_t &y, uint32_t &m, uint32_t &d)
+{
+  z += 719468;
+  int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+  uint32_t doe = (uint32_t)(z - era * 146097);
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = (int32_t)yoe + era * 400 + (m <= 2);
+}
+
+// NMEA ddmmyy and hhmmsscc to ms since the epoch, or since midnight without a date
+inline int64_t trackTime(uint32_t ddmmyy, uint32_t hhmmsscc)
+{
+  int64_t ms = (int64_t)(hhmmsscc / 1000000) * 3600000 + (hhmmsscc / 10000 % 100) * 60000 +
+               (hhmmsscc / 100 % 100) * 1000 + (hhmmsscc % 100) * 10;
+
+  if (ddmmyy == 0)
+    return ms;
+
+  int32_t days = trackDaysFromCivil(2000 + ddmmyy % 100, ddmmyy / 100 % 100, ddmmyy / 10000);
+  return (int64_t)days * 86400000 + ms;
+}
+
+#endif
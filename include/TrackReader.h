@@ -0,0 +1,90 @@
+#ifndef TRACK_READER_H
+#define TRACK_READER_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include "LogIndex.h"
+#include "LogJournal.h"
+#include "TrackCodec.h"
+
+/*
+  Reads a binary track log back on the device, one record at a time, in
+  either encoding, e.g. to show or replay part of a day.
+
+  seek() looks the time up in the log's sidecar index (LogIndex.h) and
+  starts decoding at the keyframe before it, so finding 14:00 costs a few
+  index reads and at most one keyframe interval of records however long
+  the log has grown. Without an index it decodes from the start.
+
+  A journaled log (TRACK_FRAMING_JOURNAL) is read a frame at a time, each
+  checked against its CRC before any of it is decoded. A bad frame is
+  skipped up to the next good one and decoding picks up at a keyframe,
+  as it does after a sequence number that was missed. An index entry
+  points at its keyframe inside a frame, so seek() finds the header
+  before it, checks the frame and starts decoding at the keyframe.
+*/
+class TrackReader
+{
+public:
+  TrackReader();
+
+  bool open(fs::FS &fs, const char *path, const char *indexPath = NULL);
+  void close();
+  bool isOpen() const { return file; }
+  bool hasIndex() const { return indexCount > 0; }
+
+  // Moves to the first record at or after time, false if there is none
+  bool seek(int64_t time);
+
+  // The next record, false at the end of the log
+  bool next(TrackRecord &rec);
+
+  // What the last seek() cost: index entries read and records decoded to get there
+  uint32_t seekProbes() const { return probes; }
+  uint32_t seekSkipped() const { return skipped; }
+
+  // Journal: bytes passed over that were in no good frame
+  uint32_t badBytes() const { return bad; }
+
+private:
+  bool readEntry(uint32_t i, LogIndexEntry &entry);
+  bool decode(TrackRecord &rec);
+  size_t readData(uint8_t *buf, size_t len);
+  bool nextFrame();
+  bool enterFrame(uint32_t offset);
+  bool checkFrame(const LogFrameHeader &h);
+
+  File file;
+  File index;
+  uint32_t dataStart;
+  uint32_t dataEnd;
+  uint8_t encoding;
+  uint8_t recordSize;
+
+  // Journal: data left in the current frame, the sequence due next, and
+  // whether data was lost before it
+  bool framed;
+  uint32_t frameLeft;
+  uint32_t sequence;
+  bool haveSequence;
+  bool gap;
+  uint32_t bad;
+
+  uint32_t indexStart;
+  uint32_t indexCount;
+  uint8_t entrySize;
+
+  TrackDecoder decoder;
+  uint8_t in[TRACK_MAX_FRAME];
+  size_t inLen;
+
+  // The record seek() stopped at, next() returns it first
+  TrackRecord found;
+  bool haveFound;
+
+  uint32_t probes;
+  uint32_t skipped;
+};
+
+#endif
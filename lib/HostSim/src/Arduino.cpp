@@ -0,0 +1,108 @@
+#include "Arduino.h"
+#include "HostSim.h"
+
+static uint8_t pinLevels[256];
+
+uint32_t millis()
+{
+  return HostSim.tick() / 1000;
+}
+
+uint32_t micros()
+{
+  return HostSim.tick();
+}
+
+void delay(uint32_t ms)
+{
+  HostSim.delay(ms * 1000ULL);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  HostSim.delay(us);
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  pinLevels[pin] = val;
+  HostSim.panel.pinChanged(pin, val);
+}
+
+int digitalRead(uint8_t pin)
+{
+  return pinLevels[pin];
+}
+
+long random(long howbig)
+{
+  return howbig > 0 ? rand() % howbig : 0;
+}
+
+long random(long howsmall, long howbig)
+{
+  return howbig > howsmall ? howsmall + random(howbig - howsmall) : howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+  if (seed)
+    srand(seed);
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+static char *formatNumber(unsigned long value, bool negative, char *str, int base)
+{
+  char digits[8 * sizeof(value)];
+  int n = 0;
+
+  do
+  {
+    int d = value % base;
+    digits[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+    value /= base;
+  } while (value);
+
+  char *p = str;
+  if (negative)
+    *p++ = '-';
+  while (n)
+    *p++ = digits[--n];
+  *p = 0;
+
+  return str;
+}
+
+char *ltoa(long value, char *str, int base)
+{
+  if (value < 0 && base == 10)
+    return formatNumber(-(unsigned long)value, true, str, base);
+  return formatNumber((unsigned long)value, false, str, base);
+}
+
+char *itoa(int value, char *str, int base)
+{
+  return ltoa(value, str, base);
+}
+
+char *utoa(unsigned value, char *str, int base)
+{
+  return formatNumber(value, false, str, base);
+}
+
+char *ultoa(unsigned long value, char *str, int base)
+{
+  return formatNumber(value, false, str, base);
+}
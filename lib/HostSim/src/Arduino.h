@@ -0,0 +1,118 @@
+/*
+  Host stand-in for the parts of the Arduino core the firmware and its
+  libraries use. Time comes from the HostSim clock, pins are only
+  remembered, and the DC/CS pins of the panel are forwarded to HostPanel.
+*/
+
+#ifndef _HOSTSIM_ARDUINO_H_
+#define _HOSTSIM_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+
+#ifndef ARDUINO
+#define ARDUINO 10805
+#endif
+
+// Selects the host back ends of libraries, e.g. TFT_eSPI's
+#define HOSTSIM 1
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x02
+#define INPUT_PULLUP 0x05
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define radians(deg) ((deg) * DEG_TO_RAD)
+#define degrees(rad) ((rad) * RAD_TO_DEG)
+#define sq(x) ((x) * (x))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::max;
+using std::min;
+
+#define PROGMEM
+#define PGM_P const char *
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+
+// Through a copy, as font and bitmap tables are read at any alignment and type
+inline uint16_t pgm_read_word(const void *addr)
+{
+  uint16_t v;
+  memcpy(&v, addr, sizeof(v));
+  return v;
+}
+
+inline uint32_t pgm_read_dword(const void *addr)
+{
+  uint32_t v;
+  memcpy(&v, addr, sizeof(v));
+  return v;
+}
+
+inline float pgm_read_float(const void *addr)
+{
+  float v;
+  memcpy(&v, addr, sizeof(v));
+  return v;
+}
+
+inline void *pgm_read_ptr(const void *addr)
+{
+  void *v;
+  memcpy(&v, addr, sizeof(v));
+  return v;
+}
+
+#define digitalPinToBitMask(pin) (1UL << ((pin) & 31))
+
+class __FlashStringHelper;
+#define F(string_literal) ((const __FlashStringHelper *)(string_literal))
+
+// Unsigned 32 bit like the ESP32, so wrap arounds behave as on the device
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+char *itoa(int value, char *str, int base);
+char *ltoa(long value, char *str, int base);
+char *utoa(unsigned value, char *str, int base);
+char *ultoa(unsigned long value, char *str, int base);
+
+// Provided by the sketch
+void setup();
+void loop();
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+#endif
@@ -0,0 +1,206 @@
+#include "FS.h"
+#include "HostSim.h"
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs
+{
+
+class FileImpl
+{
+public:
+  FileImpl(FILE *f, const char *path, FSStats &stats) : f(f), path(path), stats(stats) {}
+  ~FileImpl() { close(); }
+
+  void close()
+  {
+    if (f)
+      fclose(f);
+    f = NULL;
+  }
+
+  FILE *f;
+  std::string path;
+  FSStats &stats;
+};
+
+size_t File::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buf, size_t size)
+{
+  if (!*this)
+    return 0;
+
+  // Writing past the end makes the card allocate clusters and update the FAT
+  uint64_t end = position() + size;
+  uint64_t had = this->size();
+  uint32_t clusters = 0;
+  if (end > had)
+    clusters = (end + HOSTSIM_SD_CLUSTER - 1) / HOSTSIM_SD_CLUSTER -
+               (had + HOSTSIM_SD_CLUSTER - 1) / HOSTSIM_SD_CLUSTER;
+
+  HostSim.sdWrite(size, clusters);
+  size_t n = fwrite(buf, 1, size, impl->f);
+  impl->stats.writes++;
+  impl->stats.bytesWritten += n;
+  return n;
+}
+
+int File::available()
+{
+  return *this ? (int)(size() - position()) : 0;
+}
+
+int File::read()
+{
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek()
+{
+  if (!*this)
+    return -1;
+
+  int c = fgetc(impl->f);
+  if (c >= 0)
+    ungetc(c, impl->f);
+  return c;
+}
+
+size_t File::read(uint8_t *buf, size_t size)
+{
+  if (!*this)
+    return 0;
+
+  size_t n = fread(buf, 1, size, impl->f);
+  impl->stats.reads++;
+  impl->stats.bytesRead += n;
+  return n;
+}
+
+void File::flush()
+{
+  if (!*this)
+    return;
+
+  fflush(impl->f);
+  impl->stats.flushes++;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode)
+{
+  return *this && fseek(impl->f, pos, mode) == 0;
+}
+
+size_t File::position() const
+{
+  return *this ? ftell(impl->f) : 0;
+}
+
+size_t File::size() const
+{
+  if (!*this)
+    return 0;
+
+  struct stat st;
+  fflush(impl->f);
+  return fstat(fileno(impl->f), &st) == 0 ? st.st_size : 0;
+}
+
+void File::close()
+{
+  if (impl)
+    impl->close();
+  impl.reset();
+}
+
+const char *File::name() const
+{
+  if (!impl)
+    return NULL;
+
+  size_t slash = impl->path.rfind('/');
+  return impl->path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+File::operator bool() const
+{
+  return impl && impl->f;
+}
+
+bool FS::mount(const char *dir)
+{
+  root = dir;
+  while (root.size() > 1 && root[root.size() - 1] == '/')
+    root.erase(root.size() - 1);
+
+  ::mkdir(root.c_str(), 0777);
+
+  struct stat st;
+  mounted = ::stat(root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+  return mounted;
+}
+
+std::string FS::hostPath(const char *path) const
+{
+  if (!path || path[0] != '/')
+    return root + "/" + (path ? path : "");
+  return root + path;
+}
+
+File FS::open(const char *path, const char *mode)
+{
+  if (!mounted)
+    return File();
+
+  // Always binary, "r+" becomes "r+b"
+  std::string m(mode);
+  if (m.find('b') == std::string::npos)
+    m.insert(1, "b");
+
+  FILE *f = fopen(hostPath(path).c_str(), m.c_str());
+  if (!f)
+    return File();
+
+  counters.opens++;
+  return File(FileImplPtr(new FileImpl(f, path, counters)));
+}
+
+bool FS::exists(const char *path)
+{
+  struct stat st;
+  return mounted && ::stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char *path)
+{
+  return mounted && ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char *pathFrom, const char *pathTo)
+{
+  return mounted && ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path)
+{
+  return mounted && (::mkdir(hostPath(path).c_str(), 0777) == 0 || errno == EEXIST);
+}
+
+bool FS::rmdir(const char *path)
+{
+  return mounted && ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool FS::truncate(const char *path, uint32_t size)
+{
+  return mounted && ::truncate(hostPath(path).c_str(), size) == 0;
+}
+
+} // namespace fs
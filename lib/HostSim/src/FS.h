@@ -0,0 +1,107 @@
+#ifndef _HOSTSIM_FS_H_
+#define _HOSTSIM_FS_H_
+
+#include <memory>
+#include <string>
+
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+
+enum SeekMode
+{
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+// What the firmware asked of a file system since it was mounted
+struct FSStats
+{
+  uint64_t bytesWritten;
+  uint64_t bytesRead;
+  uint32_t writes;
+  uint32_t reads;
+  uint32_t opens;
+  uint32_t flushes;
+};
+
+class FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+
+// A handle shared by copies, the host file is closed with the last one
+class File : public Stream
+{
+public:
+  File(FileImplPtr p = FileImplPtr()) : impl(p) {}
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buf, size_t size) override;
+  using Print::write;
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t *buf, size_t size);
+  size_t readBytes(char *buffer, size_t length) override { return read((uint8_t *)buffer, length); }
+  using Stream::readBytes;
+
+  void flush() override;
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void close();
+  const char *name() const;
+  operator bool() const;
+
+private:
+  FileImplPtr impl;
+};
+
+/*
+  A directory on the host standing in for a mounted volume. Paths are
+  taken relative to it, modes are the stdio ones the ESP32 VFS accepts.
+*/
+class FS
+{
+public:
+  FS() : mounted(false), counters() {}
+
+  File open(const char *path, const char *mode = FILE_READ);
+  File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+  bool exists(const char *path);
+  bool exists(const String &path) { return exists(path.c_str()); }
+  bool remove(const char *path);
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool rename(const char *pathFrom, const char *pathTo);
+  bool rename(const String &pathFrom, const String &pathTo) { return rename(pathFrom.c_str(), pathTo.c_str()); }
+  bool mkdir(const char *path);
+  bool mkdir(const String &path) { return mkdir(path.c_str()); }
+  bool rmdir(const char *path);
+  bool rmdir(const String &path) { return rmdir(path.c_str()); }
+
+  // Not in the Arduino core, whose files cannot shrink; the ESP32 VFS has truncate()
+  bool truncate(const char *path, uint32_t size);
+
+  const FSStats &stats() const { return counters; }
+
+protected:
+  bool mount(const char *dir);
+  std::string hostPath(const char *path) const;
+
+  std::string root;
+  bool mounted;
+  FSStats counters;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
@@ -0,0 +1,82 @@
+#include "HardwareSerial.h"
+#include "HostSim.h"
+
+HardwareSerial Serial(0);
+
+HardwareSerial::HardwareSerial(int uart_nr)
+    : uart(uart_nr), baud(0), started(false), startTime(0), consumed(0)
+{
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config, int8_t rxPin, int8_t txPin,
+                           bool invert, unsigned long timeout_ms)
+{
+  this->baud = uart == 0 ? baud : HostSim.uartBaud(baud);
+  started = true;
+  startTime = HostSim.now();
+  consumed = 0;
+
+  if (uart != 0)
+    HostSim.uartStarted(startTime, this->baud);
+}
+
+void HardwareSerial::end()
+{
+  started = false;
+}
+
+uint64_t HardwareSerial::arrived() const
+{
+  if (uart == 0 || !started || !baud || !HostSim.captureSize())
+    return 0;
+
+  uint64_t n = (HostSim.now() - startTime) * baud / 10000000ULL;
+  if (!HostSim.captureLoops() && n > HostSim.captureSize())
+    n = HostSim.captureSize();
+  return n;
+}
+
+int HardwareSerial::available()
+{
+  uint64_t n = arrived() - consumed;
+  return n > 0x7FFFFFFF ? 0x7FFFFFFF : (int)n;
+}
+
+int HardwareSerial::peek()
+{
+  return available() > 0 ? HostSim.captureByte(consumed) : -1;
+}
+
+int HardwareSerial::read()
+{
+  if (available() <= 0)
+    return -1;
+
+  HostSim.uartRead(1);
+  return HostSim.captureByte(consumed++);
+}
+
+size_t HardwareSerial::readBytes(char *buffer, size_t length)
+{
+  size_t avail = available();
+  size_t n = length < avail ? length : avail;
+
+  for (size_t i = 0; i < n; i++)
+    buffer[i] = HostSim.captureByte(consumed + i);
+
+  consumed += n;
+  HostSim.uartRead(n);
+  return n;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  if (uart == 0)
+    HostSim.consoleWrite(buffer, size);
+  return size;
+}
@@ -0,0 +1,50 @@
+#ifndef _HOSTSIM_HARDWARESERIAL_H_
+#define _HOSTSIM_HARDWARESERIAL_H_
+
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+/*
+  UART 0 is the console: output is counted, and echoed to stdout when
+  HostSim is asked to. Every other UART receives the capture HostSim was
+  given, one byte every 10 bit times at the baud rate begin() was called
+  with, measured on the HostSim clock from the moment begin() was called.
+*/
+class HardwareSerial : public Stream
+{
+public:
+  HardwareSerial(int uart_nr);
+
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1,
+             int8_t txPin = -1, bool invert = false, unsigned long timeout_ms = 20000UL);
+  void end();
+
+  int available() override;
+  int peek() override;
+  int read() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  using Stream::readBytes;
+  size_t read(uint8_t *buffer, size_t size) { return readBytes(buffer, size); }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  size_t setRxBufferSize(size_t size) { return size; }
+  uint32_t baudRate() const { return baud; }
+  operator bool() const { return true; }
+
+private:
+  uint64_t arrived() const;
+
+  int uart;
+  unsigned long baud;
+  bool started;
+  uint64_t startTime;
+  uint64_t consumed;
+};
+
+extern HardwareSerial Serial;
+
+#endif
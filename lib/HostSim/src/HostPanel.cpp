@@ -0,0 +1,265 @@
+#include "HostPanel.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define CMD_SWRESET 0x01
+#define CMD_CASET 0x2A
+#define CMD_PASET 0x2B
+#define CMD_RAMWR 0x2C
+#define CMD_RAMRD 0x2E
+#define CMD_MADCTL 0x36
+#define CMD_RAMWRC 0x3C
+
+#define MADCTL_MV 0x20
+
+HostPanel::HostPanel()
+    : nativeWidth(HOSTSIM_TFT_WIDTH), nativeHeight(HOSTSIM_TFT_HEIGHT),
+      dcPin(HOSTSIM_TFT_DC), csPin(HOSTSIM_TFT_CS), dataMode(true), selected(true),
+      command(0), argCount(0), swapped(false), xs(0), xe(0), ys(0), ye(0), windowChanged(true),
+      cx(0), cy(0), partialCount(0)
+{
+  frame = new uint16_t[(size_t)nativeWidth * nativeHeight]();
+  resetCounters();
+}
+
+HostPanel::~HostPanel()
+{
+  delete[] frame;
+}
+
+void HostPanel::resetCounters()
+{
+  byteCount = 0;
+  commandCount = 0;
+  windowCount = 0;
+  pixelCount = 0;
+  memset(opcodeCount, 0, sizeof(opcodeCount));
+}
+
+void HostPanel::pinChanged(uint8_t pin, uint8_t level)
+{
+  if (pin == dcPin)
+    dataMode = level != 0;
+  else if (pin == csPin)
+    selected = level == 0;
+}
+
+uint8_t HostPanel::transfer(uint8_t data)
+{
+  if (!selected)
+    return 0xFF;
+
+  byteCount++;
+
+  if (!dataMode)
+  {
+    command = data;
+    argCount = 0;
+    partialCount = 0;
+    commandCount++;
+    opcodeCount[data]++;
+
+    switch (data)
+    {
+    case CMD_SWRESET:
+      swapped = false;
+      break;
+    case CMD_RAMWR:
+      if (windowChanged)
+        windowCount++;
+      windowChanged = false;
+      // fall through
+    case CMD_RAMRD:
+      cx = xs;
+      cy = ys;
+      break;
+    }
+    return 0;
+  }
+
+  switch (command)
+  {
+  case CMD_CASET:
+  case CMD_PASET:
+  case CMD_MADCTL:
+    argument(data);
+    return 0;
+
+  case CMD_RAMWR:
+  case CMD_RAMWRC:
+    partial[partialCount++] = data;
+    if (partialCount == 2)
+    {
+      writePixel(partial[0] << 8 | partial[1]);
+      partialCount = 0;
+    }
+    return 0;
+
+  case CMD_RAMRD:
+  {
+    // A dummy byte, then 6 bits of red, green and blue per pixel
+    if (argCount == 0)
+    {
+      argCount = 1;
+      return 0;
+    }
+
+    uint16_t *p = cursorPixel();
+    uint16_t color = p ? *p : 0;
+    uint8_t value;
+
+    if (partialCount == 0)
+      value = (color >> 8) & 0xF8;
+    else if (partialCount == 1)
+      value = (color >> 3) & 0xFC;
+    else
+      value = (color << 3) & 0xF8;
+
+    if (++partialCount == 3)
+    {
+      partialCount = 0;
+      advance();
+    }
+    return value;
+  }
+  }
+
+  return 0;
+}
+
+// True while data bytes are pixels, whole ones so far
+bool HostPanel::writingPixels() const
+{
+  return selected && dataMode && (command == CMD_RAMWR || command == CMD_RAMWRC) &&
+         partialCount == 0;
+}
+
+void HostPanel::write(const uint8_t *data, size_t len)
+{
+  if (!writingPixels())
+  {
+    while (len--)
+      transfer(*data++);
+    return;
+  }
+
+  byteCount += len;
+  for (; len >= 2; len -= 2, data += 2)
+    writePixel(data[0] << 8 | data[1]);
+
+  if (len)
+    partial[partialCount++] = *data;
+}
+
+void HostPanel::fill(uint16_t color, uint32_t count)
+{
+  if (!writingPixels())
+  {
+    while (count--)
+    {
+      transfer(color >> 8);
+      transfer(color);
+    }
+    return;
+  }
+
+  byteCount += 2ULL * count;
+  while (count--)
+    writePixel(color);
+}
+
+void HostPanel::argument(uint8_t data)
+{
+  if (command == CMD_MADCTL)
+  {
+    swapped = (data & MADCTL_MV) != 0;
+    return;
+  }
+
+  if (argCount >= 4)
+    return;
+
+  args[argCount++] = data;
+  if (argCount < 4)
+    return;
+
+  uint16_t start = args[0] << 8 | args[1];
+  uint16_t end = args[2] << 8 | args[3];
+
+  if (command == CMD_CASET)
+  {
+    windowChanged |= start != xs || end != xe;
+    xs = start;
+    xe = end;
+  }
+  else
+  {
+    windowChanged |= start != ys || end != ye;
+    ys = start;
+    ye = end;
+  }
+}
+
+uint16_t *HostPanel::cursorPixel()
+{
+  if (cx >= width() || cy >= height() || cy > ye)
+    return NULL;
+
+  // The buffer is kept in native orientation, MV writes down the columns
+  if (swapped)
+    return &frame[(size_t)cx * nativeWidth + cy];
+  return &frame[(size_t)cy * nativeWidth + cx];
+}
+
+void HostPanel::advance()
+{
+  if (++cx > xe)
+  {
+    cx = xs;
+    cy++;
+  }
+}
+
+void HostPanel::writePixel(uint16_t color)
+{
+  uint16_t *p = cursorPixel();
+  if (p)
+    *p = color;
+
+  pixelCount++;
+  advance();
+}
+
+uint16_t HostPanel::readPixel(uint16_t x, uint16_t y) const
+{
+  if (x >= width() || y >= height())
+    return 0;
+
+  if (swapped)
+    return frame[(size_t)x * nativeWidth + y];
+  return frame[(size_t)y * nativeWidth + x];
+}
+
+bool HostPanel::writePPM(const char *path) const
+{
+  FILE *f = fopen(path, "wb");
+  if (!f)
+    return false;
+
+  fprintf(f, "P6\n%u %u\n255\n", width(), height());
+
+  for (uint16_t y = 0; y < height(); y++)
+  {
+    for (uint16_t x = 0; x < width(); x++)
+    {
+      uint16_t c = readPixel(x, y);
+      uint8_t rgb[3] = {(uint8_t)((c >> 8 & 0xF8) | c >> 13),
+                        (uint8_t)((c >> 3 & 0xFC) | (c >> 9 & 0x03)),
+                        (uint8_t)((c << 3 & 0xF8) | (c >> 2 & 0x07))};
+      fwrite(rgb, 1, sizeof(rgb), f);
+    }
+  }
+
+  return fclose(f) == 0;
+}
@@ -0,0 +1,93 @@
+#ifndef _HOSTSIM_HOSTPANEL_H_
+#define _HOSTSIM_HOSTPANEL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Pins TFT_eSPI drives for DC and CS, -1 treats every byte as panel data
+#ifndef HOSTSIM_TFT_DC
+#define HOSTSIM_TFT_DC -1
+#endif
+#ifndef HOSTSIM_TFT_CS
+#define HOSTSIM_TFT_CS -1
+#endif
+
+// Native size of the panel, before MADCTL exchanges rows and columns
+#ifndef HOSTSIM_TFT_WIDTH
+#define HOSTSIM_TFT_WIDTH 240
+#endif
+#ifndef HOSTSIM_TFT_HEIGHT
+#define HOSTSIM_TFT_HEIGHT 320
+#endif
+
+/*
+  RAM framebuffer that decodes the ILI9341/ST7789 command stream arriving
+  on the SPI bus: CASET and PASET set the window, RAMWR fills it with
+  RGB565 pixels, RAMRD reads it back as RGB666 after a dummy byte and
+  MADCTL with MV set exchanges width and height. Mirroring bits are
+  ignored, the buffer holds the picture the way the sketch addresses it.
+
+  Every byte and command is counted, so the cost of a drawing sequence on
+  the bus can be measured without a display attached. A window is counted
+  when RAMWR starts one other than the last.
+*/
+class HostPanel
+{
+public:
+  HostPanel();
+  ~HostPanel();
+
+  void pinChanged(uint8_t pin, uint8_t level);
+  uint8_t transfer(uint8_t data);
+
+  // Bytes as transfer() takes them, and a run of one colour, in one call
+  void write(const uint8_t *data, size_t len);
+  void fill(uint16_t color, uint32_t count);
+
+  uint16_t width() const { return swapped ? nativeHeight : nativeWidth; }
+  uint16_t height() const { return swapped ? nativeWidth : nativeHeight; }
+  uint16_t readPixel(uint16_t x, uint16_t y) const;
+
+  // Binary PPM of what the panel shows, returns false if it cannot be written
+  bool writePPM(const char *path) const;
+
+  uint64_t bytes() const { return byteCount; }
+  uint64_t commands() const { return commandCount; }
+  uint64_t commands(uint8_t opcode) const { return opcodeCount[opcode]; }
+  uint64_t windows() const { return windowCount; }
+  uint64_t pixels() const { return pixelCount; }
+
+  void resetCounters();
+
+private:
+  void argument(uint8_t data);
+  void writePixel(uint16_t color);
+  uint16_t *cursorPixel();
+  void advance();
+  bool writingPixels() const;
+
+  uint16_t nativeWidth, nativeHeight;
+  uint16_t *frame;
+
+  int dcPin, csPin;
+  bool dataMode, selected;
+
+  uint8_t command;
+  uint8_t args[4];
+  uint8_t argCount;
+  bool swapped;
+
+  uint16_t xs, xe, ys, ye;
+  bool windowChanged;
+  uint16_t cx, cy;
+  uint8_t partial[3];
+  uint8_t partialCount;
+
+  uint64_t byteCount;
+  uint64_t commandCount;
+  uint64_t opcodeCount[256];
+  uint64_t windowCount;
+  uint64_t pixelCount;
+};
+
+#endif
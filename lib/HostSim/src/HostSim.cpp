@@ -0,0 +1,402 @@
+#include "HostSim.h"
+#include "Arduino.h"
+#include "SD.h"
+
+#include <chrono>
+#include <unistd.h>
+
+// Before the sketch's globals, whose constructors may already drive pins
+HostSimClass HostSim __attribute__((init_priority(101)));
+
+static uint64_t hostMicros()
+{
+  using namespace std::chrono;
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void usage(const char *program)
+{
+  fprintf(stderr,
+          "usage: %s [options] [capture]\n"
+          "\n"
+          "Runs the sketch with the capture file fed to its GPS UART on a simulated\n"
+          "clock, then reports parse throughput, display and SD traffic.\n"
+          "Without a capture the host clock is used and loop() runs once unless a\n"
+          "time limit is given.\n"
+          "\n"
+          "  --hours H      stop after H hours\n"
+          "  --seconds S    stop after S seconds\n"
+          "  --loop         replay the capture from the start when it runs out\n"
+          "  --simulate     use the simulated clock without a capture, needs a time limit\n"
+          "  --baud N       feed the capture at N baud, whatever the sketch opens\n"
+          "  --tick-us N    simulated microseconds per millis() or micros() call (%u)\n"
+          "  --spi-hz N     charge display bus time to the clock at N Hz (free)\n"
+          "  --sd DIR       directory standing in for the SD card (sdcard)\n"
+          "  --no-sd        make SD.begin() fail\n"
+          "  --sd-us N      make every SD write take N microseconds more\n"
+          "  --sd-rate N    make SD writes run at N KB/s\n"
+          "  --sd-stall N   stall every %uth SD write for N ms, like a card erasing\n"
+          "  --sd-alloc N   make each %u KB cluster a write allocates take N ms more\n"
+          "  --serial       echo Serial output to stdout\n"
+          "  --ppm FILE     write the final panel contents as a PPM image\n"
+          "  --ppm-every N  with --ppm, also write FILE-0001.ppm on every N simulated ms\n",
+          program, HOSTSIM_TICK_US, HOSTSIM_SD_STALL_EVERY, HOSTSIM_SD_CLUSTER / 1024);
+}
+
+static bool loadCapture(const char *path, std::vector<uint8_t> &data)
+{
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return false;
+
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    data.insert(data.end(), buf, buf + n);
+
+  fclose(f);
+  return !data.empty();
+}
+
+HostSimClass::HostSimClass()
+    : looping(false), simulate(false), baudOverride(0), captureEnd(0), limit(0), tickUs(HOSTSIM_TICK_US),
+      busHz(0), busBits(0), sdDir("sdcard"), sdLatencyUs(0), sdRate(0), sdStallMs(0),
+      sdAllocMs(0), sdWrites(0), ppmPath(NULL), ppmEveryMs(0), nextFrame(0), frames(0), echo(false), loopThread(std::this_thread::get_id()), clock(0),
+      wakeAt(0), ended(false), start(hostMicros()), wallSeconds(0), loops(0), uartBytes(0), consoleBytes(0)
+{
+}
+
+bool HostSimClass::begin(int argc, char **argv)
+{
+  const char *path = NULL;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    bool takesValue = true;
+
+    if (!strcmp(arg, "--hours") && value)
+      limit = atof(value) * 3600e6;
+    else if (!strcmp(arg, "--seconds") && value)
+      limit = atof(value) * 1e6;
+    else if (!strcmp(arg, "--baud") && value)
+      baudOverride = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--tick-us") && value)
+      tickUs = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--spi-hz") && value)
+      busHz = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--sd") && value)
+      sdDir = value;
+    else if (!strcmp(arg, "--sd-us") && value)
+      sdLatencyUs = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--sd-rate") && value)
+      sdRate = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--sd-stall") && value)
+      sdStallMs = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--sd-alloc") && value)
+      sdAllocMs = strtoul(value, NULL, 10);
+    else if (!strcmp(arg, "--ppm") && value)
+      ppmPath = value;
+    else if (!strcmp(arg, "--ppm-every") && value)
+      ppmEveryMs = strtoul(value, NULL, 10);
+    else
+    {
+      takesValue = false;
+
+      if (!strcmp(arg, "--loop"))
+        looping = true;
+      else if (!strcmp(arg, "--simulate"))
+        simulate = true;
+      else if (!strcmp(arg, "--no-sd"))
+        sdDir = NULL;
+      else if (!strcmp(arg, "--serial"))
+        echo = true;
+      else if (arg[0] != '-' && !path)
+        path = arg;
+      else
+      {
+        usage(argv[0]);
+        return false;
+      }
+    }
+
+    if (takesValue)
+      i++;
+  }
+
+  if (looping && !limit)
+  {
+    fprintf(stderr, "%s: --loop needs --hours or --seconds\n", argv[0]);
+    return false;
+  }
+
+  if (ppmEveryMs && !ppmPath)
+  {
+    fprintf(stderr, "%s: --ppm-every needs --ppm\n", argv[0]);
+    return false;
+  }
+
+  if (simulate && !path && !limit)
+  {
+    fprintf(stderr, "%s: --simulate needs --hours or --seconds\n", argv[0]);
+    return false;
+  }
+
+  if (path && !loadCapture(path, capture))
+  {
+    fprintf(stderr, "%s: cannot read %s\n", argv[0], path);
+    return false;
+  }
+  if (path)
+    simulate = true;
+  nextFrame = ppmEveryMs * 1000ULL;
+
+  start = hostMicros();
+  return true;
+}
+
+uint64_t HostSimClass::now() const
+{
+  return simulated() ? clock.load(std::memory_order_acquire) : hostMicros() - start;
+}
+
+uint64_t HostSimClass::tick()
+{
+  if (!simulated() || !onLoopThread())
+    return now();
+
+  advance(tickUs);
+  return now();
+}
+
+/*
+  A thread other than the loop's holds the simulated clock from its first
+  delay() until it ends, except while it waits in delay(). The work it does
+  in between takes no simulated time, like the loop's own, instead of as
+  much as the loop could run through meanwhile on the host.
+*/
+struct SimThread
+{
+  bool holding = false;
+
+  ~SimThread()
+  {
+    if (holding)
+      HostSim.release();
+  }
+};
+
+static thread_local SimThread simThread;
+
+void HostSimClass::release()
+{
+  wakeAt.store(0, std::memory_order_release);
+}
+
+void HostSimClass::delay(uint64_t us)
+{
+  if (!simulated())
+    usleep(us);
+  else if (onLoopThread())
+    advance(us);
+  else
+  {
+    // Another thread waits for the loop to get there
+    wakeAt.store(WAKE_RUNNING, std::memory_order_release);
+    simThread.holding = true;
+
+    uint64_t until = now() + us;
+    wakeAt.store(until, std::memory_order_release);
+    while (now() < until && !ended)
+      std::this_thread::yield();
+    wakeAt.store(WAKE_RUNNING, std::memory_order_release);
+  }
+}
+
+void HostSimClass::advance(uint64_t us)
+{
+  uint64_t from = clock.load(std::memory_order_relaxed);
+  uint64_t to = from + us;
+
+  while (!ended)
+  {
+    uint64_t wake = wakeAt.load(std::memory_order_acquire);
+    if (wake == WAKE_RUNNING)
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    if (wake <= from || wake > to)
+      break;
+
+    // Stop where the thread wakes and let it run to its next delay()
+    clock.store(wake, std::memory_order_release);
+    from = wake;
+    while (wakeAt.load(std::memory_order_acquire) == wake && !ended)
+      std::this_thread::yield();
+  }
+
+  clock.store(to, std::memory_order_release);
+
+  if (ppmEveryMs && to >= nextFrame)
+    writeFrame();
+}
+
+// The panel as it is now, part way through a drawing if it is
+void HostSimClass::writeFrame()
+{
+  char path[1024];
+  const char *dot = strrchr(ppmPath, '.');
+  int stem = dot && !strcmp(dot, ".ppm") ? (int)(dot - ppmPath) : (int)strlen(ppmPath);
+  snprintf(path, sizeof(path), "%.*s-%04u.ppm", stem, ppmPath, ++frames);
+
+  if (!panel.writePPM(path))
+    fprintf(stderr, "cannot write %s\n", path);
+
+  while (nextFrame <= now())
+    nextFrame += ppmEveryMs * 1000ULL;
+}
+
+unsigned long HostSimClass::uartBaud(unsigned long requested)
+{
+  return baudOverride ? baudOverride : requested;
+}
+
+void HostSimClass::uartStarted(uint64_t at, unsigned long baud)
+{
+  if (capture.empty() || !baud)
+    return;
+
+  // 8N1, ten bit times per byte
+  uint64_t end = at + capture.size() * 10000000ULL / baud;
+  if (end > captureEnd)
+    captureEnd = end;
+}
+
+void HostSimClass::consoleWrite(const uint8_t *buf, size_t size)
+{
+  consoleBytes += size;
+  if (echo)
+    fwrite(buf, 1, size, stdout);
+}
+
+uint8_t HostSimClass::busTransfer(uint8_t data)
+{
+  busWrite(1);
+  return panel.transfer(data);
+}
+
+void HostSimClass::busWrite(uint64_t len)
+{
+  if (busHz && simulated())
+  {
+    // Kept in bit-microseconds so no fraction of a microsecond is lost
+    busBits += len * 8 * 1000000ULL;
+    advance(busBits / busHz);
+    busBits %= busHz;
+  }
+}
+
+uint64_t HostSimClass::busMicros(uint64_t len) const
+{
+  if (!busHz || !simulated())
+    return 0;
+
+  return (len * 8 * 1000000ULL + busHz - 1) / busHz;
+}
+
+void HostSimClass::sdWrite(size_t bytes, uint32_t clusters)
+{
+  uint64_t us = sdLatencyUs;
+  if (sdRate)
+    us += bytes * 1000ULL / sdRate;
+  if (sdStallMs && ++sdWrites % HOSTSIM_SD_STALL_EVERY == 0)
+    us += sdStallMs * 1000ULL;
+  us += clusters * sdAllocMs * 1000ULL;
+
+  if (us)
+    delay(us);
+}
+
+bool HostSimClass::finished() const
+{
+  if (limit)
+    return now() >= limit;
+
+  if (!simulated())
+    return true;
+
+  // A sketch that never opens a UART gets the drain time only
+  return now() >= captureEnd + HOSTSIM_DRAIN_US;
+}
+
+int HostSimClass::run()
+{
+  uint64_t wallStart = hostMicros();
+
+  setup();
+  do
+  {
+    loop();
+    loops++;
+    tick();
+  } while (!finished());
+
+  wallSeconds = (hostMicros() - wallStart) / 1e6;
+  ended = true;
+
+  if (ppmPath && !panel.writePPM(ppmPath))
+    fprintf(stderr, "cannot write %s\n", ppmPath);
+
+  report(stdout);
+  return 0;
+}
+
+void HostSimClass::report(FILE *out) const
+{
+  double simSeconds = now() / 1e6;
+  double perHour = simSeconds > 0 ? 3600.0 / simSeconds : 0;
+  double wall = wallSeconds > 0 ? wallSeconds : 1e-6;
+  const fs::FSStats &sd = SD.stats();
+
+  if (simulated())
+    fprintf(out, "\n%.1f s simulated in %.2f s of host time (%.0fx), %llu loops\n", simSeconds,
+            wallSeconds, simSeconds / wall, (unsigned long long)loops);
+  else
+    fprintf(out, "\n%.2f s of host time, %llu loops\n", wallSeconds, (unsigned long long)loops);
+
+  fprintf(out, "  GPS UART  %llu bytes read, %.0f bytes/s of host time\n",
+          (unsigned long long)uartBytes, uartBytes / wall);
+
+  fprintf(out,
+          "  Display   %llu bytes, %llu commands (CASET %llu, PASET %llu, RAMWR %llu), %llu windows, "
+          "%llu pixels\n",
+          (unsigned long long)panel.bytes(), (unsigned long long)panel.commands(),
+          (unsigned long long)panel.commands(0x2A), (unsigned long long)panel.commands(0x2B),
+          (unsigned long long)panel.commands(0x2C), (unsigned long long)panel.windows(),
+          (unsigned long long)panel.pixels());
+
+  fprintf(out, "  SD card   %llu bytes in %u writes, %u opens, %u flushes\n",
+          (unsigned long long)sd.bytesWritten, sd.writes, sd.opens, sd.flushes);
+
+  fprintf(out, "  Console   %llu bytes\n", (unsigned long long)consoleBytes);
+
+  if (!simulated())
+    return;
+
+  fprintf(out, "Per simulated hour\n");
+  fprintf(out, "  GPS UART  %.0f bytes\n", uartBytes * perHour);
+  fprintf(out, "  Display   %.0f bytes, %.0f commands\n", panel.bytes() * perHour,
+          panel.commands() * perHour);
+  fprintf(out, "  SD card   %.0f bytes, %.0f writes, %.0f opens\n", sd.bytesWritten * perHour,
+          sd.writes * perHour, sd.opens * perHour);
+}
+
+int main(int argc, char **argv)
+{
+  if (!HostSim.begin(argc, argv))
+    return 2;
+
+  return HostSim.run();
+}
@@ -0,0 +1,129 @@
+#ifndef _HOSTSIM_H_
+#define _HOSTSIM_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "HostPanel.h"
+
+// Simulated microseconds that pass on every millis() or micros() call
+#ifndef HOSTSIM_TICK_US
+#define HOSTSIM_TICK_US 100
+#endif
+
+// Simulated time the run goes on for after the capture has been received
+#define HOSTSIM_DRAIN_US 5000000ULL
+
+// SD writes between the stalls of --sd-stall
+#define HOSTSIM_SD_STALL_EVERY 64
+
+// Allocation unit of the card's FAT volume, for --sd-alloc
+#define HOSTSIM_SD_CLUSTER 32768
+
+// wakeAt while another thread runs, the clock waits for it
+#define WAKE_RUNNING UINT64_MAX
+
+/*
+  Runs a sketch on the host and reports what it cost.
+
+  Given a capture file, the clock is simulated: it only moves when the
+  sketch asks for the time, delays or loops, so a recorded hour of NMEA
+  runs in as long as the parsing, drawing and logging take on the host.
+  Without one the clock is the host's, for sketches that time themselves,
+  unless it is asked for, e.g. for a sketch that replays its own file.
+
+  The clock belongs to the thread that runs loop(). One other thread, such
+  as a writer the sketch starts, reads it without moving it, and its
+  delay() holds the loop at the time it is due to wake until it has woken,
+  so its waits last as long in simulated time however the host schedules
+  it.
+
+  main() is provided here; the sketch supplies setup() and loop().
+*/
+class HostSimClass
+{
+public:
+  HostSimClass();
+
+  // Parses the command line, prints the usage and returns false on an error
+  bool begin(int argc, char **argv);
+
+  // setup(), then loop() until the capture or the time limit runs out
+  int run();
+  void report(FILE *out) const;
+
+  // Microseconds since start, tick() is now() plus one tick of progress
+  uint64_t now() const;
+  uint64_t tick();
+  void delay(uint64_t us);
+  void release(); // by a thread that called delay(), when it ends
+  bool simulated() const { return simulate; }
+
+  // The capture every UART other than the console receives
+  size_t captureSize() const { return capture.size(); }
+  bool captureLoops() const { return looping; }
+  uint8_t captureByte(uint64_t index) const { return capture[index % capture.size()]; }
+  unsigned long uartBaud(unsigned long requested);
+  void uartStarted(uint64_t at, unsigned long baud);
+  void uartRead(size_t n) { uartBytes += n; }
+
+  void consoleWrite(const uint8_t *buf, size_t size);
+
+  // Display bus: a byte, or len bytes' worth of time for a bulk write, and
+  // how long len bytes take there at --spi-hz, 0 if the bus is free
+  uint8_t busTransfer(uint8_t data);
+  void busWrite(uint64_t len);
+  uint64_t busMicros(uint64_t len) const;
+
+  // Directory standing in for the SD card, NULL when there is no card
+  const char *sdCard() const { return sdDir; }
+
+  // Holds up the caller for as long as the throttled card takes to write
+  void sdWrite(size_t bytes, uint32_t clusters);
+
+  HostPanel panel;
+
+private:
+  bool finished() const;
+  bool onLoopThread() const { return std::this_thread::get_id() == loopThread; }
+  void advance(uint64_t us);
+  void writeFrame();
+
+  std::vector<uint8_t> capture;
+  bool looping;
+  bool simulate;
+  unsigned long baudOverride;
+  uint64_t captureEnd;
+  uint64_t limit;
+  uint32_t tickUs;
+  uint32_t busHz;
+  uint64_t busBits;
+  const char *sdDir;
+  uint32_t sdLatencyUs;
+  uint32_t sdRate;
+  uint32_t sdStallMs;
+  uint32_t sdAllocMs;
+  uint32_t sdWrites;
+  const char *ppmPath;
+  uint32_t ppmEveryMs;
+  uint64_t nextFrame;
+  uint32_t frames;
+  bool echo;
+
+  std::thread::id loopThread;
+  std::atomic<uint64_t> clock;
+  std::atomic<uint64_t> wakeAt; // when the thread in delay() wants to go on, or WAKE_RUNNING
+  std::atomic<bool> ended;
+  uint64_t start;
+  double wallSeconds;
+  uint64_t loops;
+  uint64_t uartBytes;
+  uint64_t consoleBytes;
+};
+
+extern HostSimClass HostSim;
+
+#endif
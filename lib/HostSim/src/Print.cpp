@@ -0,0 +1,86 @@
+#include "Print.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+    n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+  char buf[256];
+  va_list args;
+
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+
+  if (len < 0)
+    return 0;
+  return write((const uint8_t *)buf, (size_t)len < sizeof(buf) ? len : sizeof(buf) - 1);
+}
+
+static size_t printNumber(Print &p, unsigned long long n, bool negative, int base)
+{
+  char buf[8 * sizeof(n) + 2];
+  char *str = &buf[sizeof(buf) - 1];
+
+  if (base < 2)
+    base = 10;
+
+  *str = 0;
+  do
+  {
+    int digit = n % base;
+    *--str = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    n /= base;
+  } while (n);
+
+  if (negative)
+    *--str = '-';
+
+  return p.write(str);
+}
+
+size_t Print::print(long n, int base)
+{
+  return print((long long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+  return printNumber(*this, n, false, base);
+}
+
+size_t Print::print(long long n, int base)
+{
+  // Like the core, only decimal prints a sign
+  if (base == 10 && n < 0)
+    return printNumber(*this, -(unsigned long long)n, true, base);
+  return printNumber(*this, (unsigned long long)n, false, base);
+}
+
+size_t Print::print(unsigned long long n, int base)
+{
+  return printNumber(*this, n, false, base);
+}
+
+size_t Print::print(double number, int digits)
+{
+  if (isnan(number))
+    return write("nan");
+  if (isinf(number))
+    return write("inf");
+  if (number > 4294967040.0 || number < -4294967040.0)
+    return write("ovf");
+
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, number);
+  return write(buf);
+}
@@ -0,0 +1,49 @@
+#ifndef _HOSTSIM_PRINT_H_
+#define _HOSTSIM_PRINT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print
+{
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+  size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+  virtual void flush() {}
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+  size_t print(const __FlashStringHelper *str) { return write((const char *)str); }
+  size_t print(const String &str) { return write(str.c_str(), str.length()); }
+  size_t print(const char str[]) { return write(str); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char n, int base = DEC) { return print((unsigned long)n, base); }
+  size_t print(int n, int base = DEC) { return print((long)n, base); }
+  size_t print(unsigned int n, int base = DEC) { return print((unsigned long)n, base); }
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t print(long long n, int base = DEC);
+  size_t print(unsigned long long n, int base = DEC);
+  size_t print(double n, int digits = 2);
+  size_t print(bool b) { return print((int)b); }
+
+  template <typename T>
+  size_t println(T value) { return print(value) + println(); }
+  template <typename T>
+  size_t println(T value, int format) { return print(value, format) + println(); }
+  size_t println() { return write("\r\n"); }
+};
+
+#endif
@@ -0,0 +1,13 @@
+#include "SD.h"
+#include "HostSim.h"
+
+SDFS SD;
+
+bool SDFS::begin(uint8_t ssPin, SPIClass &spi, uint32_t frequency, const char *mountpoint,
+                 uint8_t max_files)
+{
+  if (!HostSim.sdCard())
+    return false;
+
+  return mount(HostSim.sdCard());
+}
@@ -0,0 +1,18 @@
+#ifndef _HOSTSIM_SD_H_
+#define _HOSTSIM_SD_H_
+
+#include "FS.h"
+#include "SPI.h"
+
+// The card is the directory HostSim was given, or missing if it was told so
+class SDFS : public fs::FS
+{
+public:
+  bool begin(uint8_t ssPin = 5, SPIClass &spi = SPI, uint32_t frequency = 4000000,
+             const char *mountpoint = "/sd", uint8_t max_files = 5);
+  void end() { mounted = false; }
+};
+
+extern SDFS SD;
+
+#endif
@@ -0,0 +1,45 @@
+#include "SPI.h"
+#include "HostSim.h"
+
+SPIClass SPI;
+
+uint8_t SPIClass::transfer(uint8_t data)
+{
+  if (this != &SPI)
+    return 0xFF;
+
+  return HostSim.busTransfer(data);
+}
+
+uint16_t SPIClass::transfer16(uint16_t data)
+{
+  uint16_t r = transfer(data >> 8) << 8;
+  return r | transfer(data);
+}
+
+uint32_t SPIClass::transfer32(uint32_t data)
+{
+  uint32_t r = (uint32_t)transfer16(data >> 16) << 16;
+  return r | transfer16(data);
+}
+
+void SPIClass::transfer(uint8_t *data, uint32_t size)
+{
+  while (size--)
+  {
+    *data = transfer(*data);
+    data++;
+  }
+}
+
+void SPIClass::writeBytes(const uint8_t *data, uint32_t size)
+{
+  while (size--)
+    transfer(*data++);
+}
+
+void SPIClass::writePattern(const uint8_t *data, uint8_t size, uint32_t repeat)
+{
+  while (repeat--)
+    writeBytes(data, size);
+}
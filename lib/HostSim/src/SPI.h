@@ -0,0 +1,67 @@
+#ifndef _HOSTSIM_SPI_H_
+#define _HOSTSIM_SPI_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SPI_HAS_TRANSACTION
+
+#define SPI_LSBFIRST 0
+#define SPI_MSBFIRST 1
+#define LSBFIRST SPI_LSBFIRST
+#define MSBFIRST SPI_MSBFIRST
+
+#define SPI_MODE0 0
+#define SPI_MODE1 1
+#define SPI_MODE2 2
+#define SPI_MODE3 3
+
+#define FSPI 1
+#define HSPI 2
+#define VSPI 3
+
+class SPISettings
+{
+public:
+  SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = SPI_MSBFIRST, uint8_t dataMode = SPI_MODE0)
+      : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+
+  uint32_t clock;
+  uint8_t bitOrder;
+  uint8_t dataMode;
+};
+
+/*
+  Bytes on the global SPI instance go to HostSim's panel, for a display
+  library without a HostSim back end. Other buses, such as the one the SD card is on, only
+  take part in name: the card itself is a host directory.
+*/
+class SPIClass
+{
+public:
+  SPIClass(uint8_t spi_bus = HSPI) : bus(spi_bus) {}
+
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+  void end() {}
+
+  void setHwCs(bool use) {}
+  void setFrequency(uint32_t freq) {}
+  void setDataMode(uint8_t dataMode) {}
+  void setBitOrder(uint8_t bitOrder) {}
+  void beginTransaction(SPISettings settings) {}
+  void endTransaction() {}
+
+  uint8_t transfer(uint8_t data);
+  uint16_t transfer16(uint16_t data);
+  uint32_t transfer32(uint32_t data);
+  void transfer(uint8_t *data, uint32_t size);
+  void writeBytes(const uint8_t *data, uint32_t size);
+  void writePattern(const uint8_t *data, uint8_t size, uint32_t repeat);
+
+private:
+  uint8_t bus;
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef _HOSTSIM_WSTRING_H_
+#define _HOSTSIM_WSTRING_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+class __FlashStringHelper;
+
+// Arduino String over std::string, enough for the firmware and examples
+class String
+{
+public:
+  String(const char *cstr = "") : s(cstr ? cstr : "") {}
+  String(const __FlashStringHelper *str) : s((const char *)str) {}
+  String(const std::string &str) : s(str) {}
+  explicit String(char c) : s(1, c) {}
+  explicit String(int value) : s(std::to_string(value)) {}
+  explicit String(unsigned value) : s(std::to_string(value)) {}
+  explicit String(long value) : s(std::to_string(value)) {}
+  explicit String(unsigned long value) : s(std::to_string(value)) {}
+  explicit String(double value, unsigned decimals = 2)
+  {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    s = buf;
+  }
+
+  unsigned length() const { return s.length(); }
+  const char *c_str() const { return s.c_str(); }
+  char charAt(unsigned index) const { return index < s.length() ? s[index] : 0; }
+  char operator[](unsigned index) const { return charAt(index); }
+
+  void toCharArray(char *buf, unsigned bufsize, unsigned index = 0) const
+  {
+    if (!bufsize)
+      return;
+    size_t n = index < s.length() ? s.copy(buf, bufsize - 1, index) : 0;
+    buf[n] = 0;
+  }
+
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+
+  int indexOf(char c, unsigned from = 0) const
+  {
+    size_t i = s.find(c, from);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  int indexOf(const String &str, unsigned from = 0) const
+  {
+    size_t i = s.find(str.s, from);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  String substring(unsigned from) const { return from < s.length() ? String(s.substr(from)) : String(); }
+  String substring(unsigned from, unsigned to) const
+  {
+    return from < to && from < s.length() ? String(s.substr(from, to - from)) : String();
+  }
+
+  bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.length(), prefix.s) == 0; }
+  bool endsWith(const String &suffix) const
+  {
+    return s.length() >= suffix.s.length() &&
+           s.compare(s.length() - suffix.s.length(), suffix.s.length(), suffix.s) == 0;
+  }
+
+  String &operator+=(const String &rhs)
+  {
+    s += rhs.s;
+    return *this;
+  }
+  String &operator+=(const char *rhs)
+  {
+    s += rhs;
+    return *this;
+  }
+  String &operator+=(char c)
+  {
+    s += c;
+    return *this;
+  }
+  friend String operator+(const String &lhs, const String &rhs) { return String(lhs.s + rhs.s); }
+  friend String operator+(const String &lhs, const char *rhs) { return String(lhs.s + rhs); }
+
+  bool operator==(const String &rhs) const { return s == rhs.s; }
+  bool operator==(const char *rhs) const { return s == rhs; }
+  bool operator!=(const String &rhs) const { return s != rhs.s; }
+  bool operator!=(const char *rhs) const { return s != rhs; }
+
+private:
+  std::string s;
+};
+
+#endif
@@ -0,0 +1,419 @@
+/**************************************************************************************
+// The following class records graphics calls and renders them to the TFT a band of
+// lines at a time through two band Sprites, see Bands.h
+***************************************************************************************/
+
+// Types of call recorded
+#define BAND_PIXEL 0
+#define BAND_HLINE 1
+#define BAND_VLINE 2
+#define BAND_LINE  3
+#define BAND_RECT  4
+#define BAND_GLYPH 5 // GLCD or free font character
+#define BAND_CHAR  6 // Character in a numbered font
+
+// Back ends with pushImageDMA(), the others push each band as it is drawn
+#if defined (STM32_DMA) || defined (HOST_DMA)
+  #define BANDS_DMA
+#endif
+
+/***************************************************************************************
+** Function name:           TFT_eBands
+** Description:             Class constructor
+*************************************************************************************x*/
+TFT_eBands::TFT_eBands(TFT_eSPI *tft)
+{
+  _panel = tft;
+  _band[0] = nullptr;
+  _band[1] = nullptr;
+
+  _calls = nullptr;
+  _callMax = _callCount = 0;
+  _overflow = false;
+
+  _bandHeight = 0;
+  _background = TFT_BLACK;
+}
+
+
+/***************************************************************************************
+** Function name:           ~TFT_eBands
+** Description:             Class destructor
+*************************************************************************************x*/
+TFT_eBands::~TFT_eBands(void)
+{
+  deleteBands();
+}
+
+
+/***************************************************************************************
+** Function name:           createBands
+** Description:             Create the two band Sprites and the list of calls
+*************************************************************************************x*/
+bool TFT_eBands::createBands(int16_t height, uint16_t calls)
+{
+  deleteBands();
+
+  if (height < 1 || calls < 1) return false;
+
+  // Record in the coordinates of the TFT at its current rotation
+  _width  = _panel->width();
+  _height = _panel->height();
+  if (height > _height) height = _height;
+
+  _calls = (Call*) malloc(calls * sizeof(Call));
+  bool created = (_calls != nullptr);
+
+  for (uint8_t i = 0; i < 2; i++) {
+    _band[i] = new TFT_eSprite(_panel);
+    _band[i]->setColorDepth(16);
+    if (!_band[i]->createSprite(_width, height)) created = false;
+  }
+
+  if (!created) {
+    deleteBands();
+    return false;
+  }
+
+  _callMax = calls;
+  _bandHeight = height;
+  clear();
+
+  return true;
+}
+
+
+/***************************************************************************************
+** Function name:           deleteBands
+** Description:             Free the bands and the list of calls
+*************************************************************************************x*/
+void TFT_eBands::deleteBands(void)
+{
+  for (uint8_t i = 0; i < 2; i++) {
+    delete _band[i];
+    _band[i] = nullptr;
+  }
+
+  free(_calls);
+  _calls = nullptr;
+  _callMax = _callCount = 0;
+  _bandHeight = 0;
+}
+
+
+/***************************************************************************************
+** Function name:           setBackground
+** Description:             Set the colour the bands are cleared to
+*************************************************************************************x*/
+void TFT_eBands::setBackground(uint16_t color)
+{
+  _background = color;
+}
+
+
+/***************************************************************************************
+** Function name:           clear
+** Description:             Forget the calls recorded
+*************************************************************************************x*/
+void TFT_eBands::clear(void)
+{
+  _callCount = 0;
+  _overflow = false;
+}
+
+
+/***************************************************************************************
+** Function name:           recorded
+** Description:             Number of calls recorded
+*************************************************************************************x*/
+uint16_t TFT_eBands::recorded(void)
+{
+  return _callCount;
+}
+
+
+/***************************************************************************************
+** Function name:           overflowed
+** Description:             True if calls were lost since clear() for lack of room
+*************************************************************************************x*/
+bool TFT_eBands::overflowed(void)
+{
+  return _overflow;
+}
+
+
+/***************************************************************************************
+** Function name:           add
+** Description:             Return the next entry of the list, nullptr if full or the
+**                          call is off the screen
+*************************************************************************************x*/
+TFT_eBands::Call* TFT_eBands::add(uint8_t type, int32_t top, int32_t bottom)
+{
+  if ((bottom < 0) || (top >= _height) || (top > bottom)) return nullptr;
+
+  if (_callCount >= _callMax) {
+    _overflow = true;
+    return nullptr;
+  }
+
+  Call* call = &_calls[_callCount++];
+  call->type = type;
+  call->top = top < 0 ? 0 : top;
+  call->bottom = bottom >= _height ? _height - 1 : bottom;
+
+  return call;
+}
+
+
+/***************************************************************************************
+** Function name:           render
+** Description:             Draw the calls recorded on the TFT a band at a time
+*************************************************************************************x*/
+uint32_t TFT_eBands::render(void)
+{
+  if (!_bandHeight) return 0;
+
+  TFT_PROFILE_CALL("render");
+
+  uint32_t bytes = 0;
+#ifdef BANDS_DMA
+  bool dma = _panel->DMA_Enabled;
+#endif
+
+  // The band Sprites hold their pixels with the bytes already swapped
+  bool swap = _panel->getSwapBytes();
+  _panel->setSwapBytes(false);
+
+  _panel->startWrite();
+
+  uint8_t b = 0;
+  for (int32_t y = 0; y < _height; y += _bandHeight) {
+    int32_t h = _height - y < _bandHeight ? _height - y : _bandHeight;
+
+    // DMA may still be sending the other band, this one was sent before that began
+    drawBand(_band[b], y, h);
+
+    uint16_t* pixels = (uint16_t*) _band[b]->frameBuffer(1);
+#ifdef BANDS_DMA
+    if (dma) _panel->pushImageDMA(0, y, _width, h, pixels);
+    else
+#endif
+    _panel->pushImage(0, y, _width, h, pixels);
+
+    bytes += 2 * _width * h;
+    b ^= 1;
+  }
+
+#ifdef BANDS_DMA
+  if (dma) while (_panel->dmaBusy());
+#endif
+
+  _panel->endWrite();
+
+  _panel->setSwapBytes(swap);
+
+  return bytes;
+}
+
+
+/***************************************************************************************
+** Function name:           drawBand
+** Description:             Draw the calls that fall in the band at line y
+*************************************************************************************x*/
+void TFT_eBands::drawBand(TFT_eSprite *band, int32_t y, int32_t h)
+{
+  band->fillSprite(_background);
+
+#ifdef LOAD_GFXFF
+  const GFXfont *font = nullptr;
+  band->setFreeFont(font);
+#endif
+
+  int32_t bottom = y + h - 1;
+
+  for (uint16_t i = 0; i < _callCount; i++) {
+    const Call &c = _calls[i];
+    if ((c.bottom < y) || (c.top > bottom)) continue;
+
+    switch (c.type) {
+      case BAND_PIXEL:
+        band->drawPixel(c.x0, c.y0 - y, c.color);
+        break;
+      case BAND_HLINE:
+        band->drawFastHLine(c.x0, c.y0 - y, c.x1, c.color);
+        break;
+      case BAND_VLINE:
+        band->drawFastVLine(c.x0, c.y0 - y, c.y1, c.color);
+        break;
+      case BAND_LINE:
+        band->drawLine(c.x0, c.y0 - y, c.x1, c.y1 - y, c.color);
+        break;
+      case BAND_RECT:
+        band->fillRect(c.x0, c.y0 - y, c.x1, c.y1, c.color);
+        break;
+      case BAND_GLYPH:
+#ifdef LOAD_GFXFF
+        // setFreeFont() scans the font, so only when it changes
+        if (c.gfxFont != font) {
+          font = c.gfxFont;
+          band->setFreeFont(font);
+        }
+#endif
+        band->drawChar(c.x0, c.y0 - y, c.x1, c.color, c.bg, c.size);
+        break;
+      case BAND_CHAR:
+        band->setTextColor(c.color, c.bg);
+        band->setTextSize(c.size);
+        band->drawChar(c.x1, c.x0, c.y0 - y, c.font);
+        break;
+    }
+  }
+}
+
+
+/***************************************************************************************
+** Function name:           drawPixel
+** Description:             Record a pixel
+*************************************************************************************x*/
+void TFT_eBands::drawPixel(int32_t x, int32_t y, uint32_t color)
+{
+  if ((x < 0) || (x >= _width)) return;
+
+  Call* c = add(BAND_PIXEL, y, y);
+  if (!c) return;
+  c->x0 = x;
+  c->y0 = y;
+  c->color = color;
+}
+
+
+/***************************************************************************************
+** Function name:           drawFastHLine
+** Description:             Record a horizontal line
+*************************************************************************************x*/
+void TFT_eBands::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
+{
+  if ((w < 1) || (x >= _width) || (x + w <= 0)) return;
+
+  Call* c = add(BAND_HLINE, y, y);
+  if (!c) return;
+  c->x0 = x;
+  c->y0 = y;
+  c->x1 = w;
+  c->color = color;
+}
+
+
+/***************************************************************************************
+** Function name:           drawFastVLine
+** Description:             Record a vertical line
+*************************************************************************************x*/
+void TFT_eBands::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
+{
+  if ((h < 1) || (x < 0) || (x >= _width)) return;
+
+  Call* c = add(BAND_VLINE, y, y + h - 1);
+  if (!c) return;
+  c->x0 = x;
+  c->y0 = y;
+  c->y1 = h;
+  c->color = color;
+}
+
+
+/***************************************************************************************
+** Function name:           drawLine
+** Description:             Record a line
+*************************************************************************************x*/
+void TFT_eBands::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+  Call* c = add(BAND_LINE, y0 < y1 ? y0 : y1, y0 < y1 ? y1 : y0);
+  if (!c) return;
+  c->x0 = x0;
+  c->y0 = y0;
+  c->x1 = x1;
+  c->y1 = y1;
+  c->color = color;
+}
+
+
+/***************************************************************************************
+** Function name:           fillRect
+** Description:             Record a filled rectangle
+*************************************************************************************x*/
+void TFT_eBands::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+  if ((w < 1) || (h < 1) || (x >= _width) || (x + w <= 0)) return;
+
+  Call* c = add(BAND_RECT, y, y + h - 1);
+  if (!c) return;
+  c->x0 = x;
+  c->y0 = y;
+  c->x1 = w;
+  c->y1 = h;
+  c->color = color;
+}
+
+
+/***************************************************************************************
+** Function name:           drawChar
+** Description:             Record a GLCD or free font character
+*************************************************************************************x*/
+void TFT_eBands::drawChar(int32_t x, int32_t y, uint16_t ch, uint32_t color, uint32_t bg, uint8_t size)
+{
+  int32_t top = y, bottom = y + 8 * size - 1;
+
+#ifdef LOAD_GFXFF
+  // Free font glyphs are drawn about the baseline at y, within a line either side
+  if (gfxFont) {
+    int32_t line = pgm_read_byte(&gfxFont->yAdvance) * size;
+    top = y - line;
+    bottom = y + line;
+  }
+#endif
+
+  Call* c = add(BAND_GLYPH, top, bottom);
+  if (!c) return;
+  c->x0 = x;
+  c->y0 = y;
+  c->x1 = ch;
+  c->color = color;
+  c->bg = bg;
+  c->size = size;
+#ifdef LOAD_GFXFF
+  c->gfxFont = gfxFont;
+#endif
+}
+
+
+/***************************************************************************************
+** Function name:           drawChar
+** Description:             Record a character in a font, returns its width
+*************************************************************************************x*/
+int16_t TFT_eBands::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
+{
+  // Font 1 characters come back as GLCD or free font glyphs
+  if (font == 1) return TFT_eSPI::drawChar(uniCode, x, y, font);
+
+  if ((font>1) && (font<9) && ((uniCode < 32) || (uniCode > 127))) return 0;
+
+  char str[2] = { (char)uniCode, 0 };
+  int16_t w = textWidth(str, font);
+
+  Call* c = add(BAND_CHAR, y, y + fontHeight(font) - 1);
+  if (!c) return w;
+  c->x0 = x;
+  c->y0 = y;
+  c->x1 = uniCode;
+  c->color = textcolor;
+  c->bg = textbgcolor;
+  c->size = textsize;
+  c->font = font;
+
+  return w;
+}
+
+int16_t TFT_eBands::drawChar(uint16_t uniCode, int32_t x, int32_t y)
+{
+  return drawChar(uniCode, x, y, textfont);
+}
@@ -0,0 +1,85 @@
+/***************************************************************************************
+// The following class records the graphics drawn with it instead of sending them to
+// the TFT. render() then draws the whole screen a band of lines at a time into one of
+// two band Sprites and pushes each band to the TFT as it is finished. With DMA, on
+// STM32 processors and HostSim after initDMA(), the next band is drawn while the
+// last one is sent.
+//
+// The screen is never seen part drawn, as it would be after a fillScreen() and the
+// graphics over it, but takes only two bands of RAM: two 320 x 24 bands are 30 kbytes
+// where a 320 x 240 16 bit Sprite is 150 kbytes.
+//
+// The calls recorded are those of the virtual functions (pixels, lines, rectangles and
+// characters), so anything built on them is recorded too, e.g. fillScreen(), circles
+// and drawString(). Each takes one entry of the list: a drawCircle() takes one for each
+// of its pixels, a fillCircle() one for each line. Smooth fonts are not recorded.
+***************************************************************************************/
+
+class TFT_eBands : public TFT_eSPI {
+
+ public:
+
+  TFT_eBands(TFT_eSPI *tft);
+  ~TFT_eBands(void);
+
+           // Create the two bands of the TFT width and the list of calls, returns
+           // false if there is not enough RAM. RAM required is:
+           //  - 4 bytes per pixel of band width x height
+           //  - about 20 bytes per call recorded
+  bool     createBands(int16_t height, uint16_t calls = 512);
+  void     deleteBands(void);
+
+           // Colour the bands are cleared to before the calls are drawn
+  void     setBackground(uint16_t color);
+
+           // Forget the calls recorded, to start the next frame
+  void     clear(void);
+
+           // Number of calls recorded and whether any were lost for lack of room
+  uint16_t recorded(void);
+  bool     overflowed(void);
+
+           // Draw the calls recorded on the TFT, returns the pixel bytes sent
+  uint32_t render(void);
+
+           // Graphics functions that record the call instead of drawing
+  void     drawPixel(int32_t x, int32_t y, uint32_t color),
+           drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size),
+           drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color),
+           drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color),
+           drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color),
+           fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+
+  int16_t  drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font),
+           drawChar(uint16_t uniCode, int32_t x, int32_t y);
+
+ private:
+
+  struct Call {
+    uint8_t  type;
+    uint8_t  size;            // Text size
+    uint8_t  font;            // Font number of a character
+    int16_t  x0, y0, x1, y1;  // Coordinates, or width and height, or character code
+    int16_t  top, bottom;     // Lines drawn on, to skip the bands it misses
+    uint16_t color, bg;
+#ifdef LOAD_GFXFF
+    const GFXfont *gfxFont;   // Free font of a glyph, nullptr for GLCD
+#endif
+  };
+
+           // Next free entry of the list, nullptr when full
+  Call*    add(uint8_t type, int32_t top, int32_t bottom);
+
+           // Draw the calls that fall in the band at line y into a band Sprite
+  void     drawBand(TFT_eSprite *band, int32_t y, int32_t h);
+
+  TFT_eSPI    *_panel;
+  TFT_eSprite *_band[2];
+
+  Call    *_calls;
+  uint16_t _callMax, _callCount;
+  bool     _overflow;
+
+  int16_t  _bandHeight;
+  uint16_t _background;
+};
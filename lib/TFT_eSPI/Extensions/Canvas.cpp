@@ -0,0 +1,411 @@
+/**************************************************************************************
+// The following class is a Sprite that records the areas drawn over so that flush()
+// only sends those to the TFT, see Canvas.h
+***************************************************************************************/
+
+// CASET + 4 bytes, PASET + 4 bytes and RAMWR
+#define CANVAS_WINDOW_BYTES 11
+
+/***************************************************************************************
+** Function name:           TFT_eCanvas
+** Description:             Class constructor, the canvas is 8 bit colour by default
+*************************************************************************************x*/
+TFT_eCanvas::TFT_eCanvas(TFT_eSPI *tft) : TFT_eSprite(tft)
+{
+  _panel = tft;
+  _bpp = 8;
+
+  _rectCount = 0;
+  _windowCost = CANVAS_WINDOW_BYTES;
+
+  _depth = 0;
+  _pending.x0 = 1;
+  _pending.x1 = 0;
+}
+
+
+/***************************************************************************************
+** Function name:           createSprite
+** Description:             Create the canvas, damaged all over
+*************************************************************************************x*/
+void* TFT_eCanvas::createSprite(int16_t w, int16_t h)
+{
+  void* ptr = TFT_eSprite::createSprite(w, h);
+  if (!ptr) return ptr;
+
+  // fillScreen() and the text wrapping use these
+  _width  = w;
+  _height = h;
+
+  clearDamage();
+  damage(0, 0, w, h);
+
+  return ptr;
+}
+
+
+/***************************************************************************************
+** Function name:           setWindowCost
+** Description:             Set the bus bytes a window change is worth
+*************************************************************************************x*/
+void TFT_eCanvas::setWindowCost(uint16_t bytes)
+{
+  _windowCost = bytes;
+}
+
+
+/***************************************************************************************
+** Function name:           damage
+** Description:             Mark an area as changed
+*************************************************************************************x*/
+void TFT_eCanvas::damage(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+  if ((w < 1) || (h < 1)) return;
+
+  Rect r = { x, y, x + w - 1, y + h - 1 };
+  addRect(r);
+}
+
+
+/***************************************************************************************
+** Function name:           clearDamage
+** Description:             Forget the changed areas
+*************************************************************************************x*/
+void TFT_eCanvas::clearDamage(void)
+{
+  _rectCount = 0;
+}
+
+
+/***************************************************************************************
+** Function name:           damagedRects
+** Description:             Number of rectangles waiting to be flushed
+*************************************************************************************x*/
+uint8_t TFT_eCanvas::damagedRects(void)
+{
+  return _rectCount;
+}
+
+
+/***************************************************************************************
+** Function name:           damagedPixels
+** Description:             Number of pixels waiting to be flushed
+*************************************************************************************x*/
+uint32_t TFT_eCanvas::damagedPixels(void)
+{
+  uint32_t pixels = 0;
+  for (uint8_t i = 0; i < _rectCount; i++) {
+    pixels += (_rects[i].x1 - _rects[i].x0 + 1) * (_rects[i].y1 - _rects[i].y0 + 1);
+  }
+  return pixels;
+}
+
+
+/***************************************************************************************
+** Function name:           mergeGain
+** Description:             Bytes saved by sending the bounding box of a and b instead
+*************************************************************************************x*/
+int32_t TFT_eCanvas::mergeGain(const Rect &a, const Rect &b)
+{
+  int32_t x0 = a.x0 < b.x0 ? a.x0 : b.x0;
+  int32_t y0 = a.y0 < b.y0 ? a.y0 : b.y0;
+  int32_t x1 = a.x1 > b.x1 ? a.x1 : b.x1;
+  int32_t y1 = a.y1 > b.y1 ? a.y1 : b.y1;
+
+  // Where a and b overlap the pixels would be sent twice, so overlap is a gain too
+  int32_t apart = (a.x1 - a.x0 + 1) * (a.y1 - a.y0 + 1) + (b.x1 - b.x0 + 1) * (b.y1 - b.y0 + 1);
+  int32_t joined = (x1 - x0 + 1) * (y1 - y0 + 1);
+
+  return 2 * (apart - joined) + _windowCost;
+}
+
+
+/***************************************************************************************
+** Function name:           addRect
+** Description:             Add a rectangle to the list, merging where it saves bytes
+*************************************************************************************x*/
+void TFT_eCanvas::addRect(Rect r)
+{
+  if (!_created) return;
+
+  // Clip to the canvas
+  if (r.x0 < 0) r.x0 = 0;
+  if (r.y0 < 0) r.y0 = 0;
+  if (r.x1 >= _iwidth)  r.x1 = _iwidth  - 1;
+  if (r.y1 >= _iheight) r.y1 = _iheight - 1;
+  if ((r.x0 > r.x1) || (r.y0 > r.y1)) return;
+
+  // A merged rectangle is bigger and may now be worth joining to another, so the
+  // list is searched again until nothing merges. When the list is full the new
+  // rectangle joins the one it costs least to, even at a loss.
+  bool full = false;
+  while (_rectCount) {
+    int32_t best = full ? INT32_MIN : 0;
+    int8_t  bi = -1;
+
+    for (uint8_t i = 0; i < _rectCount; i++) {
+      int32_t gain = mergeGain(r, _rects[i]);
+      if (gain >= best) { best = gain; bi = i; }
+    }
+
+    if (bi < 0) {
+      if (_rectCount < CANVAS_MAX_RECTS) break;
+      full = true;
+      continue;
+    }
+
+    Rect &m = _rects[bi];
+    if (m.x0 < r.x0) r.x0 = m.x0;
+    if (m.y0 < r.y0) r.y0 = m.y0;
+    if (m.x1 > r.x1) r.x1 = m.x1;
+    if (m.y1 > r.y1) r.y1 = m.y1;
+
+    m = _rects[--_rectCount];
+    full = false;
+  }
+
+  _rects[_rectCount++] = r;
+}
+
+
+/***************************************************************************************
+** Function name:           touch
+** Description:             Grow the bounding box of the drawing in progress
+*************************************************************************************x*/
+void TFT_eCanvas::touch(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+  if ((w < 1) || (h < 1)) return;
+
+  if (_pending.x0 > _pending.x1) {
+    _pending.x0 = x;
+    _pending.y0 = y;
+    _pending.x1 = x + w - 1;
+    _pending.y1 = y + h - 1;
+    return;
+  }
+
+  if (x < _pending.x0) _pending.x0 = x;
+  if (y < _pending.y0) _pending.y0 = y;
+  if (x + w - 1 > _pending.x1) _pending.x1 = x + w - 1;
+  if (y + h - 1 > _pending.y1) _pending.y1 = y + h - 1;
+}
+
+
+/***************************************************************************************
+** Function name:           enter
+** Description:             Called as a drawing function starts
+*************************************************************************************x*/
+void TFT_eCanvas::enter(void)
+{
+  _depth++;
+}
+
+
+/***************************************************************************************
+** Function name:           leave
+** Description:             Called as a drawing function ends, the outermost one adds
+**                          the bounding box of all that was drawn to the list
+*************************************************************************************x*/
+void TFT_eCanvas::leave(void)
+{
+  if (--_depth) return;
+
+  if (_pending.x0 <= _pending.x1) addRect(_pending);
+
+  _pending.x0 = 1;
+  _pending.x1 = 0;
+}
+
+
+/***************************************************************************************
+** Function name:           flush
+** Description:             Send the changed areas to the TFT with the canvas at x, y
+*************************************************************************************x*/
+uint32_t TFT_eCanvas::flush(int32_t x, int32_t y)
+{
+  if (!_created || !_rectCount) return 0;
+  if ((_bpp != 8) && (_bpp != 16)) return 0;
+
+  TFT_PROFILE_CALL("flush");
+
+  uint32_t bytes = 0;
+
+  // Pixels are sent in memory order, already swapped in a 16 bit sprite
+  bool swap = _panel->getSwapBytes();
+  _panel->setSwapBytes(false);
+
+  _panel->startWrite();
+
+  for (uint8_t i = 0; i < _rectCount; i++) {
+    const Rect &r = _rects[i];
+    int32_t w = r.x1 - r.x0 + 1;
+    int32_t h = r.y1 - r.y0 + 1;
+
+    // Parts off the TFT are not sent
+    int32_t dx = x + r.x0, dy = y + r.y0;
+    int32_t sx = r.x0, sy = r.y0;
+    if (dx < 0) { w += dx; sx -= dx; dx = 0; }
+    if (dy < 0) { h += dy; sy -= dy; dy = 0; }
+    if (dx + w > _panel->width())  w = _panel->width()  - dx;
+    if (dy + h > _panel->height()) h = _panel->height() - dy;
+    if ((w < 1) || (h < 1)) continue;
+
+    _panel->setWindow(dx, dy, dx + w - 1, dy + h - 1);
+    bytes += CANVAS_WINDOW_BYTES + 2 * w * h;
+
+    if (_bpp == 16) {
+      // Full width rows are one block
+      if (w == _iwidth) _panel->pushPixels(_img + sy * _iwidth, w * h);
+      else {
+        for (int32_t row = 0; row < h; row++) {
+          _panel->pushPixels(_img + (sy + row) * _iwidth + sx, w);
+        }
+      }
+      continue;
+    }
+
+    // Expand RGB332 to RGB565 as pushImage() does, a line buffer at a time
+    uint8_t  blue[] = {0, 11, 21, 31}; // blue 2 to 5 bit colour lookup table
+    uint16_t lineBuf[64];
+
+    for (int32_t row = 0; row < h; row++) {
+      const uint8_t* src = _img8 + (sy + row) * _iwidth + sx;
+      int32_t len = w;
+
+      while (len) {
+        int32_t n = len < 64 ? len : 64;
+        uint8_t* linePtr = (uint8_t*)lineBuf;
+
+        for (int32_t j = 0; j < n; j++) {
+          uint8_t color = *src++;
+          *linePtr++ = (color & 0x1C)>>2 | (color & 0xC0)>>3 | (color & 0xE0);
+          *linePtr++ = (color & 0x1C)<<3 | blue[color & 0x03];
+        }
+
+        _panel->pushPixels(lineBuf, n);
+        len -= n;
+      }
+    }
+  }
+
+  _panel->endWrite();
+
+  _panel->setSwapBytes(swap);
+
+  _rectCount = 0;
+
+  return bytes;
+}
+
+
+/***************************************************************************************
+** Function name:           drawPixel
+** Description:             Draw a pixel and record it
+*************************************************************************************x*/
+void TFT_eCanvas::drawPixel(int32_t x, int32_t y, uint32_t color)
+{
+  enter();
+  TFT_eSprite::drawPixel(x, y, color);
+  touch(x, y, 1, 1);
+  leave();
+}
+
+
+/***************************************************************************************
+** Function name:           drawChar
+** Description:             Draw a GLCD or free font character and record its cell
+*************************************************************************************x*/
+void TFT_eCanvas::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size)
+{
+  enter();
+  TFT_eSprite::drawChar(x, y, c, color, bg, size);
+  // Free font glyphs are recorded by the pixels and rectangles they are drawn with
+  touch(x, y, 6 * size, 8 * size);
+  leave();
+}
+
+
+/***************************************************************************************
+** Function name:           drawChar
+** Description:             Draw a character in a font and record its cell
+*************************************************************************************x*/
+int16_t TFT_eCanvas::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
+{
+  enter();
+  int16_t w = TFT_eSprite::drawChar(uniCode, x, y, font);
+  // The RLE fonts write runs of pixels directly, the GLCD and free fonts are
+  // recorded by the calls they are drawn with
+  if (font > 1) touch(x, y, w, fontHeight(font));
+  leave();
+  return w;
+}
+
+int16_t TFT_eCanvas::drawChar(uint16_t uniCode, int32_t x, int32_t y)
+{
+  return drawChar(uniCode, x, y, textfont);
+}
+
+
+/***************************************************************************************
+** Function name:           drawLine
+** Description:             Draw a line and record its bounding box
+*************************************************************************************x*/
+void TFT_eCanvas::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+  enter();
+  TFT_eSprite::drawLine(x0, y0, x1, y1, color);
+  touch(x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1, abs(x1 - x0) + 1, abs(y1 - y0) + 1);
+  leave();
+}
+
+
+/***************************************************************************************
+** Function name:           drawFastVLine
+** Description:             Draw a vertical line and record it
+*************************************************************************************x*/
+void TFT_eCanvas::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
+{
+  enter();
+  TFT_eSprite::drawFastVLine(x, y, h, color);
+  touch(x, y, 1, h);
+  leave();
+}
+
+
+/***************************************************************************************
+** Function name:           drawFastHLine
+** Description:             Draw a horizontal line and record it
+*************************************************************************************x*/
+void TFT_eCanvas::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
+{
+  enter();
+  TFT_eSprite::drawFastHLine(x, y, w, color);
+  touch(x, y, w, 1);
+  leave();
+}
+
+
+/***************************************************************************************
+** Function name:           fillRect
+** Description:             Draw a filled rectangle and record it
+*************************************************************************************x*/
+void TFT_eCanvas::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+  enter();
+  TFT_eSprite::fillRect(x, y, w, h, color);
+  touch(x, y, w, h);
+  leave();
+}
+
+
+/***************************************************************************************
+** Function name:           fillSprite
+** Description:             Fill the canvas and record all of it
+*************************************************************************************x*/
+void TFT_eCanvas::fillSprite(uint32_t color)
+{
+  enter();
+  TFT_eSprite::fillSprite(color);
+  touch(0, 0, _iwidth, _iheight);
+  leave();
+}
@@ -0,0 +1,89 @@
+/***************************************************************************************
+// The following class is a Sprite the size of the screen (or part of it) that keeps a
+// list of the rectangles drawn over since it was last flushed. flush() then sends only
+// those to the TFT, in one transaction, instead of the whole Sprite.
+//
+// Graphics drawn through the virtual functions (pixels, lines, rectangles, characters
+// and so anything built on them, e.g. drawString() and fillScreen()) are recorded,
+// whether the canvas is used directly or through a TFT_eSPI reference. Anything else,
+// e.g. pushImage() or scroll(), must be marked with damage().
+//
+// A rectangle is merged with another when sending the pixels of their bounding box
+// costs no more bus bytes than sending both and addressing a second window. The cost
+// of a window is 11 bytes (CASET, PASET and RAMWR) unless set otherwise.
+//
+// 8 bit (RGB332) and 16 bit colour depths can be flushed, 8 bits is the default. A
+// 320 x 240 canvas takes 76.8 kbytes at 8 bits, black, white and the primaries
+// survive the conversion unchanged.
+***************************************************************************************/
+
+// Rectangles kept, when full a new one is merged with the cheapest to join
+#ifndef CANVAS_MAX_RECTS
+  #define CANVAS_MAX_RECTS 16
+#endif
+
+class TFT_eCanvas : public TFT_eSprite {
+
+ public:
+
+  TFT_eCanvas(TFT_eSPI *tft);
+
+           // Create the canvas, it starts out damaged all over so the first flush
+           // sends all of it
+  void*    createSprite(int16_t width, int16_t height);
+
+           // Bus bytes a window change is worth when merging rectangles
+  void     setWindowCost(uint16_t bytes);
+
+           // Mark an area as changed, for graphics not drawn through the functions below
+  void     damage(int32_t x, int32_t y, int32_t w, int32_t h);
+           // Forget the changes, the TFT already shows the canvas
+  void     clearDamage(void);
+
+           // Number of rectangles waiting to be sent and the pixels in them
+  uint8_t  damagedRects(void);
+  uint32_t damagedPixels(void);
+
+           // Send the changed areas to the TFT with the canvas at x, y, returns the
+           // bytes sent including the window commands
+  uint32_t flush(int32_t x = 0, int32_t y = 0);
+
+           // Sprite graphics functions that also record the area drawn
+  void     drawPixel(int32_t x, int32_t y, uint32_t color),
+           drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size),
+           drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color),
+           drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color),
+           drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color),
+           fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color),
+           fillSprite(uint32_t color);
+
+  int16_t  drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font),
+           drawChar(uint16_t uniCode, int32_t x, int32_t y);
+
+ private:
+
+  struct Rect {
+    int32_t x0, y0, x1, y1; // Inclusive corners
+  };
+
+           // Grow the bounding box of the outermost call being drawn
+  void     touch(int32_t x, int32_t y, int32_t w, int32_t h);
+           // Called as a drawing function starts and ends, the outermost one adds its
+           // bounding box to the list
+  void     enter(void);
+  void     leave(void);
+
+           // Add a clipped rectangle to the list, merging where it saves bus bytes
+  void     addRect(Rect r);
+           // Bytes saved (if positive) by sending the bounding box of a and b instead
+  int32_t  mergeGain(const Rect &a, const Rect &b);
+
+  TFT_eSPI *_panel;
+
+  Rect     _rects[CANVAS_MAX_RECTS];
+  uint8_t  _rectCount;
+  uint16_t _windowCost;
+
+  uint8_t  _depth;   // Drawing functions in progress
+  Rect     _pending; // Bounding box of what they drew, empty if x0 > x1
+};
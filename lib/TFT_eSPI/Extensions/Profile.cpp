@@ -0,0 +1,145 @@
+ // This is part of the TFT_eSPI class and is associated with the bus profiler
+
+#if defined (ESP32) || defined (ESP8266)
+  #define PROFILE_CYCLES() ESP.getCycleCount()
+#elif defined (__x86_64__) || defined (__i386__)
+  #include <x86intrin.h>
+  #define PROFILE_CYCLES() (uint32_t)__rdtsc()
+#else
+  #include <chrono>
+  #define PROFILE_CYCLES() (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>( \
+                           std::chrono::steady_clock::now().time_since_epoch()).count()
+#endif
+
+// Rows of the table, calls past the last one are charged to it
+#define PROFILE_SLOTS 48
+
+// Bus traffic so far, counted by the TFT_PROFILE_ macros
+uint32_t tft_profile_bytes    = 0;
+uint32_t tft_profile_commands = 0;
+uint32_t tft_profile_windows  = 0;
+
+struct ProfileRow {
+  const char *name;
+  uint32_t calls;
+  uint64_t bytes, commands, windows, cycles;
+};
+
+static ProfileRow profileRows[PROFILE_SLOTS];
+static uint8_t    profileUsed   = 0;
+static uint8_t    profileDepth  = 0; // Profiled calls in progress
+static uint32_t   profileFrames = 0;
+
+/***************************************************************************************
+** Function name:           profileSlot
+** Description:             Find or add the table row for a call
+***************************************************************************************/
+uint8_t TFT_eSPI::profileSlot(const char *name)
+{
+  for (uint8_t i = 0; i < profileUsed; i++) {
+    if (!strcmp(profileRows[i].name, name)) return i;
+  }
+
+  if (profileUsed == PROFILE_SLOTS) return PROFILE_SLOTS - 1;
+
+  profileRows[profileUsed].name = name;
+  return profileUsed++;
+}
+
+/***************************************************************************************
+** Function name:           ProfileScope
+** Description:             Note the counts as the outermost profiled call starts
+***************************************************************************************/
+TFT_eSPI::ProfileScope::ProfileScope(uint8_t slot)
+{
+  _slot = slot;
+  if (profileDepth++) return;
+
+  _bytes    = tft_profile_bytes;
+  _commands = tft_profile_commands;
+  _windows  = tft_profile_windows;
+  _cycles   = PROFILE_CYCLES();
+}
+
+/***************************************************************************************
+** Function name:           ~ProfileScope
+** Description:             Charge the outermost profiled call for what it has done
+***************************************************************************************/
+TFT_eSPI::ProfileScope::~ProfileScope()
+{
+  if (--profileDepth) return;
+
+  // Differences of the 32 bit counters are right across a wrap
+  ProfileRow &row = profileRows[_slot];
+  row.cycles   += (uint32_t)(PROFILE_CYCLES() - _cycles);
+  row.bytes    += tft_profile_bytes    - _bytes;
+  row.commands += tft_profile_commands - _commands;
+  row.windows  += tft_profile_windows  - _windows;
+  row.calls++;
+}
+
+/***************************************************************************************
+** Function name:           resetProfile
+** Description:             Clear the table
+***************************************************************************************/
+void TFT_eSPI::resetProfile(void)
+{
+  for (uint8_t i = 0; i < profileUsed; i++) {
+    const char *name = profileRows[i].name;
+    profileRows[i] = ProfileRow();
+    profileRows[i].name = name;
+  }
+  profileFrames = 0;
+}
+
+/***************************************************************************************
+** Function name:           profileFrame
+** Description:             Count a frame drawn
+***************************************************************************************/
+void TFT_eSPI::profileFrame(void)
+{
+  profileFrames++;
+}
+
+/***************************************************************************************
+** Function name:           printProfile
+** Description:             Print the table, most bytes (i.e. bus time) first
+***************************************************************************************/
+void TFT_eSPI::printProfile(Print &out)
+{
+  uint8_t order[PROFILE_SLOTS];
+  uint8_t n = 0;
+
+  // Insertion sort, there are only a few dozen rows
+  for (uint8_t i = 0; i < profileUsed; i++) {
+    if (!profileRows[i].calls) continue;
+    uint8_t j = n++;
+    while (j && profileRows[order[j - 1]].bytes < profileRows[i].bytes) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+
+  uint64_t bytes = 0;
+  for (uint8_t i = 0; i < n; i++) bytes += profileRows[order[i]].bytes;
+
+  out.printf("%-18s %8s %10s %8s %8s %9s %5s %10s\n", "call", "calls", "bytes", "commands",
+             "windows", "bus ms", "%", "kcycles");
+
+  for (uint8_t i = 0; i < n; i++) {
+    const ProfileRow &row = profileRows[order[i]];
+    // At SPI_FREQUENCY, as if every byte went out back to back
+    double busMs = row.bytes * 8000.0 / SPI_FREQUENCY;
+    out.printf("%-18s %8lu %10llu %8llu %8llu %9.1f %5.1f %10llu\n", row.name,
+               (unsigned long)row.calls, (unsigned long long)row.bytes,
+               (unsigned long long)row.commands, (unsigned long long)row.windows, busMs,
+               bytes ? 100.0 * row.bytes / bytes : 0.0, (unsigned long long)(row.cycles / 1000));
+  }
+
+  if (profileFrames) {
+    out.printf("%lu frames, %llu bytes and %.1f bus ms per frame\n", (unsigned long)profileFrames,
+               (unsigned long long)(bytes / profileFrames),
+               bytes * 8000.0 / SPI_FREQUENCY / profileFrames);
+  }
+}
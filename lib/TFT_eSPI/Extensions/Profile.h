@@ -0,0 +1,33 @@
+ // This is part of the TFT_eSPI class and is associated with the bus profiler,
+ // loaded if TFT_PROFILE is defined. Without it the TFT_PROFILE_ macros are empty.
+ //
+ // Each public drawing call made by the sketch is charged the bus bytes, commands
+ // and window changes it caused and the processor cycles it took, including those
+ // of the calls it made itself: fillScreen() is charged for its fillRect(), a
+ // drawString() for its drawChar()s. Cycles are the ESP32/ESP8266 cycle counter,
+ // the TSC on an x86 host or nanoseconds elsewhere. Bytes are counted by the ESP32
+ // SPI and HostSim back ends only. Calls on a sprite count under the same names;
+ // drawing in its RAM moves no bus bytes, pushSprite() is charged the transfer.
+
+ public:
+           // Print a table of the calls profiled so far, costliest bus time first
+  void     printProfile(Print &out);
+           // Clear the table
+  void     resetProfile(void);
+           // Count a frame drawn, so the table also shows the cost per frame
+  void     profileFrame(void);
+
+           // Charges the call it is constructed in, unless a profiled call made it
+  class ProfileScope {
+   public:
+    ProfileScope(uint8_t slot);
+    ~ProfileScope();
+
+   private:
+    uint8_t  _slot;
+    uint32_t _bytes, _commands, _windows;
+    uint32_t _cycles;
+  };
+
+           // Table row for the call, added on its first use
+  static uint8_t profileSlot(const char *name);
@@ -380,6 +380,7 @@ int16_t TFT_eSprite::getPivotY(void)
 #define FP_SCALE 10
 bool TFT_eSprite::pushRotated(int16_t angle, int32_t transp)
 {
+  TFT_PROFILE_CALL("pushRotated");
   if ( !_created || _bpp == 4) return false;
 
   // Bounding box parameters
@@ -448,6 +449,7 @@ bool TFT_eSprite::pushRotated(int16_t angle, int32_t transp)
 *************************************************************************************x*/
 bool TFT_eSprite::pushRotated(TFT_eSprite *spr, int16_t angle, int32_t transp)
 {
+  TFT_PROFILE_CALL("pushRotated");
   if ( !_created  || _bpp == 4) return false;       // Check this Sprite is created
   if ( !spr->_created  || spr->_bpp == 4) return false;  // Ckeck destination Sprite is created
 
@@ -632,6 +634,7 @@ void TFT_eSprite::getRotatedBounds(int16_t angle, int16_t w, int16_t h, int16_t
 *************************************************************************************x*/
 void TFT_eSprite::pushSprite(int32_t x, int32_t y)
 {
+  TFT_PROFILE_CALL("pushSprite");
   if (!_created) return;
 
   if (_bpp == 16)
@@ -659,6 +662,7 @@ void TFT_eSprite::pushSprite(int32_t x, int32_t y)
 *************************************************************************************x*/
 void TFT_eSprite::pushSprite(int32_t x, int32_t y, uint16_t transp)
 {
+  TFT_PROFILE_CALL("pushSprite");
   if (!_created) return;
 
   if (_bpp == 16)
@@ -741,6 +745,7 @@ uint16_t TFT_eSprite::readPixelValue(int32_t x, int32_t y)
 *************************************************************************************x*/
 uint16_t TFT_eSprite::readPixel(int32_t x, int32_t y)
 {
+  TFT_PROFILE_CALL("readPixel");
   if ((x < 0) || (x >= _iwidth) || (y < 0) || (y >= _iheight) || !_created) return 0xFFFF;
 
   if (_bpp == 16)
@@ -803,6 +808,7 @@ uint16_t TFT_eSprite::readPixel(int32_t x, int32_t y)
 *************************************************************************************x*/
 void  TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
 {
+  TFT_PROFILE_CALL("pushImage");
   if ((x >= _iwidth) || (y >= _iheight) || (w == 0) || (h == 0) || !_created) return;
   if ((x + w < 0) || (y + h < 0)) return;
 
@@ -904,6 +910,7 @@ void  TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_
 *************************************************************************************x*/
 void  TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
 {
+  TFT_PROFILE_CALL("pushImage");
 #ifdef ESP32
   pushImage(x, y, w, h, (uint16_t*) data);
 #else
@@ -1065,6 +1072,7 @@ void TFT_eSprite::setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
 *************************************************************************************x*/
 void TFT_eSprite::pushColor(uint32_t color)
 {
+  TFT_PROFILE_CALL("pushColor");
   if (!_created ) return;
 
   // Write the colour to RAM in set window
@@ -1107,6 +1115,7 @@ void TFT_eSprite::pushColor(uint32_t color)
 *************************************************************************************x*/
 void TFT_eSprite::pushColor(uint32_t color, uint16_t len)
 {
+  TFT_PROFILE_CALL("pushColor");
   if (!_created ) return;
 
   uint16_t pixelColor;
@@ -1192,6 +1201,7 @@ void TFT_eSprite::setScrollRect(int32_t x, int32_t y, int32_t w, int32_t h, uint
 *************************************************************************************x*/
 void TFT_eSprite::scroll(int16_t dx, int16_t dy)
 {
+  TFT_PROFILE_CALL("scroll");
   if (abs(dx) >= _sw || abs(dy) >= _sh)
   {
     fillRect (_sx, _sy, _sw, _sh, _scolor);
@@ -1290,6 +1300,7 @@ void TFT_eSprite::scroll(int16_t dx, int16_t dy)
 *************************************************************************************x*/
 void TFT_eSprite::fillSprite(uint32_t color)
 {
+  TFT_PROFILE_CALL("fillSprite");
   if (!_created ) return;
 
   // Use memset if possible as it is super fast
@@ -1394,6 +1405,7 @@ uint8_t TFT_eSprite::getRotation(void)
 *************************************************************************************x*/
 void TFT_eSprite::drawPixel(int32_t x, int32_t y, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawPixel");
   // Range checking
   if ((x < 0) || (y < 0) || !_created) return;
   if ((x >= _iwidth) || (y >= _iheight)) return;
@@ -1450,6 +1462,7 @@ void TFT_eSprite::drawPixel(int32_t x, int32_t y, uint32_t color)
 *************************************************************************************x*/
 void TFT_eSprite::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawLine");
   if (!_created ) return;
 
   bool steep = abs(y1 - y0) > abs(x1 - x0);
@@ -1506,6 +1519,7 @@ void TFT_eSprite::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint3
 *************************************************************************************x*/
 void TFT_eSprite::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawFastVLine");
 
   if ((x < 0) || (x >= _iwidth) || (y >= _iheight) || !_created) return;
 
@@ -1561,6 +1575,7 @@ void TFT_eSprite::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
 *************************************************************************************x*/
 void TFT_eSprite::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawFastHLine");
 
   if ((y < 0) || (x >= _iwidth) || (y >= _iheight) || !_created) return;
 
@@ -1617,6 +1632,7 @@ void TFT_eSprite::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
 *************************************************************************************x*/
 void TFT_eSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
 {
+  TFT_PROFILE_CALL("fillRect");
   if (!_created ) return;
 
   if ((x >= _iwidth) || (y >= _iheight)) return;
@@ -1722,6 +1738,7 @@ void TFT_eSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t
 *************************************************************************************x*/
 size_t TFT_eSprite::write(uint8_t utf8)
 {
+  TFT_PROFILE_CALL("write");
   uint16_t uniCode = decodeUTF8(utf8);
 
   if (!uniCode) return 1;
@@ -1783,7 +1800,7 @@ size_t TFT_eSprite::write(uint8_t utf8)
     {
       if (utf8 > 127) return 1;
       // Uses the fontinfo struct array to avoid lots of 'if' or 'switch' statements
-      width = pgm_read_byte( (uint8_t *)pgm_read_dword( &(fontdata[textfont].widthtbl ) ) + uniCode-32 );
+      width = pgm_read_byte( (uint8_t *)pgm_read_addr( &(fontdata[textfont].widthtbl ) ) + uniCode-32 );
       height= pgm_read_byte( &fontdata[textfont].height );
     }
   }
@@ -1830,7 +1847,7 @@ size_t TFT_eSprite::write(uint8_t utf8)
       if (uniCode < pgm_read_word(&gfxFont->first)) return 1;
 
       uint8_t   c2    = uniCode - pgm_read_word(&gfxFont->first);
-      GFXglyph *glyph = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c2]);
+      GFXglyph *glyph = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[c2]);
       uint8_t   w     = pgm_read_byte(&glyph->width),
                 h     = pgm_read_byte(&glyph->height);
       if((w > 0) && (h > 0)) { // Is there an associated bitmap?
@@ -1859,6 +1876,7 @@ size_t TFT_eSprite::write(uint8_t utf8)
 *************************************************************************************x*/
 void TFT_eSprite::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size)
 {
+  TFT_PROFILE_CALL("drawChar");
   if (!_created ) return;
 
   if ((x >= _iwidth)            || // Clip right
@@ -1941,8 +1959,8 @@ void TFT_eSprite::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uin
 //>>>>>>>>>>>>>>>>>>>>>>>>>>>
 
       c -= pgm_read_word(&gfxFont->first);
-      GFXglyph *glyph  = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c]);
-      uint8_t  *bitmap = (uint8_t *)pgm_read_dword(&gfxFont->bitmap);
+      GFXglyph *glyph  = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[c]);
+      uint8_t  *bitmap = (uint8_t *)pgm_read_addr(&gfxFont->bitmap);
 
       uint32_t bo = pgm_read_word(&glyph->bitmapOffset);
       uint8_t  w  = pgm_read_byte(&glyph->width),
@@ -2008,6 +2026,7 @@ int16_t TFT_eSprite::drawChar(uint16_t uniCode, int32_t x, int32_t y)
   // Any UTF-8 decoding must be done before calling drawChar()
 int16_t TFT_eSprite::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawChar");
   if (!_created ) return 0;
 
   if (!uniCode) return 0;
@@ -2039,7 +2058,7 @@ int16_t TFT_eSprite::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t fo
       if((uniCode >= pgm_read_word(&gfxFont->first)) && (uniCode <= pgm_read_word(&gfxFont->last) ))
       {
         uint16_t   c2    = uniCode - pgm_read_word(&gfxFont->first);
-        GFXglyph *glyph = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c2]);
+        GFXglyph *glyph = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[c2]);
         return pgm_read_byte(&glyph->xAdvance) * textsize;
       }
       else
@@ -2054,14 +2073,14 @@ int16_t TFT_eSprite::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t fo
 
   int32_t width  = 0;
   int32_t height = 0;
-  uint32_t flash_address = 0;
+  uintptr_t flash_address = 0;
   uniCode -= 32;
 
 #ifdef LOAD_FONT2
   if (font == 2)
   {
     // This is faster than using the fontdata structure
-    flash_address = pgm_read_dword(&chrtbl_f16[uniCode]);
+    flash_address = pgm_read_addr(&chrtbl_f16[uniCode]);
     width = pgm_read_byte(widtbl_f16 + uniCode);
     height = chr_hgt_f16;
   }
@@ -2075,8 +2094,8 @@ int16_t TFT_eSprite::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t fo
     if ((font>2) && (font<9))
     {
       // This is slower than above but is more convenient for the RLE fonts
-      flash_address = pgm_read_dword( (const void*) (pgm_read_dword( &(fontdata[font].chartbl ) ) + uniCode*sizeof(void *)) );
-      width = pgm_read_byte( (uint8_t *)pgm_read_dword( &(fontdata[font].widthtbl ) ) + uniCode );
+      flash_address = pgm_read_addr( (const void*) (pgm_read_addr( &(fontdata[font].chartbl ) ) + uniCode*sizeof(void *)) );
+      width = pgm_read_byte( (uint8_t *)pgm_read_addr( &(fontdata[font].widthtbl ) ) + uniCode );
       height= pgm_read_byte( &fontdata[font].height );
     }
   }
@@ -171,6 +171,7 @@ void TFT_eSPI::pushPixels(const void* data_in, uint32_t len)
 ***************************************************************************************/
 void TFT_eSPI::pushBlock(uint16_t color, uint32_t len){
   
+  TFT_PROFILE_BYTES(len << 1);
   uint32_t color32 = (color<<8 | color >>8)<<16 | (color<<8 | color >>8);
 
   if (len > 31)
@@ -293,6 +294,7 @@ void TFT_eSPI::pushSwapBytePixels(const void* data_in, uint32_t len){
 ***************************************************************************************/
 void TFT_eSPI::pushPixels(const void* data_in, uint32_t len){
 
+  TFT_PROFILE_BYTES(len << 1);
   if(_swapBytes) {
     pushSwapBytePixels(data_in, len);
     return;
@@ -275,6 +275,7 @@
   // ESP32 low level SPI writes for 8, 16 and 32 bit values
   // to avoid the function call overhead
   #define TFT_WRITE_BITS(D, B) \
+  TFT_PROFILE_BYTES((B) / 8); \
   WRITE_PERI_REG(SPI_MOSI_DLEN_REG(SPI_PORT), B-1); \
   WRITE_PERI_REG(SPI_W0_REG(SPI_PORT), D); \
   SET_PERI_REG_MASK(SPI_CMD_REG(SPI_PORT), SPI_USR); \
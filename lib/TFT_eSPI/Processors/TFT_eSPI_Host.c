@@ -0,0 +1,194 @@
+        ////////////////////////////////////////////////////
+        //         TFT_eSPI HostSim driver functions      //
+        ////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Global variables
+////////////////////////////////////////////////////////////////////////////////////////
+
+// Select the SPI port to use, only transactions go through it
+SPIClass& spi = SPI;
+
+#ifdef HOST_DMA
+  // Transfer in progress, bytes in memory order as a DMA engine sends them
+  static const uint8_t* dmaData = nullptr;
+  static uint32_t dmaBytes = 0;
+  static uint64_t dmaEnd = 0; // Simulated time the last byte leaves the bus
+#endif
+
+/***************************************************************************************
+** Function name:           pushBlock - for HostSim
+** Description:             Write a block of pixels of the same colour
+***************************************************************************************/
+void TFT_eSPI::pushBlock(uint16_t color, uint32_t len){
+
+  TFT_PROFILE_BYTES(len << 1);
+  HostSim.busWrite(2ULL * len);
+  HostSim.panel.fill(color, len);
+}
+
+/***************************************************************************************
+** Function name:           pushPixels - for HostSim
+** Description:             Write a sequence of pixels
+***************************************************************************************/
+void TFT_eSPI::pushPixels(const void* data_in, uint32_t len){
+
+  const uint16_t *data = (const uint16_t*)data_in;
+  TFT_PROFILE_BYTES(len << 1);
+  HostSim.busWrite(2ULL * len);
+
+  // Without swapping the bytes go out in little-endian memory order
+  if (!_swapBytes) {
+    HostSim.panel.write((const uint8_t*)data, 2 * len);
+    return;
+  }
+
+  uint8_t buf[256];
+  while (len) {
+    uint32_t n = len < sizeof(buf) / 2 ? len : sizeof(buf) / 2;
+    for (uint32_t i = 0; i < n; i++) {
+      buf[2 * i]     = data[i] >> 8;
+      buf[2 * i + 1] = data[i];
+    }
+    HostSim.panel.write(buf, 2 * n);
+    data += n;
+    len -= n;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////
+#if defined HOST_DMA //                                           DMA FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////////////
+
+/***************************************************************************************
+** Function name:           dmaBusy
+** Description:             Check if DMA is busy (usefully non-blocking!)
+***************************************************************************************/
+// Use "while(tft.dmaBusy());" in sketch for a blocking wait for DMA to complete
+// or  "while( tft.dmaBusy() ) {Do-something-useful;}"
+// Each call takes a tick of the simulated clock, like polling millis(), and the
+// panel receives the pixels when the transfer ends. A sketch that changes the
+// buffer or sends commands before that draws the wrong pixels, as it would on
+// a processor with DMA.
+bool TFT_eSPI::dmaBusy(void)
+{
+  if (!dmaData) return false;
+
+  if (HostSim.tick() < dmaEnd) return true;
+
+  HostSim.panel.write(dmaData, dmaBytes);
+  dmaData = nullptr;
+  return false;
+}
+
+
+/***************************************************************************************
+** Function name:           pushPixelsDMA
+** Description:             Push pixels to TFT
+***************************************************************************************/
+// This will byte swap the original image if setSwapBytes(true) was called by sketch.
+void TFT_eSPI::pushPixelsDMA(uint16_t* image, uint32_t len)
+{
+  if (len == 0) return;
+
+  // Wait for any current DMA transaction to end
+  while (dmaBusy());
+
+  if(_swapBytes) {
+    for (uint32_t i = 0; i < len; i++) (image[i] = image[i] << 8 | image[i] >> 8);
+  }
+
+  TFT_PROFILE_BYTES(len << 1);
+  dmaData = (const uint8_t*)image;
+  dmaBytes = len << 1;
+  dmaEnd = HostSim.now() + HostSim.busMicros(dmaBytes);
+}
+
+
+/***************************************************************************************
+** Function name:           pushImageDMA
+** Description:             Push image to a window
+***************************************************************************************/
+// This will clip and also swap bytes if setSwapBytes(true) was called by sketch
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* image, uint16_t* buffer)
+{
+  if ((x >= _width) || (y >= _height)) return;
+
+  int32_t dx = 0;
+  int32_t dy = 0;
+  int32_t dw = w;
+  int32_t dh = h;
+
+  if (x < 0) { dw += x; dx = -x; x = 0; }
+  if (y < 0) { dh += y; dy = -y; y = 0; }
+
+  if ((x + dw) > _width ) dw = _width  - x;
+  if ((y + dh) > _height) dh = _height - y;
+
+  if (dw < 1 || dh < 1) return;
+
+  if (buffer == nullptr) buffer = image;
+
+  uint32_t len = dw*dh;
+
+  while (dmaBusy());
+
+  // If image is clipped, copy pixels into a contiguous block
+  if ( (dw != w) || (dh != h) ) {
+    if(_swapBytes) {
+      for (int32_t yb = 0; yb < dh; yb++) {
+        for (int32_t xb = 0; xb < dw; xb++) {
+          uint32_t src = xb + dx + w * (yb + dy);
+          (buffer[xb + yb * dw] = image[src] << 8 | image[src] >> 8);
+        }
+      }
+    }
+    else {
+      for (int32_t yb = 0; yb < dh; yb++) {
+        memmove((uint8_t*) (buffer + yb * dw), (uint8_t*) (image + dx + w * (yb + dy)), dw << 1);
+      }
+    }
+  }
+  // else, if a buffer pointer has been provided copy whole image to the buffer
+  else if (buffer != image || _swapBytes) {
+    if(_swapBytes) {
+      for (uint32_t i = 0; i < len; i++) (buffer[i] = image[i] << 8 | image[i] >> 8);
+    }
+    else {
+      memcpy(buffer, image, len*2);
+    }
+  }
+
+  setWindow(x, y, x + dw - 1, y + dh - 1);
+
+  TFT_PROFILE_BYTES(len << 1);
+  dmaData = (const uint8_t*)buffer;
+  dmaBytes = len << 1;
+  dmaEnd = HostSim.now() + HostSim.busMicros(dmaBytes);
+}
+
+
+/***************************************************************************************
+** Function name:           initDMA
+** Description:             Initialise the DMA engine - returns true if init OK
+***************************************************************************************/
+bool TFT_eSPI::initDMA(void)
+{
+  return DMA_Enabled = true;
+}
+
+
+/***************************************************************************************
+** Function name:           deInitDMA
+** Description:             Disconnect the DMA engine from SPI
+***************************************************************************************/
+void TFT_eSPI::deInitDMA(void)
+{
+  while (dmaBusy());
+  DMA_Enabled = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+#endif // End of DMA FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,127 @@
+        ////////////////////////////////////////////////////
+        //         TFT_eSPI HostSim driver functions      //
+        ////////////////////////////////////////////////////
+
+// This is a driver for host builds with lib/HostSim, it drives the RGB565
+// frame buffer of HostSim's virtual ILI9341/ST7789 panel. Commands go
+// through the panel's decoder a byte at a time, pixels in blocks, and the
+// bus time is charged to the simulated clock as on an SPI display.
+// 8 bit parallel, ILI9488 and RPi displays are not supported
+
+#ifndef _TFT_eSPI_HOSTH_
+#define _TFT_eSPI_HOSTH_
+
+// Processor ID reported by getSetup()
+#define PROCESSOR_ID 0x4853 // "HS"
+
+// Include processor specific header
+#include <HostSim.h>
+
+#if defined (TFT_PARALLEL_8_BIT) || defined (ILI9488_DRIVER) || defined (RPI_DISPLAY_TYPE)
+  #error "HostSim panel only decodes 16 bit colour on SPI"
+#endif
+
+// Processor specific code used by SPI bus transaction startWrite and endWrite functions
+#define SET_BUS_WRITE_MODE // Not used
+#define SET_BUS_READ_MODE  // Not used
+
+// Font tables hold pointers, which are 64 bits on the host
+#define pgm_read_addr(addr) ((uintptr_t)pgm_read_ptr(addr))
+
+// DMA is emulated: a transfer ends once its bytes would have left the bus
+#define HOST_DMA
+
+// Code to check if DMA is busy, used by SPI DMA + transaction + endWrite functions
+#define DMA_BUSY_CHECK { if (DMA_Enabled) while(dmaBusy()); }
+
+// To be safe, SUPPORT_TRANSACTIONS is assumed mandatory
+#if !defined (SUPPORT_TRANSACTIONS)
+  #define SUPPORT_TRANSACTIONS
+#endif
+
+// Initialise processor specific SPI functions, used by init()
+#define INIT_TFT_DATA_BUS
+
+// If smooth fonts are enabled the filing system may need to be loaded
+#ifdef SMOOTH_FONT
+  // Call up the filing system for the anti-aliased fonts
+  //#define FS_NO_GLOBALS
+  //#include <FS.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Define the DC (TFT Data/Command or Register Select (RS))pin drive code
+////////////////////////////////////////////////////////////////////////////////////////
+// The panel follows the pins given to it as HOSTSIM_TFT_DC and HOSTSIM_TFT_CS
+#ifndef TFT_DC
+  #define DC_C // No macro allocated so it generates no code
+  #define DC_D // No macro allocated so it generates no code
+#else
+  #define DC_C digitalWrite(TFT_DC, LOW)
+  #define DC_D digitalWrite(TFT_DC, HIGH)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Define the CS (TFT chip select) pin drive code
+////////////////////////////////////////////////////////////////////////////////////////
+#ifndef TFT_CS
+  #define CS_L // No macro allocated so it generates no code
+  #define CS_H // No macro allocated so it generates no code
+#else
+  #define CS_L digitalWrite(TFT_CS, LOW)
+  #define CS_H digitalWrite(TFT_CS, HIGH)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Define the touch screen chip select pin drive code
+////////////////////////////////////////////////////////////////////////////////////////
+#if !defined TOUCH_CS || (TOUCH_CS < 0)
+  #define T_CS_L // No macro allocated so it generates no code
+  #define T_CS_H // No macro allocated so it generates no code
+#else
+  #define T_CS_L digitalWrite(TOUCH_CS, LOW)
+  #define T_CS_H digitalWrite(TOUCH_CS, HIGH)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Make sure TFT_MISO is defined if not used to avoid an error message
+////////////////////////////////////////////////////////////////////////////////////////
+#ifndef TFT_MISO
+  #define TFT_MISO -1
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Macros to write commands/pixel colour data to the panel
+////////////////////////////////////////////////////////////////////////////////////////
+// Write 8 bits to TFT
+#define tft_Write_8(C)   do { TFT_PROFILE_BYTES(1); HostSim.busTransfer(C); } while (0)
+
+// Write 16 bits, most significant byte first as on the SPI bus
+#define tft_Write_16(C)  do { TFT_PROFILE_BYTES(2); HostSim.busTransfer((uint8_t)((C) >> 8)); \
+                           HostSim.busTransfer((uint8_t)(C)); } while (0)
+
+// Write 16 bits with the bytes swapped
+#define tft_Write_16S(C) do { TFT_PROFILE_BYTES(2); HostSim.busTransfer((uint8_t)(C)); \
+                           HostSim.busTransfer((uint8_t)((C) >> 8)); } while (0)
+
+// Write 32 bits to TFT
+#define tft_Write_32(C) do { \
+  tft_Write_16((uint16_t) ((C)>>16)); \
+  tft_Write_16((uint16_t) ((C)>>0)); } while (0)
+
+// Write two address coordinates
+#define tft_Write_32C(C,D) do { \
+  tft_Write_16((uint16_t) (C)); \
+  tft_Write_16((uint16_t) (D)); } while (0)
+
+// Write same value twice
+#define tft_Write_32D(C) do { \
+  tft_Write_16((uint16_t) (C)); \
+  tft_Write_16((uint16_t) (C)); } while (0)
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Macros to read from display using SPI
+////////////////////////////////////////////////////////////////////////////////////////
+#define tft_Read_8() HostSim.busTransfer(0)
+
+#endif // Header end
@@ -22,6 +22,8 @@
   #include "Processors/TFT_eSPI_ESP8266.c"
 #elif defined (STM32) // (_VARIANT_ARDUINO_STM32_) stm32_def.h
   #include "Processors/TFT_eSPI_STM32.c"
+#elif defined (HOSTSIM)
+  #include "Processors/TFT_eSPI_Host.c"
 #else
   #include "Processors/TFT_eSPI_Generic.c"
 #endif
@@ -183,6 +185,7 @@ TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
   textcolor   = bitmap_fg = 0xFFFF; // White
   textbgcolor = bitmap_bg = 0x0000; // Black
   padX = 0;             // No padding
+  _textBackdrop = GLYPH_BACKDROP_NONE; // Transparent GLCD text only draws lit pixels
   isDigits   = false;   // No bounding box adjustment
   textwrapX  = true;    // Wrap text at end of line when using print stream
   textwrapY  = false;   // Wrap text at bottom of screen when using print stream
@@ -540,6 +543,7 @@ void TFT_eSPI::writecommand(uint8_t c)
 {
   begin_tft_write();
 
+  TFT_PROFILE_COMMAND;
   DC_C;
 
   tft_Write_8(c);
@@ -596,12 +600,14 @@ uint8_t TFT_eSPI::readcommand8(uint8_t cmd_function, uint8_t index)
   begin_tft_read();
   index = 0x10 + (index & 0x0F);
 
+  TFT_PROFILE_COMMAND;
   DC_C; tft_Write_8(0xD9);
   DC_D; tft_Write_8(index);
 
   CS_H; // Some displays seem to need CS to be pulsed here, or is just a delay needed?
   CS_L;
 
+  TFT_PROFILE_COMMAND;
   DC_C; tft_Write_8(cmd_function);
   DC_D;
   reg = tft_Read_8();
@@ -650,6 +656,7 @@ uint32_t TFT_eSPI::readcommand32(uint8_t cmd_function, uint8_t index)
 ***************************************************************************************/
 uint16_t TFT_eSPI::readPixel(int32_t x0, int32_t y0)
 {
+  TFT_PROFILE_CALL("readPixel");
 #if defined(TFT_PARALLEL_8_BIT)
 
   CS_L;
@@ -760,6 +767,7 @@ void TFT_eSPI::setCallback(getColorCallback getCol)
 ***************************************************************************************/
 void TFT_eSPI::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
 {
+  TFT_PROFILE_CALL("readRect");
   if ((x > _width) || (y > _height) || (w == 0) || (h == 0)) return;
 
 #if defined(TFT_PARALLEL_8_BIT)
@@ -865,6 +873,7 @@ void TFT_eSPI::readRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *da
 ***************************************************************************************/
 void TFT_eSPI::pushRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
 {
+  TFT_PROFILE_CALL("pushRect");
   // Function deprecated, remains for backwards compatibility
   // New pushImage() is better as it will crop partly off-screen image blocks
   pushImage(x, y, w, h, data);
@@ -877,6 +886,7 @@ void TFT_eSPI::pushRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *da
 ***************************************************************************************/
 void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data)
 {
+  TFT_PROFILE_CALL("pushImage");
 
   if ((x >= _width) || (y >= _height)) return;
 
@@ -921,6 +931,7 @@ void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *d
 ***************************************************************************************/
 void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *data, uint16_t transp)
 {
+  TFT_PROFILE_CALL("pushImage");
 
   if ((x >= _width) || (y >= _height)) return;
 
@@ -993,6 +1004,7 @@ void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t *d
 ***************************************************************************************/
 void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data)
 {
+  TFT_PROFILE_CALL("pushImage");
   // Requires 32 bit aligned access, so use PROGMEM 16 bit word functions
   if ((x >= _width) || (y >= _height)) return;
 
@@ -1037,6 +1049,7 @@ void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint1
 ***************************************************************************************/
 void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data, uint16_t transp)
 {
+  TFT_PROFILE_CALL("pushImage");
   // Requires 32 bit aligned access, so use PROGMEM 16 bit word functions
   if ((x >= _width) || (y >= (int32_t)_height)) return;
 
@@ -1106,6 +1119,7 @@ void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint1
 ***************************************************************************************/
 void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t *data, bool bpp8,  uint16_t *cmap)
 {
+  TFT_PROFILE_CALL("pushImage");
 
   if ((x >= _width) || (y >= (int32_t)_height)) return;
 
@@ -1264,6 +1278,7 @@ void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t *da
 ***************************************************************************************/
 void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t *data, uint8_t transp, bool bpp8, uint16_t *cmap)
 {
+  TFT_PROFILE_CALL("pushImage");
   if ((x >= _width) || (y >= _height)) return;
 
   int32_t dx = 0;
@@ -1513,6 +1528,7 @@ bool TFT_eSPI::getSwapBytes(void)
 // If w and h are 1, then 1 pixel is read, *data array size must be 3 bytes per pixel
 void  TFT_eSPI::readRectRGB(int32_t x0, int32_t y0, int32_t w, int32_t h, uint8_t *data)
 {
+  TFT_PROFILE_CALL("readRectRGB");
 #if defined(TFT_PARALLEL_8_BIT)
 
   uint32_t len = w * h;
@@ -1587,6 +1603,7 @@ void  TFT_eSPI::readRectRGB(int32_t x0, int32_t y0, int32_t w, int32_t h, uint8_
 // Optimised midpoint circle algorithm
 void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawCircle");
   int32_t  x  = 1;
   int32_t  dx = 1;
   int32_t  dy = r+r;
@@ -1681,6 +1698,7 @@ void TFT_eSPI::drawCircleHelper( int32_t x0, int32_t y0, int32_t r, uint8_t corn
 // Improved algorithm avoids repetition of lines
 void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color)
 {
+  TFT_PROFILE_CALL("fillCircle");
   int32_t  x  = 0;
   int32_t  dx = 1;
   int32_t  dy = r+r;
@@ -1754,6 +1772,7 @@ void TFT_eSPI::fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t corne
 ***************************************************************************************/
 void TFT_eSPI::drawEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color)
 {
+  TFT_PROFILE_CALL("drawEllipse");
   if (rx<2) return;
   if (ry<2) return;
   int32_t x, y;
@@ -1806,6 +1825,7 @@ void TFT_eSPI::drawEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint1
 ***************************************************************************************/
 void TFT_eSPI::fillEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint16_t color)
 {
+  TFT_PROFILE_CALL("fillEllipse");
   if (rx<2) return;
   if (ry<2) return;
   int32_t x, y;
@@ -1851,6 +1871,7 @@ void TFT_eSPI::fillEllipse(int16_t x0, int16_t y0, int32_t rx, int32_t ry, uint1
 ***************************************************************************************/
 void TFT_eSPI::fillScreen(uint32_t color)
 {
+  TFT_PROFILE_CALL("fillScreen");
   fillRect(0, 0, _width, _height, color);
 }
 
@@ -1862,6 +1883,7 @@ void TFT_eSPI::fillScreen(uint32_t color)
 // Draw a rectangle
 void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawRect");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -1883,6 +1905,7 @@ void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t col
 // Draw a rounded rectangle
 void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawRoundRect");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -1909,6 +1932,7 @@ void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t
 // Fill a rounded rectangle, changed to horizontal lines (faster in sprites)
 void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color)
 {
+  TFT_PROFILE_CALL("fillRoundRect");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -1931,6 +1955,7 @@ void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t
 // Draw a triangle
 void TFT_eSPI::drawTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawTriangle");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -1950,6 +1975,7 @@ void TFT_eSPI::drawTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int3
 // Fill a triangle - original Adafruit function works well and code footprint is small
 void TFT_eSPI::fillTriangle ( int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color)
 {
+  TFT_PROFILE_CALL("fillTriangle");
   int32_t a, b, y, last;
 
   // Sort coordinates by Y order (y2 >= y1 >= y0)
@@ -2030,6 +2056,7 @@ void TFT_eSPI::fillTriangle ( int32_t x0, int32_t y0, int32_t x1, int32_t y1, in
 ***************************************************************************************/
 void TFT_eSPI::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color)
 {
+  TFT_PROFILE_CALL("drawBitmap");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -2054,6 +2081,7 @@ void TFT_eSPI::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w
 ***************************************************************************************/
 void TFT_eSPI::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fgcolor, uint16_t bgcolor)
 {
+  TFT_PROFILE_CALL("drawBitmap");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -2077,6 +2105,7 @@ void TFT_eSPI::drawBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w
 ***************************************************************************************/
 void TFT_eSPI::drawXBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color)
 {
+  TFT_PROFILE_CALL("drawXBitmap");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -2101,6 +2130,7 @@ void TFT_eSPI::drawXBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t
 ***************************************************************************************/
 void TFT_eSPI::drawXBitmap(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bgcolor)
 {
+  TFT_PROFILE_CALL("drawXBitmap");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -2371,7 +2401,7 @@ int16_t TFT_eSPI::textWidth(const char *string, uint8_t font)
 #endif
 
   if (font>1 && font<9) {
-    char *widthtable = (char *)pgm_read_dword( &(fontdata[font].widthtbl ) ) - 32; //subtract the 32 outside the loop
+    char *widthtable = (char *)pgm_read_addr( &(fontdata[font].widthtbl ) ) - 32; //subtract the 32 outside the loop
 
     while (*string) {
       uniCode = *(string++);
@@ -2389,7 +2419,7 @@ int16_t TFT_eSPI::textWidth(const char *string, uint8_t font)
         uniCode = decodeUTF8(*string++);
         if ((uniCode >= pgm_read_word(&gfxFont->first)) && (uniCode <= pgm_read_word(&gfxFont->last ))) {
           uniCode -= pgm_read_word(&gfxFont->first);
-          GFXglyph *glyph  = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[uniCode]);
+          GFXglyph *glyph  = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[uniCode]);
           // If this is not the  last character or is a digit then use xAdvance
           if (*string  || isDigits) str_width += pgm_read_byte(&glyph->xAdvance);
           // Else use the offset plus width since this can be bigger than xAdvance
@@ -2447,12 +2477,31 @@ int16_t TFT_eSPI::fontHeight(void)
   return fontHeight(textfont);
 }
 
+/***************************************************************************************
+** Function name:           setTextBackdrop
+** Description:             set background used by batched transparent GLCD text
+***************************************************************************************/
+void TFT_eSPI::setTextBackdrop(int32_t color)
+{
+  _textBackdrop = color;
+}
+
+/***************************************************************************************
+** Function name:           getTextBackdrop
+** Description:             get background used by batched transparent GLCD text
+***************************************************************************************/
+int32_t TFT_eSPI::getTextBackdrop(void)
+{
+  return _textBackdrop;
+}
+
 /***************************************************************************************
 ** Function name:           drawChar
 ** Description:             draw a single character in the GLCD or GFXFF font
 ***************************************************************************************/
 void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32_t bg, uint8_t size)
 {
+  TFT_PROFILE_CALL("drawChar");
   if ((x >= _width)            || // Clip right
       (y >= _height)           || // Clip bottom
       ((x + 6 * size - 1) < 0) || // Clip left
@@ -2490,6 +2539,74 @@ void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32
 
     end_tft_write();
   }
+  else if ((size > 1) && (size <= GLYPH_LINE_MAX_SIZE) &&
+           (fillbg || (_textBackdrop != GLYPH_BACKDROP_NONE)) &&
+           (x >= 0) && (y >= 0) && (x + 6 * size <= _width) && (y + 8 * size <= _height) &&
+           (fillbg || (_textBackdrop != GLYPH_BACKDROP_READ) || (size <= GLYPH_READ_MAX_SIZE))) {
+    // Scaled glyph is expanded in RAM and streamed through a single window instead
+    // of one fillRect per font pixel. Buffers hold byte swapped colours, the same
+    // order readRect() returns, so pushPixels() is used with _swapBytes false.
+    uint8_t  column[6];
+    int32_t  w = 6 * size, h = 8 * size;
+    uint16_t fg = (color >> 8) | (color << 8);
+    bool     swap = _swapBytes;
+
+    for (int8_t i = 0; i < 5; i++ ) column[i] = pgm_read_byte(font + (c * 5) + i);
+    column[5] = 0;
+
+    _swapBytes = false;
+
+    if (!fillbg && (_textBackdrop == GLYPH_BACKDROP_READ)) {
+      // Transparent text: read the background back from the TFT and overlay the glyph.
+      // The cell is static, at 1.5 kbytes it is too big for the caller's stack
+      static uint16_t cell[6 * 8 * GLYPH_READ_MAX_SIZE * GLYPH_READ_MAX_SIZE];
+
+      readRect(x, y, w, h, cell);
+
+      for (int8_t i = 0; i < 6; i++ ) {
+        uint8_t line = column[i];
+        for (int8_t j = 0; j < 8; j++ ) {
+          if (line & 0x1) {
+            uint16_t *p = cell + (j * size) * w + i * size;
+            for (uint8_t yp = 0; yp < size; yp++) {
+              for (uint8_t xp = 0; xp < size; xp++) p[xp] = fg;
+              p += w;
+            }
+          }
+          line >>= 1;
+        }
+      }
+
+      begin_tft_write();
+      setWindow(x, y, x + w - 1, y + h - 1);
+      pushPixels(cell, w * h);
+      end_tft_write();
+    }
+    else {
+      // Opaque text, or transparent text over a known background colour
+      if (!fillbg) bg = _textBackdrop;
+      uint16_t bgs = (bg >> 8) | (bg << 8);
+      uint16_t line[6 * GLYPH_LINE_MAX_SIZE];
+      uint8_t  mask = 0x1;
+
+      begin_tft_write();
+      setWindow(x, y, x + w - 1, y + h - 1);
+
+      for (int8_t j = 0; j < 8; j++) {
+        uint16_t *p = line;
+        for (int8_t k = 0; k < 6; k++ ) {
+          uint16_t pixel = (column[k] & mask) ? fg : bgs;
+          for (uint8_t xp = 0; xp < size; xp++) *p++ = pixel;
+        }
+        for (uint8_t yp = 0; yp < size; yp++) pushPixels(line, w);
+        mask <<= 1;
+      }
+
+      end_tft_write();
+    }
+
+    _swapBytes = swap;
+  }
   else {
     //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
     inTransaction = true;
@@ -2533,8 +2650,8 @@ void TFT_eSPI::drawChar(int32_t x, int32_t y, uint16_t c, uint32_t color, uint32
 //>>>>>>>>>>>>>>>>>>>>>>>>>>>
 
       c -= pgm_read_word(&gfxFont->first);
-      GFXglyph *glyph  = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c]);
-      uint8_t  *bitmap = (uint8_t *)pgm_read_dword(&gfxFont->bitmap);
+      GFXglyph *glyph  = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[c]);
+      uint8_t  *bitmap = (uint8_t *)pgm_read_addr(&gfxFont->bitmap);
 
       uint32_t bo = pgm_read_word(&glyph->bitmapOffset);
       uint8_t  w  = pgm_read_byte(&glyph->width),
@@ -2614,9 +2731,6 @@ void TFT_eSPI::setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
 {
   //begin_tft_write(); // Must be called before setWindow
 
-  addr_col = 0xFFFF;
-  addr_row = 0xFFFF;
-
 #ifdef CGRAM_OFFSET
   x0+=colstart;
   x1+=colstart;
@@ -2624,14 +2738,30 @@ void TFT_eSPI::setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
   y1+=rowstart;
 #endif
 
-  // Column addr set
-  DC_C; tft_Write_8(TFT_CASET);
-  DC_D; tft_Write_32C(x0, x1);
+#ifdef TFT_PROFILE
+  if (addr_col != x0 || win_xe != x1 || addr_row != y0 || win_ye != y1) TFT_PROFILE_WINDOW;
+#endif
 
-  // Row addr set
-  DC_C; tft_Write_8(TFT_PASET);
-  DC_D; tft_Write_32C(y0, y1);
+  // Column addr set, not needed if unchanged (e.g. a column of glyphs or a fill)
+  if (addr_col != x0 || win_xe != x1) {
+    TFT_PROFILE_COMMAND;
+    DC_C; tft_Write_8(TFT_CASET);
+    DC_D; tft_Write_32C(x0, x1);
+    addr_col = x0;
+    win_xe = x1;
+  }
 
+  // Row addr set, not needed if unchanged (e.g. text on the same line)
+  if (addr_row != y0 || win_ye != y1) {
+    TFT_PROFILE_COMMAND;
+    DC_C; tft_Write_8(TFT_PASET);
+    DC_D; tft_Write_32C(y0, y1);
+    addr_row = y0;
+    win_ye = y1;
+  }
+
+  // RAMWR restarts the write at the window's top left corner either way
+  TFT_PROFILE_COMMAND;
   DC_C; tft_Write_8(TFT_RAMWR);
 
   DC_D;
@@ -2651,9 +2781,6 @@ void TFT_eSPI::readAddrWindow(int32_t xs, int32_t ys, int32_t w, int32_t h)
   int32_t xe = xs + w - 1;
   int32_t ye = ys + h - 1;
 
-  addr_col = 0xFFFF;
-  addr_row = 0xFFFF;
-
 #ifdef CGRAM_OFFSET
   xs += colstart;
   xe += colstart;
@@ -2661,15 +2788,26 @@ void TFT_eSPI::readAddrWindow(int32_t xs, int32_t ys, int32_t w, int32_t h)
   ye += rowstart;
 #endif
 
+  TFT_PROFILE_WINDOW;
+
+  // The read uses the same window registers
+  addr_col = xs;
+  win_xe = xe;
+  addr_row = ys;
+  win_ye = ye;
+
   // Column addr set
+  TFT_PROFILE_COMMAND;
   DC_C; tft_Write_8(TFT_CASET);
   DC_D; tft_Write_32C(xs, xe);
 
   // Row addr set
+  TFT_PROFILE_COMMAND;
   DC_C; tft_Write_8(TFT_PASET);
   DC_D; tft_Write_32C(ys, ye);
 
   // Read CGRAM command
+  TFT_PROFILE_COMMAND;
   DC_C; tft_Write_8(TFT_RAMRD);
 
   DC_D;
@@ -2684,6 +2822,7 @@ void TFT_eSPI::readAddrWindow(int32_t xs, int32_t ys, int32_t w, int32_t h)
 ***************************************************************************************/
 void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawPixel");
   // Range checking
   if ((x < 0) || (y < 0) ||(x >= _width) || (y >= _height)) return;
 
@@ -2694,20 +2833,29 @@ void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color)
 
   begin_tft_write();
 
+#ifdef TFT_PROFILE
+  if (addr_col != x || win_xe != x || addr_row != y || win_ye != y) TFT_PROFILE_WINDOW;
+#endif
+
   // No need to send x if it has not changed (speeds things up)
-  if (addr_col != x) {
+  if (addr_col != x || win_xe != x) {
+    TFT_PROFILE_COMMAND;
     DC_C; tft_Write_8(TFT_CASET);
     DC_D; tft_Write_32D(x);
     addr_col = x;
+    win_xe = x;
   }
 
   // No need to send y if it has not changed (speeds things up)
-  if (addr_row != y) {
+  if (addr_row != y || win_ye != y) {
+    TFT_PROFILE_COMMAND;
     DC_C; tft_Write_8(TFT_PASET);
     DC_D; tft_Write_32D(y);
     addr_row = y;
+    win_ye = y;
   }
 
+  TFT_PROFILE_COMMAND;
   DC_C; tft_Write_8(TFT_RAMWR);
   DC_D; tft_Write_16(color);
 
@@ -2720,6 +2868,7 @@ void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color)
 ***************************************************************************************/
 void TFT_eSPI::pushColor(uint16_t color)
 {
+  TFT_PROFILE_CALL("pushColor");
   begin_tft_write();
 
   tft_Write_16(color);
@@ -2734,6 +2883,7 @@ void TFT_eSPI::pushColor(uint16_t color)
 ***************************************************************************************/
 void TFT_eSPI::pushColor(uint16_t color, uint32_t len)
 {
+  TFT_PROFILE_CALL("pushColor");
   begin_tft_write();
 
   pushBlock(color, len);
@@ -2779,6 +2929,7 @@ void TFT_eSPI::writeColor(uint16_t color, uint32_t len)
 // len is number of bytes, not pixels
 void TFT_eSPI::pushColors(uint8_t *data, uint32_t len)
 {
+  TFT_PROFILE_CALL("pushColors");
   begin_tft_write();
 
   pushPixels(data, len>>1);
@@ -2793,6 +2944,7 @@ void TFT_eSPI::pushColors(uint8_t *data, uint32_t len)
 ***************************************************************************************/
 void TFT_eSPI::pushColors(uint16_t *data, uint32_t len, bool swap)
 {
+  TFT_PROFILE_CALL("pushColors");
   begin_tft_write();
   if (swap) {swap = _swapBytes; _swapBytes = true; }
 
@@ -2811,6 +2963,7 @@ void TFT_eSPI::pushColors(uint16_t *data, uint32_t len, bool swap)
 // an efficient FastH/V Line draw routine for line segments of 2 pixels or more
 void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawLine");
   //begin_tft_write();          // Sprite class can use this function, avoiding begin_tft_write()
   inTransaction = true;
 
@@ -2873,6 +3026,7 @@ void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t
 ***************************************************************************************/
 void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawFastVLine");
   // Clipping
   if ((x < 0) || (x >= _width) || (y >= _height)) return;
 
@@ -2898,6 +3052,7 @@ void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
 ***************************************************************************************/
 void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
 {
+  TFT_PROFILE_CALL("drawFastHLine");
   // Clipping
   if ((y < 0) || (x >= _width) || (y >= _height)) return;
 
@@ -2923,6 +3078,7 @@ void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
 ***************************************************************************************/
 void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
 {
+  TFT_PROFILE_CALL("fillRect");
   // Clipping
   if ((x >= _width) || (y >= _height)) return;
 
@@ -3230,6 +3386,7 @@ uint32_t TFT_eSPI::alphaBlend24(uint8_t alpha, uint32_t fgc, uint32_t bgc, uint8
 ***************************************************************************************/
 size_t TFT_eSPI::write(uint8_t utf8)
 {
+  TFT_PROFILE_CALL("write");
   if (utf8 == '\r') return 1;
 
   uint16_t uniCode = utf8;
@@ -3296,7 +3453,7 @@ size_t TFT_eSPI::write(uint8_t utf8)
     if ((textfont>2) && (textfont<9)) {
       if (uniCode > 127) return 1;
       // Uses the fontinfo struct array to avoid lots of 'if' or 'switch' statements
-      width = pgm_read_byte( (uint8_t *)pgm_read_dword( &(fontdata[textfont].widthtbl ) ) + uniCode-32 );
+      width = pgm_read_byte( (uint8_t *)pgm_read_addr( &(fontdata[textfont].widthtbl ) ) + uniCode-32 );
       height= pgm_read_byte( &fontdata[textfont].height );
     }
   }
@@ -3340,7 +3497,7 @@ size_t TFT_eSPI::write(uint8_t utf8)
       if (uniCode < pgm_read_word(&gfxFont->first)) return 1;
 
       uint16_t   c2    = uniCode - pgm_read_word(&gfxFont->first);
-      GFXglyph *glyph = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c2]);
+      GFXglyph *glyph = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[c2]);
       uint8_t   w     = pgm_read_byte(&glyph->width),
                 h     = pgm_read_byte(&glyph->height);
       if((w > 0) && (h > 0)) { // Is there an associated bitmap?
@@ -3371,12 +3528,14 @@ size_t TFT_eSPI::write(uint8_t utf8)
   // Any UTF-8 decoding must be done before calling drawChar()
 int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y)
 {
+  TFT_PROFILE_CALL("drawChar");
   return drawChar(uniCode, x, y, textfont);
 }
 
   // Any UTF-8 decoding must be done before calling drawChar()
 int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawChar");
   if (!uniCode) return 0;
 
   if (font==1) {
@@ -3403,7 +3562,7 @@ int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
     else {
       if((uniCode >= pgm_read_word(&gfxFont->first)) && (uniCode <= pgm_read_word(&gfxFont->last) )) {
         uint16_t   c2    = uniCode - pgm_read_word(&gfxFont->first);
-        GFXglyph *glyph = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c2]);
+        GFXglyph *glyph = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[c2]);
         return pgm_read_byte(&glyph->xAdvance) * textsize;
       }
       else {
@@ -3417,12 +3576,12 @@ int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
 
   int32_t width  = 0;
   int32_t height = 0;
-  uint32_t flash_address = 0;
+  uintptr_t flash_address = 0;
   uniCode -= 32;
 
 #ifdef LOAD_FONT2
   if (font == 2) {
-    flash_address = pgm_read_dword(&chrtbl_f16[uniCode]);
+    flash_address = pgm_read_addr(&chrtbl_f16[uniCode]);
     width = pgm_read_byte(widtbl_f16 + uniCode);
     height = chr_hgt_f16;
   }
@@ -3434,8 +3593,8 @@ int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
 #ifdef LOAD_RLE
   {
     if ((font>2) && (font<9)) {
-      flash_address = pgm_read_dword( (const void*)(pgm_read_dword( &(fontdata[font].chartbl ) ) + uniCode*sizeof(void *)) );
-      width = pgm_read_byte( (uint8_t *)pgm_read_dword( &(fontdata[font].widthtbl ) ) + uniCode );
+      flash_address = pgm_read_addr( (const void*)(pgm_read_addr( &(fontdata[font].chartbl ) ) + uniCode*sizeof(void *)) );
+      width = pgm_read_byte( (uint8_t *)pgm_read_addr( &(fontdata[font].widthtbl ) ) + uniCode );
       height= pgm_read_byte( &fontdata[font].height );
     }
   }
@@ -3610,6 +3769,7 @@ int16_t TFT_eSPI::drawChar(uint16_t uniCode, int32_t x, int32_t y, uint8_t font)
 // Without font number, uses font set by setTextFont()
 int16_t TFT_eSPI::drawString(const String& string, int32_t poX, int32_t poY)
 {
+  TFT_PROFILE_CALL("drawString");
   int16_t len = string.length() + 2;
   char buffer[len];
   string.toCharArray(buffer, len);
@@ -3618,6 +3778,7 @@ int16_t TFT_eSPI::drawString(const String& string, int32_t poX, int32_t poY)
 // With font number
 int16_t TFT_eSPI::drawString(const String& string, int32_t poX, int32_t poY, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawString");
   int16_t len = string.length() + 2;
   char buffer[len];
   string.toCharArray(buffer, len);
@@ -3627,12 +3788,14 @@ int16_t TFT_eSPI::drawString(const String& string, int32_t poX, int32_t poY, uin
 // Without font number, uses font set by setTextFont()
 int16_t TFT_eSPI::drawString(const char *string, int32_t poX, int32_t poY)
 {
+  TFT_PROFILE_CALL("drawString");
   return drawString(string, poX, poY, textfont);
 }
 
 // With font number. Note: font number is over-ridden if a smooth font is loaded
 int16_t TFT_eSPI::drawString(const char *string, int32_t poX, int32_t poY, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawString");
   int16_t sumX = 0;
   uint8_t padding = 1, baseline = 0;
   uint16_t cwidth = textWidth(string, font); // Find the pixel width of the string in the font
@@ -3747,7 +3910,7 @@ int16_t TFT_eSPI::drawString(const char *string, int32_t poX, int32_t poY, uint8
 
       if((c2 >= pgm_read_word(&gfxFont->first)) && (c2 <= pgm_read_word(&gfxFont->last) )) {
         c2 -= pgm_read_word(&gfxFont->first);
-        GFXglyph *glyph = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c2]);
+        GFXglyph *glyph = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[c2]);
         xo = pgm_read_byte(&glyph->xOffset) * textsize;
         // Adjust for negative xOffset
         if (xo > 0) xo = 0;
@@ -3861,6 +4024,7 @@ return sumX;
 ***************************************************************************************/
 int16_t TFT_eSPI::drawCentreString(const String& string, int32_t dX, int32_t poY, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawCentreString");
   int16_t len = string.length() + 2;
   char buffer[len];
   string.toCharArray(buffer, len);
@@ -3869,6 +4033,7 @@ int16_t TFT_eSPI::drawCentreString(const String& string, int32_t dX, int32_t poY
 
 int16_t TFT_eSPI::drawCentreString(const char *string, int32_t dX, int32_t poY, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawCentreString");
   uint8_t tempdatum = textdatum;
   int32_t sumX = 0;
   textdatum = TC_DATUM;
@@ -3884,6 +4049,7 @@ int16_t TFT_eSPI::drawCentreString(const char *string, int32_t dX, int32_t poY,
 ***************************************************************************************/
 int16_t TFT_eSPI::drawRightString(const String& string, int32_t dX, int32_t poY, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawRightString");
   int16_t len = string.length() + 2;
   char buffer[len];
   string.toCharArray(buffer, len);
@@ -3892,6 +4058,7 @@ int16_t TFT_eSPI::drawRightString(const String& string, int32_t dX, int32_t poY,
 
 int16_t TFT_eSPI::drawRightString(const char *string, int32_t dX, int32_t poY, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawRightString");
   uint8_t tempdatum = textdatum;
   int16_t sumX = 0;
   textdatum = TR_DATUM;
@@ -3907,6 +4074,7 @@ int16_t TFT_eSPI::drawRightString(const char *string, int32_t dX, int32_t poY, u
 ***************************************************************************************/
 int16_t TFT_eSPI::drawNumber(long long_num, int32_t poX, int32_t poY)
 {
+  TFT_PROFILE_CALL("drawNumber");
   isDigits = true; // Eliminate jiggle in monospaced fonts
   char str[12];
   ltoa(long_num, str, 10);
@@ -3915,6 +4083,7 @@ int16_t TFT_eSPI::drawNumber(long long_num, int32_t poX, int32_t poY)
 
 int16_t TFT_eSPI::drawNumber(long long_num, int32_t poX, int32_t poY, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawNumber");
   isDigits = true; // Eliminate jiggle in monospaced fonts
   char str[12];
   ltoa(long_num, str, 10);
@@ -3930,11 +4099,13 @@ int16_t TFT_eSPI::drawNumber(long long_num, int32_t poX, int32_t poY, uint8_t fo
 // looks complicated but much more compact and actually faster than using print class
 int16_t TFT_eSPI::drawFloat(float floatNumber, uint8_t dp, int32_t poX, int32_t poY)
 {
+  TFT_PROFILE_CALL("drawFloat");
   return drawFloat(floatNumber, dp, poX, poY, textfont);
 }
 
 int16_t TFT_eSPI::drawFloat(float floatNumber, uint8_t dp, int32_t poX, int32_t poY, uint8_t font)
 {
+  TFT_PROFILE_CALL("drawFloat");
   isDigits = true;
   char str[14];               // Array to contain decimal string
   uint8_t ptr = 0;            // Initialise pointer for array
@@ -4019,7 +4190,7 @@ void TFT_eSPI::setFreeFont(const GFXfont *f)
 
   // Find the biggest above and below baseline offsets
   for (uint8_t c = 0; c < numChars; c++) {
-    GFXglyph *glyph1  = &(((GFXglyph *)pgm_read_dword(&gfxFont->glyph))[c]);
+    GFXglyph *glyph1  = &(((GFXglyph *)pgm_read_addr(&gfxFont->glyph))[c]);
     int8_t ab = -pgm_read_byte(&glyph1->yOffset);
     if (ab > glyph_ab) glyph_ab = ab;
     int8_t bb = pgm_read_byte(&glyph1->height) - ab;
@@ -4222,9 +4393,21 @@ void TFT_eSPI::getSetup(setup_t &tft_settings)
 
 #include "Extensions/Sprite.cpp"
 
+#ifdef TFT_CANVAS
+  #include "Extensions/Canvas.cpp"
+#endif
+
+#ifdef TFT_BANDS
+  #include "Extensions/Bands.cpp"
+#endif
+
 #ifdef SMOOTH_FONT
   #include "Extensions/Smooth_font.cpp"
 #endif
 
+#ifdef TFT_PROFILE
+  #include "Extensions/Profile.cpp"
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////
 
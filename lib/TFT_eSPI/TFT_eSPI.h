@@ -50,10 +50,33 @@
   #include "Processors/TFT_eSPI_ESP8266.h"
 #elif defined (STM32)
   #include "Processors/TFT_eSPI_STM32.h"
+#elif defined (HOSTSIM)
+  #include "Processors/TFT_eSPI_Host.h"
 #else
   #include "Processors/TFT_eSPI_Generic.h"
 #endif
 
+// Reads a pointer from a font table, processors with wider pointers define their own
+#ifndef pgm_read_addr
+  #define pgm_read_addr(addr) pgm_read_dword(addr)
+#endif
+
+// Bus profiler hooks, see Extensions/Profile.h
+#ifdef TFT_PROFILE
+  extern uint32_t tft_profile_bytes, tft_profile_commands, tft_profile_windows;
+  #define TFT_PROFILE_BYTES(N) tft_profile_bytes += (N)
+  #define TFT_PROFILE_COMMAND  tft_profile_commands++
+  #define TFT_PROFILE_WINDOW   tft_profile_windows++
+  #define TFT_PROFILE_CALL(NAME) \
+  static uint8_t profile_slot = profileSlot(NAME); \
+  ProfileScope profile_scope(profile_slot)
+#else
+  #define TFT_PROFILE_BYTES(N)
+  #define TFT_PROFILE_COMMAND
+  #define TFT_PROFILE_WINDOW
+  #define TFT_PROFILE_CALL(NAME)
+#endif
+
 /***************************************************************************************
 **                         Section 3: Interface setup
 ***************************************************************************************/
@@ -205,6 +228,18 @@ const PROGMEM fontinfo fontdata [] = {
   #endif
 };
 
+// Batched GLCD glyph rendering limits for setTextSize() > 1, larger sizes are drawn
+// one pixel block at a time. The read back buffer is static (96 bytes x size x size)
+#ifndef GLYPH_LINE_MAX_SIZE
+  #define GLYPH_LINE_MAX_SIZE 8 // Maximum text size rendered through a line buffer
+#endif
+#ifndef GLYPH_READ_MAX_SIZE
+  #define GLYPH_READ_MAX_SIZE 4 // Maximum text size for transparent text with background read back
+#endif
+
+#define GLYPH_BACKDROP_NONE -1  // setTextBackdrop(): transparent text draws lit pixels only
+#define GLYPH_BACKDROP_READ -2  // setTextBackdrop(): read the background back from the TFT
+
 /***************************************************************************************
 **                         Section 5: Font datum enumeration
 ***************************************************************************************/
@@ -512,6 +547,12 @@ class TFT_eSPI : public Print {
   void     setTextPadding(uint16_t x_width);                // Set text padding (background blanking/over-write) width in pixels
   uint16_t getTextPadding(void);                            // Get text padding
 
+           // Transparent GLCD text with setTextSize() > 1 is drawn pixel block by pixel block unless a
+           // backdrop is set, then each glyph is expanded in RAM and sent through one window:
+           // GLYPH_BACKDROP_READ reads the background back from the TFT, a 16 bit colour is assumed to be behind the text
+  void     setTextBackdrop(int32_t color);                  // GLYPH_BACKDROP_NONE (default), GLYPH_BACKDROP_READ or a 565 colour
+  int32_t  getTextBackdrop(void);
+
 #ifdef LOAD_GFXFF
   void     setFreeFont(const GFXfont *f = NULL),            // Select the GFX Free Font
            setTextFont(uint8_t font);                       // Set the font number to use in future
@@ -718,11 +759,10 @@ class TFT_eSPI : public Print {
  //-------------------------------------- protected ----------------------------------//
  protected:
 
-  //int32_t  win_xe, win_ye;          // Window end coords - not needed
-
   int32_t  _init_width, _init_height; // Display w/h as input, used by setRotation()
   int32_t  _width, _height;           // Display w/h as modified by current rotation
   int32_t  addr_row, addr_col;        // Window position - used to minimise window commands
+  int32_t  win_xe, win_ye;            // Window end coords - CASET/PASET are only sent when changed
 
   uint32_t fontsloaded;               // Bit field of fonts loaded
 
@@ -743,6 +783,8 @@ class TFT_eSPI : public Print {
 
   uint32_t _lastColor; // Buffered value of last colour used
 
+  int32_t  _textBackdrop; // Background for batched transparent GLCD text, see setTextBackdrop()
+
 #ifdef LOAD_GFXFF
   GFXfont  *gfxFont;
 #endif
@@ -760,6 +802,11 @@ class TFT_eSPI : public Print {
   #include "Extensions/Smooth_font.h"  // Loaded if SMOOTH_FONT is defined by user
 #endif
 
+// Load the bus profiler
+#ifdef TFT_PROFILE
+  #include "Extensions/Profile.h"      // Loaded if TFT_PROFILE is defined by user
+#endif
+
 }; // End of class TFT_eSPI
 
 /***************************************************************************************
@@ -771,4 +818,14 @@ class TFT_eSPI : public Print {
 // Load the Sprite Class
 #include "Extensions/Sprite.h"
 
+// Load the Canvas Class, a Sprite that flushes only what changed
+#ifdef TFT_CANVAS
+  #include "Extensions/Canvas.h"       // Loaded if TFT_CANVAS is defined by user
+#endif
+
+// Load the Bands Class, renders recorded graphics a band of lines at a time
+#ifdef TFT_BANDS
+  #include "Extensions/Bands.h"        // Loaded if TFT_BANDS is defined by user
+#endif
+
 #endif // ends #ifndef _TFT_eSPIH_
@@ -261,6 +261,18 @@
 // this will save ~20kbytes of FLASH
 #define SMOOTH_FONT
 
+// Uncomment to count the bus bytes, commands and cycles each drawing call costs,
+// see Extensions/Profile.h. Commented out it costs nothing
+//#define TFT_PROFILE
+
+// Uncomment to load TFT_eCanvas, a Sprite that sends the panel only the areas drawn
+// over, see Extensions/Canvas.h
+//#define TFT_CANVAS
+
+// Uncomment to load TFT_eBands, which renders the graphics recorded with it a band of
+// lines at a time through two small Sprites, see Extensions/Bands.h
+//#define TFT_BANDS
+
 
 // ##################################################################################
 //
@@ -3,7 +3,7 @@
 
  See end of file for original header text and MIT license info.
  
- This sketch uses the GLCD font only.
+ This sketch uses the GLCD font, fonts 2 and 4 and a FreeFont if loaded.
 
  Make sure all the display driver and pin comnenctions are correct by
  editting the User_Setup.h file in the TFT_eSPI library folder.
@@ -423,6 +423,14 @@ uint32_t testText()
 	tft.setTextColor(TFT_MAGENTA);
 	tft.setTextSize(6);
 	tft.println(F("Woot!"));
+	tft.setTextColor(TFT_CYAN);	tft.setTextSize(1);
+	tft.drawString("Font 2", 0, 270, 2);
+	tft.drawString("Font 4", 56, 266, 4);
+#ifdef LOAD_GFXFF
+	tft.setFreeFont(&FreeSans9pt7b);
+	tft.drawString("FreeSans", 150, 268);
+	tft.setFreeFont(NULL);
+#endif
 	uint32_t t = micros() - start;
 	delay(1000);
 	return t;
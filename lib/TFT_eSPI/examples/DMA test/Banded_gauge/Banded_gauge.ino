@@ -0,0 +1,101 @@
+// Gauge drawn a band of lines at a time with TFT_eBands
+
+// The whole gauge is redrawn every frame, yet the screen never shows it part
+// drawn as it would if the sketch cleared the screen and drew over it. The
+// screen is rendered in 320 x 24 line bands, two of them, so it takes 30 kbytes
+// of RAM where a full screen 16 bit Sprite would take 150 kbytes. With DMA one
+// band is drawn while the other is sent.
+
+// TFT_eBands is loaded when TFT_BANDS is defined in the setup file, see User_Setup.h
+
+#include <TFT_eSPI.h> // Hardware-specific library
+
+#ifndef TFT_BANDS
+  #error "Define TFT_BANDS in the TFT_eSPI setup file to load TFT_eBands"
+#endif
+
+// DMA is available with STM32 processors and HostSim, comment out to push the
+// bands without it
+#if defined (STM32_DMA) || defined (HOST_DMA)
+  #define USE_DMA
+#endif
+
+TFT_eSPI   tft   = TFT_eSPI();
+TFT_eBands frame = TFT_eBands(&tft);
+
+#define BAND_LINES 24
+
+#define DIAL_X   160
+#define DIAL_Y   130
+#define DIAL_R   100
+
+uint32_t startTime, frames = 0; // For frames-per-second estimate
+int32_t  value = 0, step = 1;
+
+void setup() {
+  Serial.begin(115200);
+
+  tft.begin();
+  tft.setRotation(1);
+  tft.fillScreen(TFT_BLACK);
+
+#ifdef USE_DMA
+  tft.initDMA();
+#endif
+
+  // Calls recorded: the dial's circle takes one a pixel, the rest a few dozen
+  if (!frame.createBands(BAND_LINES, 1024)) {
+    Serial.println("Not enough RAM for the bands");
+    while (1) yield();
+  }
+
+  frame.setBackground(TFT_NAVY);
+
+  startTime = millis();
+}
+
+void loop() {
+  drawGauge(value);
+  frame.render();
+
+  value += step;
+  if (value == 0 || value == 100) step = -step;
+
+  if (++frames == 100) {
+    Serial.print(100000.0 / (millis() - startTime));
+    Serial.println(" fps");
+    startTime = millis();
+    frames = 0;
+  }
+}
+
+// Record the gauge showing v percent
+void drawGauge(int32_t v) {
+  frame.clear();
+
+  frame.fillCircle(DIAL_X, DIAL_Y, DIAL_R, TFT_DARKGREY);
+  frame.drawCircle(DIAL_X, DIAL_Y, DIAL_R, TFT_WHITE);
+
+  // Scale from 225 to -45 degrees, a tick every 10 percent
+  for (int32_t i = 0; i <= 100; i += 10) {
+    float a = (225 - i * 2.7) * DEG_TO_RAD;
+    float c = cos(a), s = -sin(a);
+    frame.drawLine(DIAL_X + c * (DIAL_R - 12), DIAL_Y + s * (DIAL_R - 12),
+                   DIAL_X + c * (DIAL_R - 2),  DIAL_Y + s * (DIAL_R - 2), TFT_WHITE);
+  }
+
+  float a = (225 - v * 2.7) * DEG_TO_RAD;
+  frame.drawLine(DIAL_X, DIAL_Y, DIAL_X + cos(a) * (DIAL_R - 16), DIAL_Y - sin(a) * (DIAL_R - 16), TFT_RED);
+  frame.fillCircle(DIAL_X, DIAL_Y, 6, TFT_RED);
+
+  char text[8];
+  snprintf(text, sizeof(text), "%d %%", (int)v);
+  frame.setTextDatum(MC_DATUM);
+  frame.setTextColor(TFT_WHITE, TFT_DARKGREY);
+  frame.setTextSize(3);
+  frame.drawString(text, DIAL_X, DIAL_Y + 50, 1);
+
+  frame.setTextSize(2);
+  frame.setTextColor(TFT_YELLOW);
+  frame.drawString("Banded gauge", DIAL_X, 12, 1);
+}
@@ -0,0 +1,80 @@
+#include <TinyGPS++.h>
+/*
+   This sample sketch measures how fast TinyGPS++ parses NMEA text, comparing
+   the one-character encode(c) with the block encode(buf, len) that is meant
+   for handing over a whole UART FIFO drain at once.  No device is needed;
+   the same sample stream is parsed repeatedly from RAM.
+*/
+
+// A sample NMEA stream.
+const char gpsStream[] =
+  "$GPRMC,045103.000,A,3014.1984,N,09749.2872,W,0.67,161.46,030913,,,A*7C\r\n"
+  "$GPGGA,045104.000,3014.1985,N,09749.2873,W,1,09,1.2,211.6,M,-22.5,M,,0000*62\r\n"
+  "$GPRMC,045200.000,A,3014.3820,N,09748.9514,W,36.88,65.02,030913,,,A*77\r\n"
+  "$GPGGA,045201.000,3014.3864,N,09748.9411,W,1,10,1.2,200.8,M,-22.5,M,,0000*6C\r\n"
+  "$GPRMC,045251.000,A,3014.4275,N,09749.0626,W,0.51,217.94,030913,,,A*7D\r\n"
+  "$GPGGA,045252.000,3014.4273,N,09749.0628,W,1,09,1.3,206.9,M,-22.5,M,,0000*6F\r\n";
+
+// Number of times the sample stream is parsed per measurement
+static const int passes = 2000;
+
+// Size of the blocks handed to encode(buf, len), a typical UART FIFO drain
+static const size_t blockSize = 64;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  Serial.println(F("EncodeBenchmark.ino"));
+  Serial.println(F("Compares per-character and block NMEA parsing (no device needed)"));
+  Serial.print(F("Testing TinyGPS++ library v. ")); Serial.println(TinyGPSPlus::libraryVersion());
+  Serial.println();
+
+  const size_t len = sizeof(gpsStream) - 1;
+
+  TinyGPSPlus charGps;
+  unsigned long start = micros();
+  for (int i = 0; i < passes; ++i)
+    for (size_t j = 0; j < len; ++j)
+      charGps.encode(gpsStream[j]);
+  unsigned long charMicros = micros() - start;
+
+  TinyGPSPlus blockGps;
+  size_t blockSentences = 0;
+  start = micros();
+  for (int i = 0; i < passes; ++i)
+    for (size_t j = 0; j < len; j += blockSize)
+      blockSentences += blockGps.encode(gpsStream + j, j + blockSize < len ? blockSize : len - j);
+  unsigned long blockMicros = micros() - start;
+
+  report(F("encode(c)        "), charGps, charMicros);
+  report(F("encode(buf, len) "), blockGps, blockMicros);
+
+  Serial.print(F("Sentences returned by encode(buf, len): "));
+  Serial.println(blockSentences);
+
+  if (charGps.passedChecksum() != blockGps.passedChecksum() ||
+      charGps.location.lat() != blockGps.location.lat() ||
+      charGps.time.value() != blockGps.time.value())
+    Serial.println(F("MISMATCH between per-character and block results!"));
+
+  Serial.println();
+  Serial.println(F("Done."));
+}
+
+void loop()
+{
+}
+
+void report(const __FlashStringHelper *name, TinyGPSPlus &gps, unsigned long us)
+{
+  Serial.print(name);
+  Serial.print(gps.charsProcessed());
+  Serial.print(F(" chars in "));
+  Serial.print(us);
+  Serial.print(F(" us = "));
+  Serial.print(us ? (unsigned long)(1000000.0 * gps.charsProcessed() / us) : 0);
+  Serial.print(F(" chars/s, "));
+  Serial.print(gps.passedChecksum());
+  Serial.println(F(" sentences"));
+}
@@ -0,0 +1,146 @@
+#include <TinyGPS++.h>
+/*
+   This sample sketch compares the single precision, fixed point geodesy
+   functions (distanceBetweenE7, courseToE7, destinationE7) with the double
+   precision distanceBetween and courseTo.  For legs of several lengths it
+   prints the worst distance, course and destination error against the
+   double results, and the time per call of each version.
+
+   On the ESP32 the FPU only handles float, so every double operation is
+   done in software.  No device is needed.
+*/
+
+// Points tested per leg length
+static const int samples = 2000;
+
+// Longest leg of each class, in meters
+static const float legs[] = {100, 1000, 11000, 100000, 1000000, 10000000};
+
+static uint32_t seed = 1;
+
+static uint32_t nextRandom()
+{
+  seed = seed * 1664525UL + 1013904223UL;
+  return seed;
+}
+
+// Uniform in [lo, hi)
+static float randomIn(float lo, float hi)
+{
+  return lo + (hi - lo) * (nextRandom() >> 8) / 16777216.0f;
+}
+
+// Double precision destination on the same sphere, as the reference
+static void destination(double lat, double lng, double course, double meters, double &lat2, double &lng2)
+{
+  double angle = meters / _GPS_EARTH_RADIUS;
+  double rlat = radians(lat);
+  double rcourse = radians(course);
+  double rlat2 = asin(sin(rlat) * cos(angle) + cos(rlat) * sin(angle) * cos(rcourse));
+  double dlng = atan2(sin(rcourse) * sin(angle) * cos(rlat), cos(angle) - sin(rlat) * sin(rlat2));
+  lat2 = degrees(rlat2);
+  lng2 = lng + degrees(dlng);
+  if (lng2 > 180)
+    lng2 -= 360;
+  else if (lng2 < -180)
+    lng2 += 360;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  Serial.println(F("GeodesyBenchmark.ino"));
+  Serial.println(F("Fixed point float geodesy against the double versions (no device needed)"));
+  Serial.print(F("Testing TinyGPS++ library v. ")); Serial.println(TinyGPSPlus::libraryVersion());
+  Serial.println();
+  Serial.println(F("Leg (m)    Dist err (m)  Dist err (ppm)  Course err (deg)  Dest err (m)  us double  us float"));
+  Serial.println(F("-------------------------------------------------------------------------------------------"));
+
+  static int32_t lat1[samples], lng1[samples], lat2[samples], lng2[samples];
+  static double dlat1[samples], dlng1[samples], dlat2[samples], dlng2[samples];
+
+  for (unsigned leg = 0; leg < sizeof(legs) / sizeof(legs[0]); ++leg)
+  {
+    // Random start points away from the poles, random courses and lengths
+    for (int i = 0; i < samples; ++i)
+    {
+      dlat1[i] = randomIn(-80, 80);
+      dlng1[i] = randomIn(-180, 180);
+      destination(dlat1[i], dlng1[i], randomIn(0, 360), randomIn(legs[leg] / 10, legs[leg]), dlat2[i], dlng2[i]);
+      lat1[i] = lround(dlat1[i] * 1e7);
+      lng1[i] = lround(dlng1[i] * 1e7);
+      lat2[i] = lround(dlat2[i] * 1e7);
+      lng2[i] = lround(dlng2[i] * 1e7);
+      dlat1[i] = lat1[i] / 1e7;
+      dlng1[i] = lng1[i] / 1e7;
+      dlat2[i] = lat2[i] / 1e7;
+      dlng2[i] = lng2[i] / 1e7;
+    }
+
+    double maxDist = 0, maxPpm = 0, maxCourse = 0, maxDest = 0;
+    for (int i = 0; i < samples; ++i)
+    {
+      double d = TinyGPSPlus::distanceBetween(dlat1[i], dlng1[i], dlat2[i], dlng2[i]);
+      double c = TinyGPSPlus::courseTo(dlat1[i], dlng1[i], dlat2[i], dlng2[i]);
+      double err = fabs(TinyGPSPlus::distanceBetweenE7(lat1[i], lng1[i], lat2[i], lng2[i]) - d);
+      double cerr = fabs(TinyGPSPlus::courseToE7(lat1[i], lng1[i], lat2[i], lng2[i]) - c);
+      if (cerr > 180)
+        cerr = 360 - cerr;
+
+      // Where destinationE7 lands, compared to the double destination
+      int32_t lat, lng;
+      double rlat, rlng;
+      TinyGPSPlus::destinationE7(lat1[i], lng1[i], c, d, lat, lng);
+      destination(dlat1[i], dlng1[i], c, d, rlat, rlng);
+      double derr = TinyGPSPlus::distanceBetween(lat / 1e7, lng / 1e7, rlat, rlng);
+
+      if (err > maxDist)
+        maxDist = err;
+      if (d > 0 && err / d * 1e6 > maxPpm)
+        maxPpm = err / d * 1e6;
+      if (cerr > maxCourse && d > 1)
+        maxCourse = cerr;
+      if (derr > maxDest)
+        maxDest = derr;
+    }
+
+    // Time distance and course together, as a navigation update would
+    volatile double sinkDouble = 0;
+    unsigned long start = micros();
+    for (int i = 0; i < samples; ++i)
+      sinkDouble += TinyGPSPlus::distanceBetween(dlat1[i], dlng1[i], dlat2[i], dlng2[i]) +
+                    TinyGPSPlus::courseTo(dlat1[i], dlng1[i], dlat2[i], dlng2[i]);
+    unsigned long doubleMicros = micros() - start;
+
+    volatile float sinkFloat = 0;
+    start = micros();
+    for (int i = 0; i < samples; ++i)
+      sinkFloat += TinyGPSPlus::distanceBetweenE7(lat1[i], lng1[i], lat2[i], lng2[i]) +
+                   TinyGPSPlus::courseToE7(lat1[i], lng1[i], lat2[i], lng2[i]);
+    unsigned long floatMicros = micros() - start;
+
+    printColumn(legs[leg], 0, 11);
+    printColumn(maxDist, 3, 14);
+    printColumn(maxPpm, 3, 16);
+    printColumn(maxCourse, 5, 18);
+    printColumn(maxDest, 3, 14);
+    printColumn((double)doubleMicros / samples, 3, 11);
+    printColumn((double)floatMicros / samples, 3, 10);
+    Serial.println();
+  }
+
+  Serial.println();
+  Serial.println(F("Done."));
+}
+
+void loop()
+{
+}
+
+static void printColumn(double val, int prec, int width)
+{
+  int len = Serial.print(val, prec);
+  while (len++ < width)
+    Serial.print(' ');
+}
@@ -0,0 +1,70 @@
+#include <TinyGPS++.h>
+/*
+   This sample sketch shows the satellite table TinyGPS++ builds from the
+   GSV and GSA sentences of every constellation: PRN, elevation, azimuth and
+   SNR of each satellite in view, whether it is used in the solution, and the
+   PDOP/VDOP.  The table is updated in one step when the last GSV message of
+   a group arrives, so it never holds half a group.
+
+   No device is needed; a sample NMEA stream is parsed from RAM.
+*/
+
+// A sample NMEA stream with GPS and GLONASS satellites.
+const char *gpsStream =
+  "$GPGSV,3,1,11,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*74\r\n"
+  "$GPGSV,3,2,11,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*74\r\n"
+  "$GPGSV,3,3,11,22,42,067,42,24,14,311,43,27,05,244,00,,,,*4D\r\n"
+  "$GLGSV,1,1,02,65,35,052,31,72,20,310,27*67\r\n"
+  "$GNGSA,A,3,16,18,22,24,,,,,,,,,1.8,1.0,1.5*28\r\n"
+  "$GNGSA,A,3,65,72,,,,,,,,,,,1.8,1.0,1.5*26\r\n";
+
+// The TinyGPS++ object
+TinyGPSPlus gps;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  Serial.println(F("SatelliteTable.ino"));
+  Serial.println(F("Satellites in view from GSV and GSA (no device needed)"));
+  Serial.print(F("Testing TinyGPS++ library v. ")); Serial.println(TinyGPSPlus::libraryVersion());
+  Serial.println();
+
+  while (*gpsStream)
+    gps.encode(*gpsStream++);
+
+  Serial.println(F("Sys PRN Elev Azim SNR Used"));
+  Serial.println(F("---------------------------"));
+
+  uint8_t count = gps.satsInView.count();
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    const TinyGPSSatellite &sat = gps.satsInView[i];
+    printInt(sat.system, 3);
+    printInt(sat.prn, 4);
+    printInt(sat.elevation, 5);
+    printInt(sat.azimuth, 5);
+    printInt(sat.snr, 4);
+    Serial.println(sat.used ? F("    *") : F(""));
+  }
+
+  Serial.println();
+  Serial.print(F("In view: ")); Serial.print(count);
+  Serial.print(F("  Used: ")); Serial.println(gps.satsInView.usedCount());
+  Serial.print(F("PDOP: ")); Serial.print(gps.pdop.value() / 100.0);
+  Serial.print(F("  VDOP: ")); Serial.println(gps.vdop.value() / 100.0);
+
+  Serial.println();
+  Serial.println(F("Done."));
+}
+
+void loop()
+{
+}
+
+static void printInt(long val, int len)
+{
+  char sz[12];
+  sprintf(sz, "%*ld", len, val);
+  Serial.print(sz);
+}
@@ -0,0 +1,114 @@
+#include <TinyGPS++.h>
+/*
+   This sample sketch shows TinyGPS++ decoding the u-blox UBX NAV-PVT
+   message alongside NMEA.  UBX frames are recognised by their 0xB5 0x62
+   sync characters, so both protocols can share one serial stream, and
+   NAV-PVT fills the same location, date, time, speed, course and altitude
+   objects as RMC and GGA.  It has no HDOP, so hdop is set to its pDOP,
+   which is never smaller.
+
+   A NAV-PVT frame carrying the same fix as a pair of RMC/GGA sentences is
+   parsed both ways, then each is timed.  No device is needed.
+*/
+
+// RMC and GGA sentences for one fix, 150 bytes.
+const char nmeaStream[] =
+  "$GPRMC,045201.000,A,3014.3864,N,09748.9411,W,36.88,65.02,030913,,,A*72\r\n"
+  "$GPGGA,045201.000,3014.3864,N,09748.9411,W,1,10,1.2,200.8,M,-22.5,M,,0000*6C\r\n";
+
+// NAV-PVT frame for the same fix, 100 bytes.
+const uint8_t ubxFrame[] =
+{
+  0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x68, 0x59, 0x0B, 0x01, 0xDD, 0x07,
+  0x09, 0x03, 0x04, 0x34, 0x01, 0x07, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x03, 0x01, 0x0A, 0x0A, 0xCE, 0x82, 0xB2, 0xC5, 0x25, 0x39,
+  0x06, 0x12, 0x7C, 0xB8, 0x02, 0x00, 0x60, 0x10, 0x03, 0x00, 0xC4, 0x09,
+  0x00, 0x00, 0xAC, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D, 0x4A, 0x00, 0x00, 0x70, 0x36,
+  0x63, 0x00, 0x90, 0x01, 0x00, 0x00, 0x50, 0xC3, 0x00, 0x00, 0xB4, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0xDF, 0x49,
+};
+
+// Number of times each stream is parsed per measurement
+static const int passes = 2000;
+
+void setup()
+{
+  Serial.begin(115200);
+
+  Serial.println(F("UbxExample.ino"));
+  Serial.println(F("Decoding UBX NAV-PVT next to NMEA (no device needed)"));
+  Serial.print(F("Testing TinyGPS++ library v. ")); Serial.println(TinyGPSPlus::libraryVersion());
+  Serial.println();
+
+  // One stream carrying both protocols
+  TinyGPSPlus mixed;
+  mixed.encode(nmeaStream, sizeof(nmeaStream) - 1);
+  size_t frames = mixed.encode((const char *)ubxFrame, sizeof(ubxFrame));
+
+  Serial.print(F("Valid messages in mixed stream: "));
+  Serial.print(mixed.passedChecksum());
+  Serial.print(F(" (UBX frames: "));
+  Serial.print(frames);
+  Serial.println(F(")"));
+  Serial.println();
+
+  // Each protocol on its own, so neither column shows what the other parsed
+  TinyGPSPlus nmea, ubx;
+  nmea.encode(nmeaStream, sizeof(nmeaStream) - 1);
+  ubx.encode((const char *)ubxFrame, sizeof(ubxFrame));
+
+  Serial.println(F("          NMEA          UBX"));
+  printPair(F("Lat       "), nmea.location.lat(), ubx.location.lat(), 6);
+  printPair(F("Lng       "), nmea.location.lng(), ubx.location.lng(), 6);
+  printPair(F("Date      "), nmea.date.value(), ubx.date.value(), 0);
+  printPair(F("Time      "), nmea.time.value(), ubx.time.value(), 0);
+  printPair(F("Knots     "), nmea.speed.knots(), ubx.speed.knots(), 2);
+  printPair(F("Course    "), nmea.course.deg(), ubx.course.deg(), 2);
+  printPair(F("Altitude  "), nmea.altitude.meters(), ubx.altitude.meters(), 2);
+  printPair(F("Sats      "), nmea.satellites.value(), ubx.satellites.value(), 0);
+  printPair(F("HDOP      "), nmea.hdop.hdop(), ubx.hdop.hdop(), 2);
+  Serial.println();
+
+  unsigned long nmeaMicros = timeStream(nmeaStream, sizeof(nmeaStream) - 1);
+  unsigned long ubxMicros = timeStream((const char *)ubxFrame, sizeof(ubxFrame));
+
+  report(F("NMEA RMC+GGA "), sizeof(nmeaStream) - 1, nmeaMicros);
+  report(F("UBX NAV-PVT  "), sizeof(ubxFrame), ubxMicros);
+
+  Serial.println();
+  Serial.println(F("Done."));
+}
+
+void loop()
+{
+}
+
+static unsigned long timeStream(const char *stream, size_t len)
+{
+  TinyGPSPlus gps;
+  unsigned long start = micros();
+  for (int i = 0; i < passes; ++i)
+    gps.encode(stream, len);
+  return micros() - start;
+}
+
+static void printPair(const __FlashStringHelper *name, double a, double b, int prec)
+{
+  Serial.print(name);
+  Serial.print(a, prec);
+  Serial.print(F("    "));
+  Serial.println(b, prec);
+}
+
+static void report(const __FlashStringHelper *name, size_t bytes, unsigned long us)
+{
+  Serial.print(name);
+  Serial.print(bytes);
+  Serial.print(F(" bytes/fix, "));
+  Serial.print((double)us / passes, 2);
+  Serial.print(F(" us/fix, at most "));
+  Serial.print(960.0 / bytes, 1);
+  Serial.println(F(" fixes/s at 9600 baud"));
+}
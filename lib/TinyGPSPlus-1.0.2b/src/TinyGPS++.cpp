@@ -27,26 +27,34 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <ctype.h>
 #include <stdlib.h>
 
-#define _GPRMCterm   "GPRMC"
-#define _GPGGAterm   "GPGGA"
-#define _GNRMCterm   "GNRMC"
-#define _GNGGAterm   "GNGGA"
+// Sentence formatter, the three characters after the two character talker ID
+#define _GPS_SENTENCE_ID(a, b, c) (((uint32_t)(a) << 16) | ((uint32_t)(b) << 8) | (uint32_t)(c))
 
 TinyGPSPlus::TinyGPSPlus()
   :  parity(0)
   ,  isChecksumTerm(false)
   ,  curSentenceType(GPS_SENTENCE_OTHER)
+  ,  curSystem(_GPS_SYSTEM_UNKNOWN)
   ,  curTermNumber(0)
   ,  curTermOffset(0)
   ,  sentenceHasFix(false)
-  ,  customElts(0)
   ,  customCandidates(0)
+  ,  customCursor(0)
+  ,  ubxState(UBX_IDLE)
+  ,  fixSeq(0)
+  ,  pendingTime(0)
+  ,  pendingParts(0)
+  ,  pendingHasFix(false)
   ,  encodedCharCount(0)
   ,  sentencesWithFixCount(0)
   ,  failedChecksumCount(0)
   ,  passedChecksumCount(0)
 {
   term[0] = '\0';
+  for (int i = 0; i < _GPS_CUSTOM_BUCKETS; ++i)
+    customBuckets[i] = 0;
+  memset(&fix, 0, sizeof(fix));
+  memset(&pendingFix, 0, sizeof(pendingFix));
 }
 
 //
@@ -57,6 +65,9 @@ bool TinyGPSPlus::encode(char c)
 {
   ++encodedCharCount;
 
+  if (ubxState != UBX_IDLE)
+    return encodeUbx((uint8_t)c);
+
   switch(c)
   {
   case ',': // term terminators
@@ -84,6 +95,14 @@ bool TinyGPSPlus::encode(char c)
     curSentenceType = GPS_SENTENCE_OTHER;
     isChecksumTerm = false;
     sentenceHasFix = false;
+    customCandidates = customCursor = NULL;
+    return false;
+
+  case '\xb5': // UBX frame begin, NMEA text never contains this
+    ubxState = UBX_SYNC2;
+    curSentenceType = GPS_SENTENCE_OTHER;
+    isChecksumTerm = false;
+    customCandidates = customCursor = NULL;
     return false;
 
   default: // ordinary characters
@@ -97,6 +116,144 @@ bool TinyGPSPlus::encode(char c)
   return false;
 }
 
+// Processes one byte of a UBX frame:
+// 0xB5 0x62, class, id, length (2 bytes, little-endian), payload, CK_A, CK_B
+bool TinyGPSPlus::encodeUbx(uint8_t c)
+{
+  switch(ubxState)
+  {
+  case UBX_SYNC2:
+    if (c != 0x62)
+    {
+      // Not a frame after all, treat the byte as NMEA
+      ubxState = UBX_IDLE;
+      --encodedCharCount;
+      return encode((char)c);
+    }
+    ubxState = UBX_CLASS;
+    ubxCkA = ubxCkB = 0;
+    return false;
+
+  case UBX_CLASS:
+    ubxClass = c;
+    ubxState = UBX_ID;
+    break;
+
+  case UBX_ID:
+    ubxId = c;
+    ubxState = UBX_LENGTH1;
+    break;
+
+  case UBX_LENGTH1:
+    ubxLength = c;
+    ubxState = UBX_LENGTH2;
+    break;
+
+  case UBX_LENGTH2:
+    ubxLength |= (uint16_t)c << 8;
+    ubxOffset = 0;
+    if (ubxLength > _GPS_UBX_MAX_LENGTH)
+    {
+      ubxState = UBX_IDLE;
+      ++failedChecksumCount;
+      return false;
+    }
+    ubxState = ubxLength ? UBX_PAYLOAD : UBX_CK_A;
+    break;
+
+  case UBX_PAYLOAD:
+    if (ubxOffset < sizeof(ubxPayload))
+      ubxPayload[ubxOffset] = c;
+    if (++ubxOffset == ubxLength)
+      ubxState = UBX_CK_A;
+    break;
+
+  case UBX_CK_A:
+    ubxRxCkA = c;
+    ubxState = UBX_CK_B;
+    return false;
+
+  case UBX_CK_B:
+    ubxState = UBX_IDLE;
+    return endOfUbxFrame(c);
+  }
+
+  // 8-bit Fletcher checksum over class, id, length and payload
+  ubxCkA += c;
+  ubxCkB += ubxCkA;
+  return false;
+}
+
+// Processes a block of characters, e.g. everything waiting in a UART FIFO.
+// Characters inside a term are copied and added to the parity in one pass;
+// only the delimiters go through encode(char).
+// Returns the number of sentences that passed the checksum test.
+size_t TinyGPSPlus::encode(const char *buf, size_t len)
+{
+  size_t validSentences = 0;
+  const char *end = buf + len;
+
+  while (buf < end)
+  {
+    if (ubxState != UBX_IDLE)
+    {
+      // UBX payloads are summed in one pass, the framing bytes go through encode(char)
+      if (ubxState == UBX_PAYLOAD)
+      {
+        size_t n = ubxLength - ubxOffset;
+        if (n > (size_t)(end - buf))
+          n = end - buf;
+        encodedCharCount += n;
+        for (const char *stop = buf + n; buf < stop; ++buf)
+        {
+          if (ubxOffset < sizeof(ubxPayload))
+            ubxPayload[ubxOffset] = (uint8_t)*buf;
+          ++ubxOffset;
+          ubxCkA += (uint8_t)*buf;
+          ubxCkB += ubxCkA;
+        }
+        if (ubxOffset == ubxLength)
+          ubxState = UBX_CK_A;
+      }
+      else if (encode(*buf++))
+      {
+        ++validSentences;
+      }
+      continue;
+    }
+
+    // Every NMEA delimiter (',', '*', '\r', '\n' and '$') sorts at or below ','
+    const char *run = buf;
+    uint8_t runParity = 0;
+    while (buf < end)
+    {
+      uint8_t c = (uint8_t)*buf;
+      if ((c <= ',' && (c == ',' || c == '*' || c == '\r' || c == '\n' || c == '$')) || c == 0xB5)
+        break;
+      runParity ^= c;
+      ++buf;
+    }
+
+    size_t runLength = buf - run;
+    if (runLength)
+    {
+      size_t space = curTermOffset < sizeof(term) - 1 ? sizeof(term) - 1 - curTermOffset : 0;
+      if (runLength < space)
+        space = runLength;
+      memcpy(term + curTermOffset, run, space);
+      curTermOffset += space;
+      if (!isChecksumTerm)
+        parity ^= runParity;
+      encodedCharCount += runLength;
+    }
+
+    if (buf < end && encode(*buf++))
+      ++validSentences;
+  }
+
+  return validSentences;
+}
+
 //
 // internal utilities
 //
@@ -152,6 +309,194 @@ void TinyGPSPlus::parseDegrees(const char *term, RawDegrees &deg)
   deg.negative = false;
 }
 
+// Maps a talker ID to the GNSS it reports on, combined (GN) talkers are unknown
+static uint8_t talkerSystem(const char *talker)
+{
+  if (talker[0] == 'G')
+    switch(talker[1])
+  {
+    case 'P': return _GPS_SYSTEM_GPS;
+    case 'L': return _GPS_SYSTEM_GLONASS;
+    case 'A': return _GPS_SYSTEM_GALILEO;
+    case 'B': return _GPS_SYSTEM_BEIDOU;
+    case 'Q': return _GPS_SYSTEM_QZSS;
+  }
+  else if (talker[0] == 'B' && talker[1] == 'D')
+    return _GPS_SYSTEM_BEIDOU;
+  return _GPS_SYSTEM_UNKNOWN;
+}
+
+static uint16_t ubxU2(const uint8_t *p)
+{
+  return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+static int32_t ubxI4(const uint8_t *p)
+{
+  return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+// Splits degrees * 1e7 into the RawDegrees form used for NMEA
+static void ubxDegrees(int32_t e7, RawDegrees &deg)
+{
+  deg.negative = e7 < 0;
+  uint32_t magnitude = deg.negative ? 0 - (uint32_t)e7 : (uint32_t)e7;
+  deg.deg = (uint16_t)(magnitude / 10000000UL);
+  deg.billionths = (magnitude % 10000000UL) * 100;
+}
+
+// Processes a just-completed UBX frame
+bool TinyGPSPlus::endOfUbxFrame(uint8_t ckB)
+{
+  if (ubxRxCkA != ubxCkA || ckB != ubxCkB)
+  {
+    ++failedChecksumCount;
+    return false;
+  }
+
+  passedChecksumCount++;
+
+  // NAV-PVT is 84 bytes up to protocol 14 and 92 bytes since
+  if (ubxClass == 0x01 && ubxId == 0x07 && ubxLength >= 84)
+    decodeNavPvt();
+
+  return true;
+}
+
+// Fills the NMEA objects from a NAV-PVT payload, converting to their units
+void TinyGPSPlus::decodeNavPvt()
+{
+  const uint8_t *p = ubxPayload;
+  uint8_t validFlags = p[11];
+  uint8_t fixType = p[20];
+  bool hasFix = (p[21] & 0x01) && fixType >= 2 && fixType <= 4; // gnssFixOK, 2D/3D/GNSS+DR
+
+  if (hasFix)
+    ++sentencesWithFixCount;
+
+  if (validFlags & 0x01) // validDate
+  {
+    date.newDate = p[7] * 10000UL + p[6] * 100UL + ubxU2(p + 4) % 100;
+    date.commit();
+  }
+
+  if (validFlags & 0x02) // validTime
+  {
+    // nano is signed; a small negative value means the seconds were rounded up
+    int32_t nano = ubxI4(p + 16);
+    time.newTime = p[8] * 1000000UL + p[9] * 10000UL + p[10] * 100UL + (nano > 0 ? nano / 10000000L : 0);
+    time.commit();
+  }
+
+  satellites.newval = p[23];
+  satellites.commit();
+  pdop.newval = ubxU2(p + 76);
+  pdop.commit();
+  // NAV-PVT has no HDOP, pDOP stands in for it as it is never the smaller
+  hdop.newval = pdop.newval;
+  hdop.commit();
+
+  if (hasFix)
+  {
+    ubxDegrees(ubxI4(p + 24), location.rawNewLngData);
+    ubxDegrees(ubxI4(p + 28), location.rawNewLatData);
+    location.commit();
+    altitude.newval = ubxI4(p + 36) / 10;        // hMSL, mm to cm
+    altitude.commit();
+    speed.newval = ubxI4(p + 60) * 90 / 463;     // gSpeed, mm/s to 1/100 knot
+    speed.commit();
+    course.newval = ubxI4(p + 64) / 1000;        // headMot, 1e-5 to 1e-2 degree
+    course.commit();
+  }
+
+  // One NAV-PVT is a whole epoch; a date or time it has not resolved is 0,
+  // as an empty RMC field gives, not the last epoch's
+  pendingFix.date = (validFlags & 0x01) ? date.newDate : 0;
+  pendingFix.time = (validFlags & 0x02) ? time.newTime : 0;
+  pendingFix.satellites = satellites.newval;
+  pendingFix.hdop = hdop.newval;
+  pendingFix.hasFix = hasFix;
+  if (hasFix)
+  {
+    pendingFix.latE7 = ubxI4(p + 28);
+    pendingFix.lngE7 = ubxI4(p + 24);
+    pendingFix.altitude = altitude.newval;
+    pendingFix.speed = speed.newval;
+    pendingFix.course = course.newval;
+  }
+  pendingParts = 0;
+  publishFix();
+}
+
+// Adds a just-committed RMC or GGA to the epoch snapshot being assembled
+void TinyGPSPlus::stageFix()
+{
+  // A sentence from a newer epoch discards the incomplete older one
+  if (pendingParts != 0 && pendingTime != time.newTime)
+    pendingParts = 0;
+
+  pendingHasFix = pendingParts == 0 ? sentenceHasFix : pendingHasFix && sentenceHasFix;
+  pendingTime = time.newTime;
+  pendingFix.time = time.newTime;
+
+  if (sentenceHasFix)
+  {
+    pendingFix.latE7 = degreesE7(location.rawNewLatData);
+    pendingFix.lngE7 = degreesE7(location.rawNewLngData);
+  }
+
+  if (curSentenceType == GPS_SENTENCE_RMC)
+  {
+    pendingParts |= 1;
+    pendingFix.date = date.newDate;
+    if (sentenceHasFix)
+    {
+      pendingFix.speed = speed.newval;
+      pendingFix.course = course.newval;
+    }
+  }
+  else
+  {
+    pendingParts |= 2;
+    pendingFix.satellites = satellites.newval;
+    pendingFix.hdop = hdop.newval;
+    if (sentenceHasFix)
+      pendingFix.altitude = altitude.newval;
+  }
+
+  if (pendingParts == 3)
+  {
+    pendingFix.hasFix = pendingHasFix;
+    pendingParts = 0;
+    publishFix();
+  }
+}
+
+void TinyGPSPlus::publishFix()
+{
+  pendingFix.commitTime = millis();
+
+  ++fixSeq;
+  __sync_synchronize();
+  fix = pendingFix;
+  __sync_synchronize();
+  ++fixSeq;
+}
+
+uint32_t TinyGPSPlus::readFix(TinyGPSFix &copy) const
+{
+  uint32_t seq;
+  do
+  {
+    seq = fixSeq;
+    __sync_synchronize();
+    copy = fix;
+    __sync_synchronize();
+  } while ((seq & 1) || seq != fixSeq);
+
+  return seq / 2;
+}
+
 #define COMBINE(sentence_type, term_number) (((unsigned)(sentence_type) << 5) | term_number)
 
 // Processes a just-completed term
@@ -170,7 +515,7 @@ bool TinyGPSPlus::endOfTermHandler()
 
       switch(curSentenceType)
       {
-      case GPS_SENTENCE_GPRMC:
+      case GPS_SENTENCE_RMC:
         date.commit();
         time.commit();
         if (sentenceHasFix)
@@ -179,8 +524,9 @@ bool TinyGPSPlus::endOfTermHandler()
            speed.commit();
            course.commit();
         }
+        stageFix();
         break;
-      case GPS_SENTENCE_GPGGA:
+      case GPS_SENTENCE_GGA:
         time.commit();
         if (sentenceHasFix)
         {
@@ -189,11 +535,20 @@ bool TinyGPSPlus::endOfTermHandler()
         }
         satellites.commit();
         hdop.commit();
+        stageFix();
+        break;
+      case GPS_SENTENCE_GSV:
+        satsInView.endView(curTermNumber, true);
+        break;
+      case GPS_SENTENCE_GSA:
+        pdop.commit();
+        vdop.commit();
+        satsInView.commitUsed();
         break;
       }
 
       // Commit all custom listeners of this sentence type
-      for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0; p = p->next)
+      for (TinyGPSCustom *p = customCandidates; p != NULL; p = p->next)
          p->commit();
       return true;
     }
@@ -201,6 +556,8 @@ bool TinyGPSPlus::endOfTermHandler()
     else
     {
       ++failedChecksumCount;
+      if (curSentenceType == GPS_SENTENCE_GSV)
+        satsInView.endView(curTermNumber, false);
     }
 
     return false;
@@ -209,17 +566,33 @@ bool TinyGPSPlus::endOfTermHandler()
   // the first term determines the sentence type
   if (curTermNumber == 0)
   {
-    if (!strcmp(term, _GPRMCterm) || !strcmp(term, _GNRMCterm))
-      curSentenceType = GPS_SENTENCE_GPRMC;
-    else if (!strcmp(term, _GPGGAterm) || !strcmp(term, _GNGGAterm))
-      curSentenceType = GPS_SENTENCE_GPGGA;
-    else
-      curSentenceType = GPS_SENTENCE_OTHER;
+    // Built-in sentences are recognised by formatter alone, so any talker
+    // (GP, GL, GA, GB, GN...) is accepted
+    curSentenceType = GPS_SENTENCE_OTHER;
+    if (curTermOffset == 5)
+      switch(_GPS_SENTENCE_ID(term[2], term[3], term[4]))
+    {
+      case _GPS_SENTENCE_ID('R', 'M', 'C'):
+        curSentenceType = GPS_SENTENCE_RMC;
+        break;
+      case _GPS_SENTENCE_ID('G', 'G', 'A'):
+        curSentenceType = GPS_SENTENCE_GGA;
+        break;
+      case _GPS_SENTENCE_ID('G', 'S', 'V'):
+        curSentenceType = GPS_SENTENCE_GSV;
+        curSystem = talkerSystem(term);
+        break;
+      case _GPS_SENTENCE_ID('G', 'S', 'A'):
+        curSentenceType = GPS_SENTENCE_GSA;
+        curSystem = talkerSystem(term);
+        satsInView.newUsedSystem = curSystem;
+        satsInView.newUsedCount = 0;
+        break;
+    }
 
     // Any custom candidates of this sentence type?
-    for (customCandidates = customElts; customCandidates != NULL && strcmp(customCandidates->sentenceName, term) < 0; customCandidates = customCandidates->next);
-    if (customCandidates != NULL && strcmp(customCandidates->sentenceName, term) > 0)
-       customCandidates = NULL;
+    for (customCandidates = customBuckets[customBucket(term)]; customCandidates != NULL && strcmp(customCandidates->sentenceName, term) != 0; customCandidates = customCandidates->nextGroup);
+    for (customCursor = customCandidates; customCursor != NULL && customCursor->termNumber <= 0; customCursor = customCursor->next);
 
     return false;
   }
@@ -227,56 +600,70 @@ bool TinyGPSPlus::endOfTermHandler()
   if (curSentenceType != GPS_SENTENCE_OTHER && term[0])
     switch(COMBINE(curSentenceType, curTermNumber))
   {
-    case COMBINE(GPS_SENTENCE_GPRMC, 1): // Time in both sentences
-    case COMBINE(GPS_SENTENCE_GPGGA, 1):
+    case COMBINE(GPS_SENTENCE_RMC, 1): // Time in both sentences
+    case COMBINE(GPS_SENTENCE_GGA, 1):
       time.setTime(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 2): // GPRMC validity
+    case COMBINE(GPS_SENTENCE_RMC, 2): // RMC validity
       sentenceHasFix = term[0] == 'A';
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 3): // Latitude
-    case COMBINE(GPS_SENTENCE_GPGGA, 2):
+    case COMBINE(GPS_SENTENCE_RMC, 3): // Latitude
+    case COMBINE(GPS_SENTENCE_GGA, 2):
       location.setLatitude(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 4): // N/S
-    case COMBINE(GPS_SENTENCE_GPGGA, 3):
+    case COMBINE(GPS_SENTENCE_RMC, 4): // N/S
+    case COMBINE(GPS_SENTENCE_GGA, 3):
       location.rawNewLatData.negative = term[0] == 'S';
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 5): // Longitude
-    case COMBINE(GPS_SENTENCE_GPGGA, 4):
+    case COMBINE(GPS_SENTENCE_RMC, 5): // Longitude
+    case COMBINE(GPS_SENTENCE_GGA, 4):
       location.setLongitude(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 6): // E/W
-    case COMBINE(GPS_SENTENCE_GPGGA, 5):
+    case COMBINE(GPS_SENTENCE_RMC, 6): // E/W
+    case COMBINE(GPS_SENTENCE_GGA, 5):
       location.rawNewLngData.negative = term[0] == 'W';
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 7): // Speed (GPRMC)
+    case COMBINE(GPS_SENTENCE_RMC, 7): // Speed (RMC)
       speed.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 8): // Course (GPRMC)
+    case COMBINE(GPS_SENTENCE_RMC, 8): // Course (RMC)
       course.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 9): // Date (GPRMC)
+    case COMBINE(GPS_SENTENCE_RMC, 9): // Date (RMC)
       date.setDate(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGGA, 6): // Fix data (GPGGA)
+    case COMBINE(GPS_SENTENCE_GGA, 6): // Fix data (GGA)
       sentenceHasFix = term[0] > '0';
       break;
-    case COMBINE(GPS_SENTENCE_GPGGA, 7): // Satellites used (GPGGA)
+    case COMBINE(GPS_SENTENCE_GGA, 7): // Satellites used (GGA)
       satellites.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGGA, 8): // HDOP
+    case COMBINE(GPS_SENTENCE_GGA, 8): // HDOP
       hdop.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGGA, 9): // Altitude (GPGGA)
+    case COMBINE(GPS_SENTENCE_GGA, 9): // Altitude (GGA)
       altitude.set(term);
       break;
+    case COMBINE(GPS_SENTENCE_GSA, 15): // PDOP (GSA)
+      pdop.set(term);
+      break;
+    case COMBINE(GPS_SENTENCE_GSA, 17): // VDOP (GSA)
+      vdop.set(term);
+      break;
+    case COMBINE(GPS_SENTENCE_GSA, 18): // System ID (GSA, NMEA 4.10)
+      satsInView.newUsedSystem = (uint8_t)atol(term);
+      break;
+    default:
+      if (curSentenceType == GPS_SENTENCE_GSV) // Message counters and satellites (GSV)
+        satsInView.setViewTerm(curTermNumber, term, curSystem);
+      else if (curSentenceType == GPS_SENTENCE_GSA && curTermNumber >= 3 && curTermNumber <= 14) // PRNs used (GSA)
+        satsInView.addUsed(term);
+      break;
   }
 
-  // Set custom values as needed
-  for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0 && p->termNumber <= curTermNumber; p = p->next)
-    if (p->termNumber == curTermNumber)
-         p->set(term);
+  // Set custom values as needed, the cursor only ever moves forward
+  for (; customCursor != NULL && customCursor->termNumber == curTermNumber; customCursor = customCursor->next)
+    customCursor->set(term);
 
   return false;
 }
@@ -327,6 +714,126 @@ double TinyGPSPlus::courseTo(double lat1, double long1, double lat2, double long
   return degrees(a2);
 }
 
+#define _GPS_RAD_PER_E7 1.74532925e-9f // pi / 180 / 1e7
+#define _GPS_METERS_PER_E7 (_GPS_EARTH_RADIUS * _GPS_RAD_PER_E7)
+
+/* static */
+int32_t TinyGPSPlus::degreesE7(const RawDegrees &deg)
+{
+  int32_t e7 = deg.deg * 10000000L + (deg.billionths + 50) / 100;
+  return deg.negative ? -e7 : e7;
+}
+
+// Longitude difference folded into -180..180 degrees
+static int32_t deltaLongE7(int32_t from, int32_t to)
+{
+  int64_t d = (int64_t)to - from;
+  if (d > 1800000000LL)
+    d -= 3600000000LL;
+  else if (d < -1800000000LL)
+    d += 3600000000LL;
+  return (int32_t)d;
+}
+
+static bool isShortLeg(int32_t dlat, int32_t dlong)
+{
+  return dlat > -_GPS_SHORT_LEG_E7 && dlat < _GPS_SHORT_LEG_E7 &&
+         dlong > -_GPS_SHORT_LEG_E7 && dlong < _GPS_SHORT_LEG_E7;
+}
+
+/* static */
+float TinyGPSPlus::distanceBetweenE7(int32_t lat1, int32_t long1, int32_t lat2, int32_t long2)
+{
+  // Differences are taken in integers, so nearby points lose no precision
+  int32_t dlat = lat2 - lat1;
+  int32_t dlong = deltaLongE7(long1, long2);
+
+  if (isShortLeg(dlat, dlong))
+  {
+    float x = dlong * cosf((lat1 + dlat / 2) * _GPS_RAD_PER_E7);
+    float y = dlat;
+    return sqrtf(x * x + y * y) * _GPS_METERS_PER_E7;
+  }
+
+  float shlat = sinf(dlat * (_GPS_RAD_PER_E7 / 2));
+  float shlong = sinf(dlong * (_GPS_RAD_PER_E7 / 2));
+  float a = shlat * shlat + cosf(lat1 * _GPS_RAD_PER_E7) * cosf(lat2 * _GPS_RAD_PER_E7) * shlong * shlong;
+  if (a > 1.0f)
+    a = 1.0f;
+  return 2.0f * atan2f(sqrtf(a), sqrtf(1.0f - a)) * _GPS_EARTH_RADIUS;
+}
+
+/* static */
+float TinyGPSPlus::courseToE7(int32_t lat1, int32_t long1, int32_t lat2, int32_t long2)
+{
+  int32_t dlat = lat2 - lat1;
+  int32_t dlong = deltaLongE7(long1, long2);
+  float course;
+
+  if (isShortLeg(dlat, dlong))
+  {
+    // The flat course holds at the midpoint, meridians converge by dlong * sin(lat)
+    float rmid = (lat1 + dlat / 2) * _GPS_RAD_PER_E7;
+    course = atan2f(dlong * cosf(rmid), (float)dlat) - dlong * (_GPS_RAD_PER_E7 / 2) * sinf(rmid);
+  }
+  else
+  {
+    float rlat1 = lat1 * _GPS_RAD_PER_E7;
+    float rlat2 = lat2 * _GPS_RAD_PER_E7;
+    float rdlong = dlong * _GPS_RAD_PER_E7;
+    course = atan2f(sinf(rdlong) * cosf(rlat2),
+                    cosf(rlat1) * sinf(rlat2) - sinf(rlat1) * cosf(rlat2) * cosf(rdlong));
+  }
+
+  course *= (float)(180.0 / PI);
+  if (course < 0.0f)
+    course += 360.0f;
+  return course;
+}
+
+/* static */
+void TinyGPSPlus::destinationE7(int32_t lat1, int32_t long1, float course, float meters, int32_t &lat2, int32_t &long2)
+{
+  float rcourse = course * (float)(PI / 180.0);
+  float rlat1 = lat1 * _GPS_RAD_PER_E7;
+  float dlat, dlong;
+
+  // Near the poles the flat approximation breaks down at any distance
+  if (meters < _GPS_SHORT_LEG_E7 * _GPS_METERS_PER_E7 && lat1 > -890000000L && lat1 < 890000000L)
+  {
+    // Second order in the angle travelled, which keeps to the great circle
+    float angle = meters / _GPS_EARTH_RADIUS;
+    float scourse = sinf(rcourse), ccourse = cosf(rcourse);
+    float tlat = tanf(rlat1), clat = cosf(rlat1);
+    dlat = angle * (ccourse - angle / 2 * scourse * scourse * tlat) / _GPS_RAD_PER_E7;
+    dlong = angle * scourse * (1 + angle * ccourse * tlat) / clat / _GPS_RAD_PER_E7;
+  }
+  else
+  {
+    float angle = meters / _GPS_EARTH_RADIUS;
+    float slat1 = sinf(rlat1), clat1 = cosf(rlat1);
+    float sangle = sinf(angle), cangle = cosf(angle);
+    float scourse = sinf(rcourse), ccourse = cosf(rcourse);
+
+    // Destination as a unit vector, atan2 stays accurate where asin would not
+    float north = clat1 * cangle - slat1 * sangle * ccourse;
+    float east = sangle * scourse;
+    float up = slat1 * cangle + clat1 * sangle * ccourse;
+
+    // Work in differences from the start point to keep float precision
+    dlat = (atan2f(up, sqrtf(north * north + east * east)) - rlat1) / _GPS_RAD_PER_E7;
+    dlong = atan2f(east, north) / _GPS_RAD_PER_E7;
+  }
+
+  lat2 = lat1 + (int32_t)lroundf(dlat);
+  int64_t lng = (int64_t)long1 + lroundf(dlong);
+  if (lng > 1800000000LL)
+    lng -= 3600000000LL;
+  else if (lng < -1800000000LL)
+    lng += 3600000000LL;
+  long2 = (int32_t)lng;
+}
+
 const char *TinyGPSPlus::cardinal(double course)
 {
   static const char* directions[] = {"N", "NNE", "NE", "ENE", "E", "ESE", "SE", "SSE", "S", "SSW", "SW", "WSW", "W", "WNW", "NW", "NNW"};
@@ -366,6 +873,18 @@ double TinyGPSLocation::lng()
    return rawLngData.negative ? -ret : ret;
 }
 
+int32_t TinyGPSLocation::latE7()
+{
+   updated = false;
+   return TinyGPSPlus::degreesE7(rawLatData);
+}
+
+int32_t TinyGPSLocation::lngE7()
+{
+   updated = false;
+   return TinyGPSPlus::degreesE7(rawLngData);
+}
+
 void TinyGPSDate::commit()
 {
    date = newDate;
@@ -457,6 +976,149 @@ void TinyGPSInteger::set(const char *term)
    newval = atol(term);
 }
 
+void TinyGPSSatellites::setViewTerm(uint8_t termNumber, const char *term, uint8_t system)
+{
+   if (termNumber == 1)
+   {
+      newTotal = (uint8_t)atol(term);
+      return;
+   }
+
+   if (termNumber == 2)
+   {
+      newMsg = (uint8_t)atol(term);
+      newPrnTerm = 0;
+      if (newMsg == 1)
+      {
+         newSystem = system;
+         newCount = 0;
+         newExpected = 1;
+      }
+      return;
+   }
+
+   if (termNumber < 4)
+      return;
+
+   // Each satellite is four terms: PRN, elevation, azimuth, SNR
+   uint8_t field = (termNumber - 4) % 4;
+   if (field == 0)
+   {
+      if (newCount >= _GPS_MAX_SATELLITES)
+      {
+         newPrnTerm = 0;
+         return;
+      }
+      TinyGPSSatellite &sat = newSats[newCount++];
+      sat.system = newSystem;
+      sat.prn = (uint8_t)atol(term);
+      sat.elevation = 0;
+      sat.snr = 0;
+      sat.azimuth = 0;
+      sat.used = false;
+      newPrnTerm = termNumber;
+   }
+   else if (newPrnTerm != 0 && termNumber - newPrnTerm == field)
+   {
+      TinyGPSSatellite &sat = newSats[newCount - 1];
+      if (field == 1)
+         sat.elevation = (int8_t)atol(term);
+      else if (field == 2)
+         sat.azimuth = (uint16_t)atol(term);
+      else
+         sat.snr = (uint8_t)atol(term);
+   }
+}
+
+void TinyGPSSatellites::endView(uint8_t termCount, bool passed)
+{
+   // A lost or corrupt message spoils the rest of its group
+   if (!passed || newExpected == 0 || newMsg != newExpected)
+   {
+      newExpected = 0;
+      return;
+   }
+
+   // An NMEA 4.10 signal ID after the last satellite was taken for a PRN
+   if (termCount > 4 && (termCount - 4) % 4 == 1 && newPrnTerm == termCount - 1)
+      --newCount;
+
+   if (newMsg == newTotal)
+   {
+      commitView();
+      newExpected = 0;
+   }
+   else
+   {
+      ++newExpected;
+   }
+}
+
+void TinyGPSSatellites::commitView()
+{
+   // Replace this talker's satellites, keep the other constellations
+   uint8_t n = 0;
+   for (uint8_t i = 0; i < satCount; ++i)
+      if (sats[i].system != newSystem)
+         sats[n++] = sats[i];
+   for (uint8_t i = 0; i < newCount && n < _GPS_MAX_SATELLITES; ++i)
+      sats[n++] = newSats[i];
+   satCount = n;
+
+   markUsed();
+   lastCommitTime = millis();
+   valid = updated = true;
+}
+
+void TinyGPSSatellites::addUsed(const char *term)
+{
+   if (newUsedCount < _GPS_MAX_USED_SATELLITES)
+      newUsed[newUsedCount++] = (uint8_t)atol(term);
+}
+
+void TinyGPSSatellites::commitUsed()
+{
+   // Combined (GN) sentences before NMEA 4.10 carry no system ID, go by PRN range
+   uint8_t system = newUsedSystem;
+   if (system == _GPS_SYSTEM_UNKNOWN && newUsedCount > 0)
+   {
+      if (newUsed[0] >= 65 && newUsed[0] <= 96)
+         system = _GPS_SYSTEM_GLONASS;
+      else if (newUsed[0] <= 32)
+         system = _GPS_SYSTEM_GPS;
+   }
+
+   uint8_t n = 0;
+   for (uint8_t i = 0; i < usedSatCount; ++i)
+      if (usedSats[i].system != system)
+         usedSats[n++] = usedSats[i];
+   for (uint8_t i = 0; i < newUsedCount && n < _GPS_MAX_SATELLITES; ++i)
+   {
+      usedSats[n].system = system;
+      usedSats[n++].prn = newUsed[i];
+   }
+   usedSatCount = n;
+
+   markUsed();
+   updated = true;
+}
+
+void TinyGPSSatellites::markUsed()
+{
+   for (uint8_t i = 0; i < satCount; ++i)
+   {
+      TinyGPSSatellite &sat = sats[i];
+      sat.used = false;
+      for (uint8_t j = 0; j < usedSatCount; ++j)
+         if (usedSats[j].prn == sat.prn &&
+             (usedSats[j].system == sat.system || usedSats[j].system == _GPS_SYSTEM_UNKNOWN || sat.system == _GPS_SYSTEM_UNKNOWN))
+         {
+            sat.used = true;
+            break;
+         }
+   }
+}
+
 TinyGPSCustom::TinyGPSCustom(TinyGPSPlus &gps, const char *_sentenceName, int _termNumber)
 {
    begin(gps, _sentenceName, _termNumber);
@@ -489,15 +1151,36 @@ void TinyGPSCustom::set(const char *term)
 
 void TinyGPSPlus::insertCustom(TinyGPSCustom *pElt, const char *sentenceName, int termNumber)
 {
-   TinyGPSCustom **ppelt;
+   TinyGPSCustom **ppgroup;
 
-   for (ppelt = &this->customElts; *ppelt != NULL; ppelt = &(*ppelt)->next)
-   {
-      int cmp = strcmp(sentenceName, (*ppelt)->sentenceName);
-      if (cmp < 0 || (cmp == 0 && termNumber < (*ppelt)->termNumber))
+   // Find the listeners already registered for this sentence, if any
+   for (ppgroup = &this->customBuckets[customBucket(sentenceName)]; *ppgroup != NULL; ppgroup = &(*ppgroup)->nextGroup)
+      if (strcmp(sentenceName, (*ppgroup)->sentenceName) == 0)
          break;
-   }
+
+   // Keep them sorted by term number
+   TinyGPSCustom **ppelt = ppgroup;
+   while (*ppelt != NULL && (*ppelt)->termNumber <= termNumber)
+      ppelt = &(*ppelt)->next;
 
    pElt->next = *ppelt;
+   pElt->nextGroup = NULL;
+
+   // A new first listener takes over the bucket link
+   if (ppelt == ppgroup && *ppgroup != NULL)
+   {
+      pElt->nextGroup = (*ppgroup)->nextGroup;
+      (*ppgroup)->nextGroup = NULL;
+   }
+
    *ppelt = pElt;
 }
+
+/* static */
+uint8_t TinyGPSPlus::customBucket(const char *sentenceName)
+{
+   uint8_t hash = 0;
+   while (*sentenceName)
+      hash = hash * 31 + (uint8_t)*sentenceName++;
+   return hash % _GPS_CUSTOM_BUCKETS;
+}
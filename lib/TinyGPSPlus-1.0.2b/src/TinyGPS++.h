@@ -38,7 +38,24 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define _GPS_MILES_PER_METER 0.00062137112
 #define _GPS_KM_PER_METER 0.001
 #define _GPS_FEET_PER_METER 3.2808399
+#define _GPS_EARTH_RADIUS 6372795 // meters, the sphere distanceBetween() uses
+#define _GPS_SHORT_LEG_E7 1000000L // 0.1 degree, about 11 km
 #define _GPS_MAX_FIELD_SIZE 15
+#define _GPS_CUSTOM_BUCKETS 8 // hash buckets for TinyGPSCustom sentence names
+#ifndef _GPS_MAX_SATELLITES
+#define _GPS_MAX_SATELLITES 32 // GSV entries kept, across all constellations
+#endif
+#define _GPS_MAX_USED_SATELLITES 12 // PRN slots in one GSA sentence
+#define _GPS_UBX_MAX_PAYLOAD 92 // UBX payload bytes kept, enough for NAV-PVT
+#define _GPS_UBX_MAX_LENGTH 1024 // longer UBX frames are taken as noise
+
+// GNSS system IDs, as used by NMEA 4.10 and later
+#define _GPS_SYSTEM_UNKNOWN 0
+#define _GPS_SYSTEM_GPS 1
+#define _GPS_SYSTEM_GLONASS 2
+#define _GPS_SYSTEM_GALILEO 3
+#define _GPS_SYSTEM_BEIDOU 4
+#define _GPS_SYSTEM_QZSS 5
 
 struct RawDegrees
 {
@@ -61,6 +78,8 @@ public:
    const RawDegrees &rawLng()     { updated = false; return rawLngData; }
    double lat();
    double lng();
+   int32_t latE7();   // degrees * 1e7, no floating point
+   int32_t lngE7();
 
    TinyGPSLocation() : valid(false), updated(false)
    {}
@@ -189,6 +208,93 @@ struct TinyGPSHDOP : TinyGPSDecimal
    double hdop() { return value() / 100.0; }
 };
 
+struct TinyGPSSatellite
+{
+   uint8_t system;     // _GPS_SYSTEM_* of the talker that reported it
+   uint8_t prn;
+   int8_t elevation;   // degrees
+   uint8_t snr;        // dB-Hz, 0 when not tracking
+   uint16_t azimuth;   // degrees from true north
+   bool used;          // listed in a GSA sentence
+};
+
+struct TinyGPSSatelliteId
+{
+   uint8_t system;
+   uint8_t prn;
+};
+
+struct TinyGPSSatellites
+{
+   friend class TinyGPSPlus;
+public:
+   bool isValid() const    { return valid; }
+   bool isUpdated() const  { return updated; }
+   uint32_t age() const    { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
+
+   uint8_t count()         { updated = false; return satCount; }
+   const TinyGPSSatellite &operator[](uint8_t i) const { return sats[i]; }
+   uint8_t usedCount() const { return usedSatCount; }
+   const TinyGPSSatelliteId &used(uint8_t i) const { return usedSats[i]; }
+
+   TinyGPSSatellites() : valid(false), updated(false), satCount(0), usedSatCount(0),
+      newSystem(0), newCount(0), newExpected(0), newMsg(0), newTotal(0), newPrnTerm(0),
+      newUsedSystem(0), newUsedCount(0)
+   {}
+
+private:
+   bool valid, updated;
+   uint32_t lastCommitTime;
+   uint8_t satCount, usedSatCount;
+   TinyGPSSatellite sats[_GPS_MAX_SATELLITES];
+   TinyGPSSatelliteId usedSats[_GPS_MAX_SATELLITES];
+
+   // GSV group being received, committed when its last message passes
+   uint8_t newSystem, newCount, newExpected, newMsg, newTotal, newPrnTerm;
+   TinyGPSSatellite newSats[_GPS_MAX_SATELLITES];
+
+   // GSA sentence being received
+   uint8_t newUsedSystem, newUsedCount;
+   uint8_t newUsed[_GPS_MAX_USED_SATELLITES];
+
+   void setViewTerm(uint8_t termNumber, const char *term, uint8_t system);
+   void endView(uint8_t termCount, bool passed);
+   void commitView();
+   void addUsed(const char *term);
+   void commitUsed();
+   void markUsed();
+};
+
+// Everything known about one epoch, taken together so the values agree.
+// Plain data: safe to copy with memcpy and to hand to another task.
+struct TinyGPSFix
+{
+   uint32_t date;        // ddmmyy
+   uint32_t time;        // hhmmsscc, UTC
+   int32_t latE7;        // degrees * 1e7, south is negative
+   int32_t lngE7;        // degrees * 1e7, west is negative
+   int32_t altitude;     // 1/100 meter above mean sea level
+   int32_t speed;        // 1/100 knot
+   int32_t course;       // 1/100 degree
+   int32_t hdop;         // 1/100
+   uint32_t satellites;
+   bool hasFix;          // position, altitude, speed and course are current
+   uint32_t commitTime;  // millis() when the epoch was complete
+
+   uint32_t age() const  { return millis() - commitTime; }
+   double lat() const    { return latE7 / 1e7; }
+   double lng() const    { return lngE7 / 1e7; }
+   uint16_t year() const { return date % 100 + 2000; }
+   uint8_t month() const { return (date / 100) % 100; }
+   uint8_t day() const   { return date / 10000; }
+   uint8_t hour() const  { return time / 1000000; }
+   uint8_t minute() const { return (time / 10000) % 100; }
+   uint8_t second() const { return (time / 100) % 100; }
+   double meters() const { return altitude / 100.0; }
+   double kmph() const   { return _GPS_KMPH_PER_KNOT * speed / 100.0; }
+   double deg() const    { return course / 100.0; }
+};
+
 class TinyGPSPlus;
 class TinyGPSCustom
 {
@@ -213,14 +319,16 @@ private:
    const char *sentenceName;
    int termNumber;
    friend class TinyGPSPlus;
-   TinyGPSCustom *next;
+   TinyGPSCustom *next;      // next listener of the same sentence, by term number
+   TinyGPSCustom *nextGroup; // first listener of the next sentence in the bucket
 };
 
 class TinyGPSPlus
 {
 public:
   TinyGPSPlus();
-  bool encode(char c); // process one character received from GPS
+  bool encode(char c); // process one character received from GPS, NMEA or UBX
+  size_t encode(const char *buf, size_t len); // process a block, returns sentences that passed checksum
   TinyGPSPlus &operator << (char c) {encode(c); return *this;}
 
   TinyGPSLocation location;
@@ -230,7 +338,10 @@ public:
   TinyGPSCourse course;
   TinyGPSAltitude altitude;
   TinyGPSInteger satellites;
-  TinyGPSHDOP hdop;
+  TinyGPSHDOP hdop; // pDOP after a NAV-PVT, which has no HDOP
+  TinyGPSDecimal pdop;
+  TinyGPSDecimal vdop;
+  TinyGPSSatellites satsInView;
 
   static const char *libraryVersion() { return _GPS_VERSION; }
 
@@ -238,6 +349,14 @@ public:
   static double courseTo(double lat1, double long1, double lat2, double long2);
   static const char *cardinal(double course);
 
+  // Single precision versions on 1e-7 degree fixed point, for FPUs without
+  // double support. Legs under _GPS_SHORT_LEG_E7 use a local flat-earth
+  // approximation, longer ones a float haversine on the same sphere.
+  static int32_t degreesE7(const RawDegrees &deg);
+  static float distanceBetweenE7(int32_t lat1, int32_t long1, int32_t lat2, int32_t long2);
+  static float courseToE7(int32_t lat1, int32_t long1, int32_t lat2, int32_t long2);
+  static void destinationE7(int32_t lat1, int32_t long1, float course, float meters, int32_t &lat2, int32_t &long2);
+
   static int32_t parseDecimal(const char *term);
   static void parseDegrees(const char *term, RawDegrees &deg);
 
@@ -246,23 +365,50 @@ public:
   uint32_t failedChecksum()   const { return failedChecksumCount; }
   uint32_t passedChecksum()   const { return passedChecksumCount; }
 
+  // Copies the latest complete epoch (RMC and GGA with the same UTC time, or
+  // one NAV-PVT) without locking, so it may be called from another core or
+  // task while encode() runs; not from an interrupt that preempts encode().
+  // Returns the epoch's sequence number, 0 if none has been completed yet.
+  uint32_t readFix(TinyGPSFix &fix) const;
+
 private:
-  enum {GPS_SENTENCE_GPGGA, GPS_SENTENCE_GPRMC, GPS_SENTENCE_OTHER};
+  enum {GPS_SENTENCE_GGA, GPS_SENTENCE_RMC, GPS_SENTENCE_GSV, GPS_SENTENCE_GSA, GPS_SENTENCE_OTHER};
 
   // parsing state variables
   uint8_t parity;
   bool isChecksumTerm;
   char term[_GPS_MAX_FIELD_SIZE];
   uint8_t curSentenceType;
+  uint8_t curSystem;
   uint8_t curTermNumber;
   uint8_t curTermOffset;
   bool sentenceHasFix;
 
   // custom element support
   friend class TinyGPSCustom;
-  TinyGPSCustom *customElts;
-  TinyGPSCustom *customCandidates;
+  TinyGPSCustom *customBuckets[_GPS_CUSTOM_BUCKETS];
+  TinyGPSCustom *customCandidates; // listeners of the current sentence
+  TinyGPSCustom *customCursor;     // next listener the term number will reach
   void insertCustom(TinyGPSCustom *pElt, const char *sentenceName, int index);
+  static uint8_t customBucket(const char *sentenceName);
+
+  // UBX binary protocol, detected by its sync characters
+  enum {UBX_IDLE, UBX_SYNC2, UBX_CLASS, UBX_ID, UBX_LENGTH1, UBX_LENGTH2, UBX_PAYLOAD, UBX_CK_A, UBX_CK_B};
+  uint8_t ubxState;
+  uint8_t ubxClass, ubxId;
+  uint16_t ubxLength, ubxOffset;
+  uint8_t ubxCkA, ubxCkB, ubxRxCkA;
+  uint8_t ubxPayload[_GPS_UBX_MAX_PAYLOAD];
+
+  // epoch snapshot, published under a sequence counter that is odd while writing
+  volatile uint32_t fixSeq;
+  TinyGPSFix fix;
+  TinyGPSFix pendingFix;
+  uint32_t pendingTime;
+  uint8_t pendingParts;
+  bool pendingHasFix;
+  void stageFix();
+  void publishFix();
 
   // statistics
   uint32_t encodedCharCount;
@@ -273,6 +419,9 @@ private:
   // internal utilities
   int fromHex(char a);
   bool endOfTermHandler();
+  bool encodeUbx(uint8_t c);
+  bool endOfUbxFrame(uint8_t ckB);
+  void decodeNavPvt();
 };
 
 #endif // def(__TinyGPSPlus_h)
@@ -0,0 +1,116 @@
+#include "CaptureRecorder.h"
+
+CaptureRecorder::CaptureRecorder()
+    : used(0), started(0), msPerKByte(0), gap(false), captured(0), frameCount(0), dropped(0)
+{
+}
+
+bool CaptureRecorder::begin(fs::FS &fs, uint32_t baud)
+{
+  char name[16];
+  unsigned i;
+  for (i = 0; i < 10000; i++)
+  {
+    snprintf(name, sizeof(name), "/cap%04u.gcap", i);
+    if (!fs.exists(name))
+      break;
+  }
+
+  log.setPreallocation(CAPTURE_PREALLOC, offsetof(CaptureHeader, length));
+  if (i == 10000 || !log.begin() || !log.open(fs, name))
+    return false;
+
+  // 10 bits a byte with start and stop bits
+  msPerKByte = baud ? 10240000 / baud : 0;
+
+  // Whole blocks, the capture is big and nobody reads it before the end
+  log.setFlushPolicy(LOG_FLUSH_MS, LOG_BUFFER_SIZE);
+
+  CaptureHeader header;
+  captureInitHeader(header, baud);
+  log.write((const uint8_t *)&header, sizeof(header));
+
+  return true;
+}
+
+void CaptureRecorder::end()
+{
+  closeFrame();
+  log.close();
+}
+
+void CaptureRecorder::write(const uint8_t *data, size_t len)
+{
+  if (!log.isOpen())
+    return;
+
+  if (late(len))
+    closeFrame();
+
+  while (len > 0)
+  {
+    if (used == 0)
+      started = millis();
+
+    size_t n = CAPTURE_FRAME_SIZE - used;
+    if (n > len)
+      n = len;
+
+    memcpy(frame + sizeof(CaptureFrame) + used, data, n);
+    used += n;
+    data += n;
+    len -= n;
+
+    if (used == CAPTURE_FRAME_SIZE)
+      closeFrame();
+  }
+}
+
+void CaptureRecorder::poll()
+{
+  if (late(0))
+    closeFrame();
+
+  log.poll();
+}
+
+/*
+  True if len more bytes now would be further behind the frame's first
+  byte than the line rate explains, i.e. the receiver paused in between.
+*/
+bool CaptureRecorder::late(size_t len) const
+{
+  if (used == 0)
+    return false;
+
+  uint32_t lineMs = (uint32_t)((used + len) * msPerKByte / 1024);
+  return millis() - started > lineMs + CAPTURE_FRAME_MS;
+}
+
+void CaptureRecorder::closeFrame()
+{
+  if (used == 0)
+    return;
+
+  CaptureFrame header;
+  header.sync = CAPTURE_SYNC;
+  header.flags = gap ? CAPTURE_FLAG_GAP : 0;
+  header.length = used;
+  header.millis = started;
+  memcpy(frame, &header, sizeof(header));
+
+  // A frame the writer has no room for is a gap in the capture
+  if (log.write(frame, sizeof(header) + used) > 0)
+  {
+    captured += used;
+    frameCount++;
+    gap = false;
+  }
+  else
+  {
+    dropped++;
+    gap = true;
+  }
+
+  used = 0;
+}
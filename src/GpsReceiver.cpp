@@ -0,0 +1,141 @@
+#include "GpsReceiver.h"
+
+#if !defined(ESP32) && !defined(ARDUINO)
+#include <unistd.h>
+#endif
+
+// Bytes moved from the UART per pass of the producer
+#define CHUNK_SIZE 128
+
+GpsReceiver::GpsReceiver()
+    : backpressure(false), received(0), dropped(0), overflowCount(0), maxFill(0)
+{
+}
+
+size_t GpsReceiver::read(char *buf, size_t len)
+{
+#if !defined(ESP32) && defined(ARDUINO)
+  poll();
+#endif
+  return ring.read((uint8_t *)buf, len);
+}
+
+void GpsReceiver::store(const uint8_t *data, size_t len)
+{
+  size_t stored = ring.write(data, len);
+
+  received += len;
+  if (stored < len)
+  {
+    // The consumer fell behind, the newest bytes are lost
+    dropped += len - stored;
+    overflowCount++;
+  }
+
+  uint32_t fill = ring.available();
+  if (fill > maxFill)
+    maxFill = fill;
+}
+
+#if defined(ESP32)
+
+bool GpsReceiver::begin(Stream &source, int core, uint32_t stack)
+{
+  this->source = &source;
+
+  return xTaskCreatePinnedToCore(task, "gps", stack, this,
+                                 GPS_TASK_PRIORITY, &handle, core) == pdPASS;
+}
+
+void GpsReceiver::task(void *arg)
+{
+  GpsReceiver *self = (GpsReceiver *)arg;
+  uint8_t chunk[CHUNK_SIZE];
+
+  for (;;)
+  {
+    int avail = self->source->available();
+    size_t n = avail <= 0 ? 0 : avail < CHUNK_SIZE ? avail : CHUNK_SIZE;
+    if (self->backpressure)
+    {
+      size_t space = self->ring.capacity() - self->ring.available();
+      if (n > space)
+        n = space;
+    }
+
+    if (n == 0)
+    {
+      // One tick is about 11 bytes at 115200 baud, well inside the FIFO
+      vTaskDelay(1);
+      continue;
+    }
+
+    n = self->source->readBytes(chunk, n);
+    self->store(chunk, n);
+  }
+}
+
+#elif defined(ARDUINO)
+
+bool GpsReceiver::begin(Stream &source)
+{
+  this->source = &source;
+
+  return true;
+}
+
+void GpsReceiver::poll()
+{
+  uint8_t chunk[CHUNK_SIZE];
+
+  for (;;)
+  {
+    int avail = source->available();
+    size_t space = ring.capacity() - ring.available();
+    size_t n = avail < CHUNK_SIZE ? avail : CHUNK_SIZE;
+    if (n > space)
+      n = space;
+    if (n == 0)
+      break;
+
+    n = source->readBytes(chunk, n);
+    store(chunk, n);
+  }
+}
+
+#else
+
+bool GpsReceiver::begin(int fd)
+{
+  this->fd = fd;
+  thread = std::thread(&GpsReceiver::run, this);
+
+  return true;
+}
+
+void GpsReceiver::end()
+{
+  if (thread.joinable())
+    thread.join();
+}
+
+void GpsReceiver::run()
+{
+  uint8_t chunk[CHUNK_SIZE];
+  ssize_t n;
+
+  for (;;)
+  {
+    if (backpressure && ring.capacity() - ring.available() < sizeof(chunk))
+    {
+      usleep(1000);
+      continue;
+    }
+
+    if ((n = ::read(fd, chunk, sizeof(chunk))) <= 0)
+      break;
+    store(chunk, n);
+  }
+}
+
+#endif
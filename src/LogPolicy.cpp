@@ -0,0 +1,205 @@
+#include "LogPolicy.h"
+
+#include <math.h>
+
+// Meters per 1e-7 degree of latitude, on the sphere TinyGPS++ uses
+#define METERS_PER_E7 0.0111226f
+#define RAD_PER_E7 1.74532925e-9f
+
+static float cosE7(int32_t lat)
+{
+  return cosf(lat * RAD_PER_E7);
+}
+
+// Longitude difference folded into -180..180 degrees
+static int32_t deltaLongE7(int32_t from, int32_t to)
+{
+  int64_t d = (int64_t)to - from;
+  if (d > 1800000000LL)
+    d -= 3600000000LL;
+  else if (d < -1800000000LL)
+    d += 3600000000LL;
+  return (int32_t)d;
+}
+
+static float squareE7(uint32_t meters)
+{
+  float e7 = meters / METERS_PER_E7;
+  return e7 * e7;
+}
+
+bool LogPolicy::log(TrackRecord &rec)
+{
+  fixCount++;
+  last = decide(rec);
+  if (last == REASON_NONE)
+    return false;
+
+  loggedCount++;
+  reasons[last]++;
+  return true;
+}
+
+LogPolicy::Reason EveryFixPolicy::decide(TrackRecord &)
+{
+  if (first)
+  {
+    first = false;
+    return REASON_FIRST;
+  }
+  return REASON_INTERVAL;
+}
+
+LogPolicy::Reason IntervalPolicy::decide(TrackRecord &rec)
+{
+  Reason reason = REASON_NONE;
+  if (first)
+    reason = REASON_FIRST;
+  else if (rec.time < lastTime)
+    reason = REASON_FIX;
+  else if (rec.time - lastTime >= interval)
+    reason = REASON_INTERVAL;
+
+  if (reason != REASON_NONE)
+  {
+    first = false;
+    lastTime = rec.time;
+  }
+  return reason;
+}
+
+AdaptivePolicy::AdaptivePolicy()
+{
+  Thresholds t;
+  t.distanceM = POLICY_DISTANCE_M;
+  t.headingCdeg = POLICY_HEADING_CDEG;
+  t.speedCkn = POLICY_SPEED_CKN;
+  t.maxIntervalMs = POLICY_MAX_INTERVAL_MS;
+  t.stopSpeedCkn = POLICY_STOP_SPEED_CKN;
+  t.moveSpeedCkn = POLICY_MOVE_SPEED_CKN;
+  t.stopRadiusM = POLICY_STOP_RADIUS_M;
+  t.stopMs = POLICY_STOP_MS;
+  t.stopIntervalMs = POLICY_STOP_INTERVAL_MS;
+  setThresholds(t);
+  reset();
+}
+
+AdaptivePolicy::AdaptivePolicy(const Thresholds &thresholds)
+{
+  setThresholds(thresholds);
+  reset();
+}
+
+void AdaptivePolicy::setThresholds(const Thresholds &t)
+{
+  limits = t;
+  distanceSqE7 = squareE7(t.distanceM);
+  stopRadiusSqE7 = squareE7(t.stopRadiusM);
+}
+
+void AdaptivePolicy::reset()
+{
+  first = true;
+  isStopped = false;
+  slow = false;
+}
+
+// Squared flat-earth distance in 1e-7 degrees of latitude
+float AdaptivePolicy::distanceSq(const TrackRecord &rec, int32_t lat, int32_t lng,
+                                 float cosLat) const
+{
+  float dy = (float)((int64_t)rec.latE7 - lat);
+  float dx = deltaLongE7(lng, rec.lngE7) * cosLat;
+  return dx * dx + dy * dy;
+}
+
+void AdaptivePolicy::anchor(const TrackRecord &rec)
+{
+  prev = rec;
+  prevCos = cosE7(rec.latE7);
+}
+
+LogPolicy::Reason AdaptivePolicy::decide(TrackRecord &rec)
+{
+  bool fix = rec.flags & TRACK_FLAG_FIX;
+
+  if (first || fix != (bool)(prev.flags & TRACK_FLAG_FIX) || rec.time < prev.time)
+  {
+    Reason reason = first ? REASON_FIRST : REASON_FIX;
+    first = false;
+    isStopped = slow = false;
+    anchor(rec);
+    return reason;
+  }
+
+  int64_t age = rec.time - prev.time;
+
+  // Without a fix only the time means anything
+  if (!fix)
+  {
+    if (age < limits.maxIntervalMs)
+      return REASON_NONE;
+    anchor(rec);
+    return REASON_INTERVAL;
+  }
+
+  if (isStopped)
+  {
+    if (rec.speed > limits.moveSpeedCkn ||
+        distanceSq(rec, stopLat, stopLng, stopCos) > stopRadiusSqE7)
+    {
+      isStopped = slow = false;
+      anchor(rec);
+      return REASON_MOVE;
+    }
+
+    if (age < limits.stopIntervalMs)
+      return REASON_NONE;
+    rec.flags |= TRACK_FLAG_STOPPED;
+    anchor(rec);
+    return REASON_INTERVAL;
+  }
+
+  // A stop is a slow spell that stays within the radius of where it began
+  if (rec.speed >= limits.stopSpeedCkn)
+  {
+    slow = false;
+  }
+  else if (!slow || distanceSq(rec, stopLat, stopLng, stopCos) > stopRadiusSqE7)
+  {
+    slow = true;
+    slowSince = rec.time;
+    stopLat = rec.latE7;
+    stopLng = rec.lngE7;
+    stopCos = cosE7(rec.latE7);
+  }
+  else if (rec.time - slowSince >= limits.stopMs)
+  {
+    isStopped = true;
+    rec.flags |= TRACK_FLAG_STOPPED;
+    anchor(rec);
+    return REASON_STOP;
+  }
+
+  Reason reason = REASON_NONE;
+  int32_t turn = (int32_t)rec.course - prev.course;
+  if (turn < 0)
+    turn = -turn;
+  if (turn > 18000)
+    turn = 36000 - turn;
+  int32_t accel = (int32_t)rec.speed - prev.speed;
+
+  if (distanceSq(rec, prev.latE7, prev.lngE7, prevCos) >= distanceSqE7)
+    reason = REASON_DISTANCE;
+  else if (rec.speed >= limits.moveSpeedCkn && turn >= limits.headingCdeg)
+    reason = REASON_HEADING;
+  else if (accel >= limits.speedCkn || -accel >= limits.speedCkn)
+    reason = REASON_SPEED;
+  else if (age >= limits.maxIntervalMs)
+    reason = REASON_INTERVAL;
+  else
+    return REASON_NONE;
+
+  anchor(rec);
+  return reason;
+}
@@ -0,0 +1,616 @@
+#include "LogWriter.h"
+
+#if defined(ESP32)
+#include <unistd.h>
+#endif
+
+// What a preallocated file is filled with ahead of the data
+static const uint8_t zeros[LOG_BUFFER_SIZE] = {};
+
+LogWriter::LogWriter()
+    : fill(0), next(0), used(0), position(0), oldest(0), synced(0), markPending(false), markKey(0),
+      maxAge(LOG_FLUSH_MS), maxBytes(LOG_FLUSH_BYTES), prealloc(0), lengthOffset(0), reserved(0),
+      recovered(0), journal(false), journalStart(0), frameOpen(false), frameAt(0), sequence(0),
+      torn(0), failed(false), dropped(0), written(0), lost(0), writeCount(0), flushCount(0),
+      maxMicros(0), indexed(0), reservedBytes(0), reserveTime(0)
+{
+  volume = NULL;
+  name[0] = 0;
+  for (int i = 0; i < LOG_LATENCY_BUCKETS; i++)
+    histogram[i] = 0;
+  for (int i = 0; i < 2; i++)
+  {
+    blocks[i].len = 0;
+    blocks[i].markCount = 0;
+    blocks[i].sync = false;
+    blocks[i].queued = false;
+  }
+#if defined(ESP32)
+  handle = NULL;
+#else
+  stopping = false;
+#endif
+}
+
+#if defined(ESP32)
+
+bool LogWriter::begin(int core)
+{
+  if (handle)
+    return true;
+
+  return xTaskCreatePinnedToCore(task, "log", LOG_TASK_STACK, this, LOG_TASK_PRIORITY,
+                                 &handle, core) == pdPASS;
+}
+
+void LogWriter::task(void *arg)
+{
+  LogWriter *self = (LogWriter *)arg;
+
+  for (;;)
+  {
+    self->service();
+    vTaskDelay(pdMS_TO_TICKS(LOG_POLL_MS) ? pdMS_TO_TICKS(LOG_POLL_MS) : 1);
+  }
+}
+
+#else
+
+LogWriter::~LogWriter()
+{
+  stopping = true;
+  if (thread.joinable())
+    thread.join();
+}
+
+bool LogWriter::begin(int core)
+{
+  (void)core;
+  if (!thread.joinable())
+    thread = std::thread(&LogWriter::run, this);
+
+  return true;
+}
+
+void LogWriter::run()
+{
+  while (!stopping)
+  {
+    service();
+
+    // On the simulated clock too, so the writer keeps pace with the loop
+    delay(LOG_POLL_MS);
+  }
+}
+
+#endif
+
+bool LogWriter::open(fs::FS &fs, const char *path, const char *indexPath)
+{
+  checkFailed();
+  if (file && !strcmp(name, path))
+    return true;
+
+  close();
+
+  if (prealloc)
+  {
+    // Written in place, so an existing file must not be truncated by opening it
+    if (!fs.exists(path))
+    {
+      File created = fs.open(path, FILE_WRITE);
+      if (!created)
+        return false;
+      created.close();
+    }
+    file = fs.open(path, "r+");
+  }
+  else
+    file = fs.open(path, FILE_APPEND);
+  if (!file)
+    return false;
+
+  // Appending may start part way into a sector, the first write realigns
+  reserved = file.size();
+  recovered = torn = 0;
+  sequence = 0;
+  frameOpen = false;
+  position = prealloc ? findEnd() : reserved;
+
+  // An appended journal goes on after any torn bytes, readers skip them
+  if (journal && !prealloc && position > journalStart)
+    torn = position - findFrames(position, position);
+  volume = &fs;
+  strncpy(name, path, sizeof(name) - 1);
+  name[sizeof(name) - 1] = 0;
+
+  // The log is still usable without its index, a reader then scans it
+  if (indexPath)
+  {
+    index = fs.open(indexPath, FILE_APPEND);
+    if (index && index.size() == 0)
+    {
+      LogIndexHeader header;
+      logIndexInitHeader(header);
+      if (index.write((const uint8_t *)&header, sizeof(header)) != sizeof(header))
+        index.close();
+    }
+  }
+
+  return true;
+}
+
+void LogWriter::close()
+{
+  checkFailed();
+  if (!file)
+    return;
+
+  flush();
+  drain();
+  checkFailed();
+
+  file.close();
+  if (index)
+    index.close();
+
+  // Give back what was reserved and not used
+  if (prealloc && reserved > position)
+  {
+#if defined(ESP32)
+    // The Arduino FS cannot truncate, the VFS under it can
+    char full[sizeof(name) + sizeof(LOG_MOUNT_POINT)];
+    snprintf(full, sizeof(full), "%s%s", LOG_MOUNT_POINT, name);
+    truncate(full, position);
+#else
+    volume->truncate(name, position);
+#endif
+  }
+
+  name[0] = 0;
+}
+
+void LogWriter::setJournal(uint32_t start)
+{
+  journal = true;
+  journalStart = start;
+}
+
+void LogWriter::setPreallocation(uint32_t bytes, uint32_t lengthOffset)
+{
+  prealloc = (bytes + LOG_BUFFER_SIZE - 1) / LOG_BUFFER_SIZE * LOG_BUFFER_SIZE;
+  this->lengthOffset = lengthOffset;
+}
+
+/*
+  The logical end of a file opened for writing in place: the length in
+  its header, or the last byte that is not zero in the run of sectors
+  that are not all zeros from there. A header that was never written
+  reads as 0, so a file that is all data, e.g. one written before
+  preallocation, is scanned to its end.
+*/
+uint32_t LogWriter::findEnd()
+{
+  uint32_t size = reserved;
+  uint32_t length = 0;
+  if (size >= lengthOffset + sizeof(length))
+  {
+    file.seek(lengthOffset);
+    file.read((uint8_t *)&length, sizeof(length));
+  }
+  if (length > size)
+    length = 0;
+
+  // Nothing is queued while a file is being opened, so a block is free to read into
+  uint8_t *buf = blocks[fill].data;
+  uint32_t end = length;
+  uint32_t pos = length / LOG_SECTOR_SIZE * LOG_SECTOR_SIZE;
+  bool more = true;
+
+  file.seek(pos);
+  while (more && pos < size)
+  {
+    size_t n = file.read(buf, LOG_BUFFER_SIZE);
+    if (n == 0)
+      break;
+
+    for (size_t s = 0; s < n; s += LOG_SECTOR_SIZE)
+    {
+      size_t last = s + LOG_SECTOR_SIZE < n ? s + LOG_SECTOR_SIZE : n;
+      while (last > s && buf[last - 1] == 0)
+        last--;
+
+      if (last == s && pos + s >= length)
+      {
+        more = false;
+        break;
+      }
+      if (pos + last > end)
+        end = pos + last;
+    }
+    pos += n;
+  }
+
+  // Of what is there, only whole frames count
+  uint32_t data = end;
+  if (journal && end > journalStart)
+  {
+    end = findFrames(length > journalStart ? length : journalStart, end);
+    torn = data - end;
+  }
+
+  recovered = length > 0 && end > length ? end - length : 0;
+  return end;
+}
+
+/*
+  The end of the good frames of a journal, from tail, the flushed length,
+  up to limit, and the sequence number to go on with. A frame is written
+  from one block, so the last good one before tail starts within two
+  blocks of it; that stretch is read back a block at a time looking for
+  a header. A file with data but no frame there was written without a
+  journal and is taken to end at limit.
+*/
+uint32_t LogWriter::findFrames(uint32_t tail, uint32_t limit)
+{
+  uint8_t *buf = blocks[fill].data;
+  const uint32_t size = sizeof(blocks[fill].data);
+  uint32_t first = tail > journalStart + 2 * size ? tail - 2 * size : journalStart;
+  uint32_t end = journalStart;
+  LogFrameHeader h;
+
+  for (uint32_t to = tail; end == journalStart && to >= first + sizeof(h);)
+  {
+    uint32_t from = to - first > size ? to - size : first;
+    file.seek(from);
+    size_t n = file.read(buf, to - from);
+    for (size_t p = n >= sizeof(h) ? n - sizeof(h) + 1 : 0; p-- > 0;)
+    {
+      memcpy(&h, buf + p, sizeof(h));
+      if (buf[p] == (LOG_FRAME_SYNC & 0xFF) && logFrameCheckHeader(h) &&
+          from + p + sizeof(h) + h.length <= tail && readFrame(from + p, h))
+      {
+        end = from + p + sizeof(h) + h.length;
+        sequence = h.sequence + 1;
+        break;
+      }
+    }
+
+    // The next block back overlaps this one by a header less a byte
+    to = from + sizeof(h) - 1;
+  }
+
+  if (end == journalStart && tail > journalStart)
+    return limit;
+
+  // Frames written after the last flush
+  while (end + sizeof(h) < limit && readFrame(end, h) && h.sequence == sequence)
+  {
+    end += sizeof(h) + h.length;
+    sequence++;
+  }
+
+  return end;
+}
+
+// Reads the frame at pos whole into the block not being filled, true if it checks
+bool LogWriter::readFrame(uint32_t pos, LogFrameHeader &h)
+{
+  uint8_t *buf = blocks[fill ^ 1].data;
+
+  file.seek(pos);
+  if (file.read(buf, sizeof(h)) != sizeof(h))
+    return false;
+  memcpy(&h, buf, sizeof(h));
+
+  return logFrameCheckHeader(h) && sizeof(h) + h.length <= sizeof(blocks[0].data) &&
+         file.read(buf + sizeof(h), h.length) == h.length && logFrameCheck(buf, sizeof(h) + h.length);
+}
+
+void LogWriter::setFlushPolicy(uint32_t maxAgeMs, size_t maxBytes)
+{
+  maxAge = maxAgeMs;
+  this->maxBytes = maxBytes < LOG_SECTOR_SIZE ? LOG_SECTOR_SIZE
+                   : maxBytes > LOG_BUFFER_SIZE ? LOG_BUFFER_SIZE
+                                                : maxBytes;
+}
+
+void LogWriter::mark(int64_t key)
+{
+  markPending = true;
+  markKey = key;
+}
+
+size_t LogWriter::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t LogWriter::write(const uint8_t *data, size_t len)
+{
+  checkFailed();
+  bool marked = markPending;
+  markPending = false;
+
+  if (!file)
+  {
+    lost += len;
+    return 0;
+  }
+
+  // Data past the format's header starts a frame if there is none to add to
+  size_t header = journal && !frameOpen && position + used >= journalStart ? sizeof(LogFrameHeader) : 0;
+  if (used + header + len > LOG_BUFFER_SIZE)
+  {
+    writeSectors();
+    header = journal && !frameOpen && position + used >= journalStart ? sizeof(LogFrameHeader) : 0;
+  }
+
+  // The writer still has the other block
+  if (used + header + len > LOG_BUFFER_SIZE)
+  {
+    dropped++;
+    lost += len;
+    return 0;
+  }
+
+  if (used == 0 && len > 0)
+    oldest = millis();
+
+  if (header > 0 && len > 0)
+  {
+    frameAt = used;
+    frameOpen = true;
+    used += header;
+  }
+
+  Block &block = blocks[fill];
+  if (marked && index && block.markCount < LOG_INDEX_MARKS)
+  {
+    LogIndexEntry &entry = block.marks[block.markCount++];
+    entry.key = markKey;
+    entry.offset = position + used;
+  }
+
+  memcpy(block.data + used, data, len);
+  used += len;
+
+  if (used >= maxBytes)
+    writeSectors();
+
+  return len;
+}
+
+void LogWriter::poll()
+{
+  checkFailed();
+  if (used > 0 && millis() - oldest >= maxAge)
+    handOver(used, true);
+}
+
+void LogWriter::flush()
+{
+  if (!file)
+    return;
+
+  while (!handOver(used, true))
+    delay(1);
+}
+
+void LogWriter::drain()
+{
+  while (blocks[0].queued.load(std::memory_order_acquire) ||
+         blocks[1].queued.load(std::memory_order_acquire))
+    delay(1);
+}
+
+uint32_t LogWriter::queuedBytes() const
+{
+  const Block &other = blocks[fill ^ 1];
+  return used + (other.queued.load(std::memory_order_acquire) ? other.len : 0);
+}
+
+/*
+  Queues the first len bytes of the block being filled and moves the rest
+  to the other block, which becomes the one being filled. Fails if the
+  writer has not finished with the other block yet.
+*/
+bool LogWriter::handOver(size_t len, bool sync)
+{
+  Block &full = blocks[fill];
+  Block &empty = blocks[fill ^ 1];
+  if (empty.queued.load(std::memory_order_acquire))
+    return false;
+
+  // A frame cut short here goes on in a frame of its own in the other block
+  bool framed = frameOpen && frameAt < len;
+  bool split = framed && used > len;
+  size_t header = split ? sizeof(LogFrameHeader) : 0;
+
+  memcpy(empty.data + header, full.data + len, used - len);
+  full.offset = position;
+  full.frameAt = framed ? frameAt : len;
+  if (framed)
+    full.sequence = sequence++;
+
+  // Entries for the records that moved go with them
+  size_t kept = 0;
+  empty.markCount = 0;
+  for (size_t i = 0; i < full.markCount; i++)
+  {
+    if (full.marks[i].offset < position + len)
+      full.marks[kept++] = full.marks[i];
+    else
+    {
+      // Behind the header of the frame they now start in
+      empty.marks[empty.markCount] = full.marks[i];
+      empty.marks[empty.markCount].offset += header;
+      empty.markCount++;
+    }
+  }
+  full.markCount = kept;
+
+  full.len = len;
+  full.sync = sync;
+  if (sync)
+    synced = millis();
+  full.queued.store(true, std::memory_order_release);
+
+  fill ^= 1;
+  position += len;
+  used = used - len + header;
+
+  if (framed)
+  {
+    frameOpen = split;
+    frameAt = 0;
+  }
+  else if (frameOpen)
+    frameAt -= len;
+
+  // What is left is the start of the latest record, give it a full period
+  if (used > 0)
+    oldest = millis();
+
+  return true;
+}
+
+// Queues the buffered bytes up to the last sector boundary of the file
+void LogWriter::writeSectors()
+{
+  size_t end = (position + used) / LOG_SECTOR_SIZE * LOG_SECTOR_SIZE;
+
+  // Nor does a frame end inside its header or right after it
+  if (frameOpen && end > position + frameAt && end <= position + frameAt + sizeof(LogFrameHeader))
+    end = position + frameAt;
+
+  if (end > position)
+    handOver(end - position, millis() - synced >= maxAge);
+}
+
+// After a failed write, waits out the writer and closes the file
+void LogWriter::checkFailed()
+{
+  if (!failed.load(std::memory_order_acquire))
+    return;
+
+  drain();
+  lost += used;
+  used = 0;
+  frameOpen = false;
+  blocks[fill].markCount = 0;
+  file.close();
+  if (index)
+    index.close();
+  name[0] = 0;
+  failed = false;
+}
+
+// Writer side: writes every queued block, in the order they were queued
+void LogWriter::service()
+{
+  while (blocks[next].queued.load(std::memory_order_acquire))
+  {
+    // Allocate the next allowance in one go rather than cluster by cluster under the data
+    Block &block = blocks[next];
+    if (prealloc && block.offset + block.len > reserved && !failed.load(std::memory_order_relaxed))
+      reserve(block.offset + block.len + prealloc);
+
+    writeBlock(blocks[next]);
+    blocks[next].markCount = 0;
+    blocks[next].queued.store(false, std::memory_order_release);
+    next ^= 1;
+  }
+}
+
+// Writer side: zero-fills the file from its end to at least end
+void LogWriter::reserve(uint32_t end)
+{
+  uint32_t start = micros();
+
+  file.seek(reserved);
+  while (reserved < end)
+  {
+    // A card too full for the allowance still takes the data, cluster by cluster
+    if (file.write(zeros, sizeof(zeros)) != sizeof(zeros))
+      break;
+    reserved += sizeof(zeros);
+    reservedBytes += sizeof(zeros);
+  }
+  file.flush();
+
+  reserveTime += micros() - start;
+}
+
+void LogWriter::writeBlock(Block &block)
+{
+  if (failed.load(std::memory_order_relaxed))
+  {
+    lost += block.len;
+    return;
+  }
+
+  if (block.frameAt < block.len)
+  {
+    LogFrameHeader h;
+    uint8_t *data = block.data + block.frameAt + sizeof(h);
+    logFrameInit(h, block.sequence, data, block.len - block.frameAt - sizeof(h));
+    memcpy(block.data + block.frameAt, &h, sizeof(h));
+  }
+
+  uint32_t start = micros();
+  if (prealloc)
+    file.seek(block.offset);
+  size_t n = block.len > 0 ? file.write(block.data, block.len) : 0;
+  if (n == block.len && block.sync)
+  {
+    if (prealloc && lengthOffset)
+      writeLength(block.offset + block.len);
+    file.flush();
+  }
+  uint32_t elapsed = micros() - start;
+
+  if (block.len > 0)
+    writeCount++;
+  if (block.sync)
+    flushCount++;
+  if (elapsed > maxMicros)
+    maxMicros = elapsed;
+
+  int bucket = 0;
+  for (uint32_t ms = elapsed / 1000; ms > 0 && bucket < LOG_LATENCY_BUCKETS - 1; ms >>= 1)
+    bucket++;
+  histogram[bucket]++;
+
+  if (block.offset + n > reserved)
+    reserved = block.offset + n;
+
+  if (n != block.len)
+  {
+    lost += block.len;
+    failed.store(true, std::memory_order_release);
+    return;
+  }
+
+  written += block.len;
+
+  // The entries follow the bytes they point at
+  if (block.markCount > 0 && index)
+  {
+    size_t bytes = block.markCount * sizeof(LogIndexEntry);
+    if (index.write((const uint8_t *)block.marks, bytes) == bytes)
+      indexed += block.markCount;
+    if (block.sync)
+      index.flush();
+  }
+}
+
+// Writer side: stores the logical end in the file's header
+void LogWriter::writeLength(uint32_t length)
+{
+  if (length < lengthOffset + sizeof(length))
+    return;
+
+  file.seek(lengthOffset);
+  file.write((const uint8_t *)&length, sizeof(length));
+}
@@ -0,0 +1,381 @@
+#include "ReplaySource.h"
+
+ReplaySource::ReplaySource()
+    : kind(KIND_NMEA), speed(1), baud(REPLAY_NMEA_BAUD), started(0), baseMillis(0), baseMicros(0),
+      chunkLen(0), chunkPos(0), chunkStart(0), chunkEnd(0), frameLeft(0), frameNext(0),
+      frameHeaderSize(0), captureEnd(0), origin(0), haveOrigin(false), done(true), doneAt(0), replayed(0), records(0)
+{
+}
+
+bool ReplaySource::begin(fs::FS &fs, const char *path, float speed)
+{
+  end();
+
+  file = fs.open(path, FILE_READ);
+  if (!file)
+    return false;
+
+  // The header says what the file is, anything else is taken for NMEA
+  uint8_t head[sizeof(CaptureHeader)];
+  size_t n = file.read(head, sizeof(head));
+
+  CaptureHeader capture;
+  memcpy(&capture, head, n == sizeof(head) ? sizeof(capture) : 0);
+
+  if (n == sizeof(head) && captureCheckHeader(capture) && capture.baud)
+  {
+    kind = KIND_CAPTURE;
+    baud = capture.baud;
+    frameHeaderSize = capture.frameHeaderSize;
+    captureEnd = captureLength(capture, file.size());
+    file.seek(capture.headerSize);
+  }
+  else if (track.open(fs, path))
+  {
+    file.close();
+    kind = KIND_TRACK;
+    baud = REPLAY_TRACK_BAUD;
+  }
+  else
+  {
+    kind = KIND_NMEA;
+    baud = REPLAY_NMEA_BAUD;
+    file.seek(0);
+  }
+
+  chunkLen = chunkPos = 0;
+  chunkStart = chunkEnd = 0;
+  frameLeft = 0;
+  haveOrigin = false;
+  replayed = records = 0;
+  done = false;
+
+  started = baseMillis = millis();
+  baseMicros = 0;
+  this->speed = speed;
+
+  return true;
+}
+
+void ReplaySource::end()
+{
+  if (file)
+    file.close();
+  track.close();
+  done = true;
+}
+
+void ReplaySource::setSpeed(float speed)
+{
+  // From a standstill the recording picks up where the reader is
+  baseMicros = this->speed > 0 ? recordingMicros() : chunkStart;
+  baseMillis = millis();
+  this->speed = speed;
+}
+
+uint64_t ReplaySource::recordingMicros() const
+{
+  return baseMicros + (uint64_t)((millis() - baseMillis) * 1000.0 * speed);
+}
+
+// Bytes of the current chunk that are due, loading the next chunk when it is used up
+size_t ReplaySource::due()
+{
+  while (chunkPos == chunkLen)
+  {
+    if (done)
+      return 0;
+
+    if (!nextChunk())
+    {
+      doneAt = millis();
+      end();
+      return 0;
+    }
+  }
+
+  if (speed <= 0)
+    return chunkLen - chunkPos;
+
+  uint64_t now = recordingMicros();
+  if (now < chunkStart)
+    return 0;
+
+  // 8N1, ten bit times per byte
+  uint64_t arrived = (now - chunkStart) * baud / 10000000ULL + 1;
+  if (arrived > chunkLen)
+    arrived = chunkLen;
+  return arrived > chunkPos ? arrived - chunkPos : 0;
+}
+
+bool ReplaySource::nextChunk()
+{
+  bool loaded;
+  chunkPos = chunkLen = 0;
+
+  if (kind == KIND_CAPTURE)
+    loaded = nextFrame();
+  else if (kind == KIND_TRACK)
+    loaded = nextRecord();
+  else
+  {
+    chunkLen = file.read(chunk, sizeof(chunk));
+    chunkStart = chunkEnd;
+    loaded = chunkLen > 0;
+  }
+
+  if (!loaded)
+    return false;
+
+  // A stamp from before the last byte, e.g. a clock step, plays right after it
+  if (chunkStart < chunkEnd)
+    chunkStart = chunkEnd;
+  chunkEnd = chunkStart + chunkLen * 10000000ULL / baud;
+
+  return true;
+}
+
+bool ReplaySource::nextFrame()
+{
+  if (frameLeft == 0)
+  {
+    // The file may run on past the capture into preallocated zeros
+    if (file.position() + frameHeaderSize > captureEnd)
+      return false;
+
+    CaptureFrame frame;
+    if (file.read((uint8_t *)&frame, sizeof(frame)) != sizeof(frame) || frame.sync != CAPTURE_SYNC)
+      return false;
+
+    // Skip any frame header fields a later version added
+    if (frameHeaderSize > sizeof(frame))
+      file.seek(file.position() + frameHeaderSize - sizeof(frame));
+
+    // A frame cut off by the end of the capture is dropped whole
+    if (file.position() + frame.length > captureEnd)
+      return false;
+
+    if (!haveOrigin)
+    {
+      origin = frame.millis;
+      haveOrigin = true;
+    }
+
+    frameLeft = frame.length;
+    frameNext = (uint64_t)(uint32_t)(frame.millis - (uint32_t)origin) * 1000;
+  }
+
+  size_t n = frameLeft < sizeof(chunk) ? frameLeft : sizeof(chunk);
+  chunkLen = file.read(chunk, n);
+  if (chunkLen != n)
+    return false; // the last frame is torn
+
+  chunkStart = frameNext;
+  frameNext += chunkLen * 10000000ULL / baud;
+  frameLeft -= chunkLen;
+
+  return true;
+}
+
+bool ReplaySource::nextRecord()
+{
+  TrackRecord rec;
+  if (!track.next(rec))
+    return false;
+
+  if (!haveOrigin)
+  {
+    origin = rec.time;
+    haveOrigin = true;
+  }
+
+  chunkLen = formatRecord(rec);
+  chunkStart = rec.time > origin ? (uint64_t)(rec.time - origin) * 1000 : 0;
+  records++;
+
+  return true;
+}
+
+// Appends val in at least width digits
+static char *appendUint(char *out, uint32_t val, int width = 1)
+{
+  char digits[10];
+  int n = 0;
+  do
+  {
+    digits[n++] = '0' + val % 10;
+    val /= 10;
+  } while (val > 0);
+
+  while (width-- > n)
+    *out++ = '0';
+  while (n > 0)
+    *out++ = digits[--n];
+  return out;
+}
+
+// Appends val / 100 with two decimals
+static char *appendHundredths(char *out, int32_t val)
+{
+  if (val < 0)
+  {
+    *out++ = '-';
+    val = -val;
+  }
+  out = appendUint(out, val / 100);
+  *out++ = '.';
+  return appendUint(out, val % 100, 2);
+}
+
+/*
+  Appends dddmm.mmmmmm and the hemisphere. Six decimals of a minute are
+  exactly 1e-7 degree times six, so the parser gets back the same E7.
+*/
+static char *appendDegrees(char *out, int32_t e7, int degreeDigits, char positive, char negative)
+{
+  uint32_t v = e7 < 0 ? -(uint32_t)e7 : e7;
+  uint32_t micro = v % 10000000 * 6; // millionths of a minute
+
+  out = appendUint(out, v / 10000000, degreeDigits);
+  out = appendUint(out, micro / 1000000, 2);
+  *out++ = '.';
+  out = appendUint(out, micro % 1000000, 6);
+  *out++ = ',';
+  *out++ = e7 < 0 ? negative : positive;
+  return out;
+}
+
+// Closes the sentence that starts at begin with its checksum, returns the end
+static char *endSentence(char *begin, char *out)
+{
+  static const char hex[] = "0123456789ABCDEF";
+  uint8_t sum = 0;
+  for (char *p = begin + 1; p < out; p++)
+    sum ^= *p;
+
+  *out++ = '*';
+  *out++ = hex[sum >> 4];
+  *out++ = hex[sum & 15];
+  *out++ = '\r';
+  *out++ = '\n';
+  return out;
+}
+
+// An RMC and a GGA carrying what the record holds
+size_t ReplaySource::formatRecord(const TrackRecord &rec)
+{
+  char *out = (char *)chunk;
+  bool fix = rec.flags & TRACK_FLAG_FIX;
+
+  int64_t days = rec.time / 86400000;
+  int32_t ms = (int32_t)(rec.time % 86400000);
+  if (ms < 0)
+  {
+    ms += 86400000;
+    days--;
+  }
+
+  char time[16];
+  char *t = appendUint(time, ms / 3600000, 2);
+  t = appendUint(t, ms / 60000 % 60, 2);
+  t = appendUint(t, ms / 1000 % 60, 2);
+  *t++ = '.';
+  t = appendUint(t, ms / 10 % 100, 2);
+  *t = 0;
+
+  char position[32];
+  char *p = position;
+  if (fix)
+  {
+    p = appendDegrees(p, rec.latE7, 2, 'N', 'S');
+    *p++ = ',';
+    p = appendDegrees(p, rec.lngE7, 3, 'E', 'W');
+  }
+  else
+  {
+    memcpy(p, ",,,", 3);
+    p += 3;
+  }
+  *p = 0;
+
+  char *begin = out;
+  memcpy(out, "$GPRMC,", 7);
+  out += 7;
+  out = stpcpy(out, time);
+  out = stpcpy(out, fix ? ",A," : ",V,");
+  out = stpcpy(out, position);
+  *out++ = ',';
+  if (fix)
+  {
+    out = appendHundredths(out, rec.speed);
+    *out++ = ',';
+    out = appendHundredths(out, rec.course);
+  }
+  else
+    *out++ = ',';
+  *out++ = ',';
+  if (rec.flags & TRACK_FLAG_DATE)
+  {
+    int32_t y;
+    uint32_t m, d;
+    trackCivilFromDays((int32_t)days, y, m, d);
+    out = appendUint(out, d, 2);
+    out = appendUint(out, m, 2);
+    out = appendUint(out, (uint32_t)y % 100, 2);
+  }
+  out = stpcpy(out, fix ? ",,,A" : ",,,N");
+  out = endSentence(begin, out);
+
+  begin = out;
+  memcpy(out, "$GPGGA,", 7);
+  out += 7;
+  out = stpcpy(out, time);
+  *out++ = ',';
+  out = stpcpy(out, position);
+  out = stpcpy(out, fix ? ",1," : ",0,");
+  out = appendUint(out, rec.satellites, 2);
+  *out++ = ',';
+  out = appendHundredths(out, rec.hdop);
+  *out++ = ',';
+  if (fix)
+    out = appendHundredths(out, rec.altitude);
+  out = stpcpy(out, ",M,,M,,");
+  out = endSentence(begin, out);
+
+  return out - (char *)chunk;
+}
+
+int ReplaySource::available()
+{
+  return (int)due();
+}
+
+int ReplaySource::peek()
+{
+  return due() > 0 ? chunk[chunkPos] : -1;
+}
+
+int ReplaySource::read()
+{
+  if (due() == 0)
+    return -1;
+
+  replayed++;
+  return chunk[chunkPos++];
+}
+
+size_t ReplaySource::readBytes(char *buffer, size_t length)
+{
+  size_t n = 0;
+  size_t avail;
+  while (n < length && (avail = due()) > 0)
+  {
+    size_t take = length - n < avail ? length - n : avail;
+    memcpy(buffer + n, chunk + chunkPos, take);
+    chunkPos += take;
+    n += take;
+  }
+
+  replayed += n;
+  return n;
+}
@@ -0,0 +1,151 @@
+#include "StatusScreen.h"
+
+// CASET + 4 bytes, PASET + 4 bytes and RAMWR
+#define WINDOW_BYTES 11
+
+// Bytes sent for one GLCD glyph drawn with an opaque background, the 6 x 8
+// cell is scaled up and streamed through a single window
+static uint32_t glyphBytes(uint8_t size)
+{
+  return WINDOW_BYTES + 6 * 8 * size * size * 2;
+}
+
+StatusScreen::StatusScreen(TFT_eSPI &tft, uint16_t bgcolor)
+    : tft(&tft), bgcolor(bgcolor), fieldCount(0), labelsDrawn(false),
+      lastBytes(0), totalBytes(0), lastFields(0)
+{
+}
+
+void StatusScreen::setDisplay(TFT_eSPI &tft)
+{
+  this->tft = &tft;
+  invalidate();
+}
+
+int8_t StatusScreen::addField(const char *label, int16_t x, int16_t y, uint8_t width,
+                              uint8_t size, uint16_t color)
+{
+  if (fieldCount >= STATUS_MAX_FIELDS)
+    return -1;
+
+  Field &f = fields[fieldCount];
+  f.label = label;
+  f.x = x;
+  f.y = y;
+  f.width = width > STATUS_MAX_CHARS ? STATUS_MAX_CHARS : width;
+  f.size = size;
+  f.color = color;
+  f.dirty = false;
+  f.value[0] = 0;
+  f.shown[0] = 0;
+
+  labelsDrawn = false;
+
+  return fieldCount++;
+}
+
+void StatusScreen::setValue(uint8_t field, const char *value)
+{
+  if (field >= fieldCount)
+    return;
+
+  Field &f = fields[field];
+  strncpy(f.value, value, f.width);
+  f.value[f.width] = 0;
+
+  if (strcmp(f.value, f.shown))
+    f.dirty = true;
+}
+
+void StatusScreen::setColor(uint8_t field, uint16_t color)
+{
+  if (field >= fieldCount || fields[field].color == color)
+    return;
+
+  fields[field].color = color;
+  fields[field].shown[0] = 0;
+  fields[field].dirty = true;
+}
+
+void StatusScreen::invalidate()
+{
+  labelsDrawn = false;
+}
+
+uint32_t StatusScreen::update()
+{
+  uint32_t bytes = 0;
+  uint8_t count = 0;
+
+  if (!labelsDrawn)
+  {
+    tft->fillScreen(bgcolor);
+    bytes += WINDOW_BYTES + (uint32_t)tft->width() * tft->height() * 2;
+
+    for (uint8_t i = 0; i < fieldCount; i++)
+    {
+      Field &f = fields[i];
+
+      tft->setTextSize(f.size);
+      tft->setTextColor(TFT_WHITE, bgcolor);
+      tft->drawString(f.label, f.x, f.y, 1);
+      bytes += strlen(f.label) * glyphBytes(f.size);
+
+      f.shown[0] = 0;
+      f.dirty = true;
+    }
+
+    labelsDrawn = true;
+  }
+
+  for (uint8_t i = 0; i < fieldCount; i++)
+  {
+    Field &f = fields[i];
+
+    if (!f.dirty)
+      continue;
+
+    bytes += drawField(f);
+    f.dirty = false;
+    count++;
+  }
+
+  tft->setTextPadding(0);
+
+  lastBytes = bytes;
+  lastFields = count;
+  totalBytes += bytes;
+
+  return bytes;
+}
+
+uint32_t StatusScreen::drawField(Field &f)
+{
+  uint8_t cw = 6 * f.size;
+  int16_t vx = f.x + strlen(f.label) * cw;
+  uint8_t oldLen = strlen(f.shown);
+  uint8_t newLen = strlen(f.value);
+  uint8_t end = oldLen > newLen ? oldLen : newLen;
+
+  // Characters before the first difference are already on the panel
+  uint8_t first = 0;
+  while (first < newLen && f.value[first] == f.shown[first])
+    first++;
+
+  if (first >= end)
+    return 0;
+
+  // Padding blanks whatever is left of a longer previous value
+  tft->setTextSize(f.size);
+  tft->setTextColor(f.color, bgcolor);
+  tft->setTextPadding((end - first) * cw);
+  tft->drawString(f.value + first, vx + first * cw, f.y, 1);
+
+  uint32_t bytes = (newLen - first) * glyphBytes(f.size);
+  if (end > newLen)
+    bytes += WINDOW_BYTES + (uint32_t)(end - newLen) * cw * 8 * f.size * 2;
+
+  strcpy(f.shown, f.value);
+
+  return bytes;
+}
@@ -0,0 +1,231 @@
+#include "TrackCodec.h"
+
+#define KEYFRAME_TAG0 0xFF
+#define KEYFRAME_TAG1 'K'
+#define KEYFRAME_SIZE (2 + sizeof(TrackRecord) + 2)
+
+#define FIELD_TIME 0x01
+#define FIELD_LAT 0x02
+#define FIELD_LNG 0x04
+#define FIELD_ALTITUDE 0x08
+#define FIELD_SPEED 0x10
+#define FIELD_COURSE 0x20
+#define FIELD_QUALITY 0x40
+
+// Longest varint of a 64 bit value
+#define MAX_VARINT 10
+
+static uint16_t fletcher16(const uint8_t *data, size_t len)
+{
+  uint16_t a = 0, b = 0;
+  while (len--)
+  {
+    a = (a + *data++) % 255;
+    b = (b + a) % 255;
+  }
+  return b << 8 | a;
+}
+
+static uint8_t *putVarint(uint8_t *out, int64_t value)
+{
+  uint64_t v = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+  while (v >= 0x80)
+  {
+    *out++ = (uint8_t)v | 0x80;
+    v >>= 7;
+  }
+  *out++ = (uint8_t)v;
+  return out;
+}
+
+// Returns the bytes used, 0 if the input ends first, -1 if it is too long
+static int getVarint(const uint8_t *data, size_t len, int64_t &value)
+{
+  uint64_t v = 0;
+  for (int i = 0; i < MAX_VARINT; i++)
+  {
+    if ((size_t)i >= len)
+      return 0;
+
+    v |= (uint64_t)(data[i] & 0x7F) << (7 * i);
+    if (!(data[i] & 0x80))
+    {
+      value = (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+      return i + 1;
+    }
+  }
+  return -1;
+}
+
+TrackEncoder::TrackEncoder(uint16_t keyframeInterval)
+    : interval(keyframeInterval ? keyframeInterval : 1), sinceKeyframe(interval),
+      timeStep(0), latStep(0), lngStep(0)
+{
+  memset(&prev, 0, sizeof(prev));
+}
+
+size_t TrackEncoder::keyframe(const TrackRecord &rec, uint8_t *out)
+{
+  out[0] = KEYFRAME_TAG0;
+  out[1] = KEYFRAME_TAG1;
+  memcpy(out + 2, &rec, sizeof(rec));
+
+  uint16_t sum = fletcher16(out, 2 + sizeof(rec));
+  out[2 + sizeof(rec)] = sum;
+  out[3 + sizeof(rec)] = sum >> 8;
+
+  prev = rec;
+  timeStep = latStep = lngStep = 0;
+  sinceKeyframe = 0;
+
+  return KEYFRAME_SIZE;
+}
+
+size_t TrackEncoder::encode(const TrackRecord &rec, uint8_t *out)
+{
+  if (sinceKeyframe >= interval)
+    return keyframe(rec, out);
+
+  int64_t time = rec.time - prev.time;
+  int64_t lat = (int64_t)rec.latE7 - prev.latE7;
+  int64_t lng = (int64_t)rec.lngE7 - prev.lngE7;
+
+  int64_t fields[6] = {time - timeStep, lat - latStep, lng - lngStep,
+                       (int64_t)rec.altitude - prev.altitude,
+                       (int64_t)rec.speed - prev.speed,
+                       (int64_t)rec.course - prev.course};
+
+  uint8_t *p = out + 1;
+  uint8_t mask = 0;
+  for (int i = 0; i < 6; i++)
+  {
+    if (fields[i] != 0)
+    {
+      mask |= 1 << i;
+      p = putVarint(p, fields[i]);
+    }
+  }
+
+  if (rec.hdop != prev.hdop || rec.satellites != prev.satellites || rec.flags != prev.flags)
+  {
+    mask |= FIELD_QUALITY;
+    p = putVarint(p, (int64_t)rec.hdop - prev.hdop);
+    *p++ = rec.satellites;
+    *p++ = rec.flags;
+  }
+
+  out[0] = mask;
+
+  prev = rec;
+  timeStep = time;
+  latStep = lat;
+  lngStep = lng;
+  sinceKeyframe++;
+
+  return p - out;
+}
+
+TrackDecoder::TrackDecoder()
+    : synced(false), timeStep(0), latStep(0), lngStep(0), recordCount(0), keyframeCount(0),
+      resyncCount(0), skipped(0)
+{
+  memset(&prev, 0, sizeof(prev));
+}
+
+size_t TrackDecoder::decode(const uint8_t *data, size_t len, TrackRecord &rec, bool &have)
+{
+  have = false;
+  if (len == 0)
+    return 0;
+
+  if (data[0] == KEYFRAME_TAG0)
+  {
+    if (len < 2)
+      return 0;
+
+    if (data[1] == KEYFRAME_TAG1)
+    {
+      if (len < KEYFRAME_SIZE)
+        return 0;
+
+      uint16_t sum = data[2 + sizeof(rec)] | data[3 + sizeof(rec)] << 8;
+      if (sum == fletcher16(data, 2 + sizeof(rec)))
+      {
+        memcpy(&prev, data + 2, sizeof(prev));
+        timeStep = latStep = lngStep = 0;
+
+        if (!synced && recordCount > 0)
+          resyncCount++;
+        synced = true;
+
+        rec = prev;
+        have = true;
+        recordCount++;
+        keyframeCount++;
+        return KEYFRAME_SIZE;
+      }
+    }
+  }
+  else if (synced && data[0] < 0x80)
+  {
+    uint8_t mask = data[0];
+    size_t pos = 1;
+    int64_t fields[7] = {0, 0, 0, 0, 0, 0, 0};
+    bool ok = true;
+
+    for (int i = 0; i < 7 && ok; i++)
+    {
+      if (!(mask & (1 << i)))
+        continue;
+
+      int n = getVarint(data + pos, len - pos, fields[i]);
+      if (n == 0)
+        return 0;
+      ok = n > 0;
+      pos += n;
+    }
+
+    uint8_t satellites = prev.satellites, flags = prev.flags;
+    if (ok && (mask & FIELD_QUALITY))
+    {
+      if (len < pos + 2)
+        return 0;
+      satellites = data[pos++];
+      flags = data[pos++];
+    }
+
+    int64_t time = timeStep + fields[0];
+    int64_t lat = latStep + fields[1];
+    int64_t lng = lngStep + fields[2];
+    int64_t latE7 = prev.latE7 + lat;
+    int64_t lngE7 = prev.lngE7 + lng;
+
+    // Corrupt deltas usually walk off the globe
+    if (ok && latE7 >= -900000000 && latE7 <= 900000000 && lngE7 >= -1800000000 &&
+        lngE7 <= 1800000000)
+    {
+      prev.time += time;
+      prev.latE7 = latE7;
+      prev.lngE7 = lngE7;
+      prev.altitude += fields[3];
+      prev.speed += fields[4];
+      prev.course += fields[5];
+      prev.hdop += fields[6];
+      prev.satellites = satellites;
+      prev.flags = flags;
+      timeStep = time;
+      latStep = lat;
+      lngStep = lng;
+
+      rec = prev;
+      have = true;
+      recordCount++;
+      return pos;
+    }
+  }
+
+  // Not a frame, hunt for the next keyframe
+  synced = false;
+  skipped++;
+  return 1;
+}
@@ -0,0 +1,298 @@
+#include "TrackReader.h"
+
+TrackReader::TrackReader()
+    : dataStart(0), dataEnd(0), encoding(TRACK_ENCODING_FIXED), recordSize(0), framed(false), frameLeft(0),
+      sequence(0), haveSequence(false), gap(false), bad(0), indexStart(0), indexCount(0), entrySize(0),
+      inLen(0), haveFound(false), probes(0), skipped(0)
+{
+}
+
+bool TrackReader::open(fs::FS &fs, const char *path, const char *indexPath)
+{
+  close();
+
+  file = fs.open(path, FILE_READ);
+  if (!file)
+    return false;
+
+  TrackHeader header;
+  if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || !trackCheckHeader(header))
+  {
+    file.close();
+    return false;
+  }
+
+  dataStart = header.headerSize;
+  dataEnd = trackLength(header, file.size());
+  encoding = trackEncoding(header);
+  recordSize = header.recordSize;
+  framed = trackFraming(header) == TRACK_FRAMING_JOURNAL;
+  file.seek(dataStart);
+
+  // A missing or unreadable index only means seek() has to scan
+  if (indexPath)
+  {
+    index = fs.open(indexPath, FILE_READ);
+    LogIndexHeader ih;
+    if (index && index.read((uint8_t *)&ih, sizeof(ih)) == sizeof(ih) && logIndexCheckHeader(ih))
+    {
+      indexStart = ih.headerSize;
+      entrySize = ih.entrySize;
+      indexCount = (index.size() - indexStart) / entrySize;
+    }
+    else if (index)
+      index.close();
+  }
+
+  return true;
+}
+
+void TrackReader::close()
+{
+  if (file)
+    file.close();
+  if (index)
+    index.close();
+
+  indexCount = 0;
+  inLen = 0;
+  frameLeft = 0;
+  haveSequence = gap = false;
+  bad = 0;
+  haveFound = false;
+  decoder.reset();
+}
+
+bool TrackReader::readEntry(uint32_t i, LogIndexEntry &entry)
+{
+  probes++;
+  return index.seek(indexStart + i * entrySize) &&
+         index.read((uint8_t *)&entry, sizeof(entry)) == sizeof(entry);
+}
+
+bool TrackReader::seek(int64_t time)
+{
+  probes = skipped = 0;
+
+  LogIndexEntry entry;
+  bool indexed = indexCount > 0 &&
+                 logIndexFind(indexCount, time,
+                              [this](uint32_t i, LogIndexEntry &e) { return readEntry(i, e); }, entry);
+
+  decoder.reset();
+  inLen = 0;
+  frameLeft = 0;
+  haveSequence = gap = false;
+  haveFound = false;
+
+  // Without a good frame around the entry, the next one after it is hunted for
+  if (!indexed || !framed || !enterFrame(entry.offset))
+    file.seek(indexed ? entry.offset : dataStart);
+
+  while (decode(found))
+  {
+    if (found.time >= time)
+    {
+      haveFound = true;
+      return true;
+    }
+    skipped++;
+  }
+
+  return false;
+}
+
+bool TrackReader::next(TrackRecord &rec)
+{
+  if (haveFound)
+  {
+    rec = found;
+    haveFound = false;
+    return true;
+  }
+
+  return decode(rec);
+}
+
+bool TrackReader::decode(TrackRecord &rec)
+{
+  if (encoding == TRACK_ENCODING_FIXED)
+  {
+    // A record may span two frames of a journal
+    for (size_t got = 0; got < sizeof(rec);)
+    {
+      size_t n = readData((uint8_t *)&rec + got, sizeof(rec) - got);
+      if (n == 0)
+        return false;
+      got += n;
+    }
+
+    // Skip any fields a later version appended
+    for (size_t left = recordSize - sizeof(rec); left > 0;)
+    {
+      uint8_t extra[16];
+      size_t n = readData(extra, left < sizeof(extra) ? left : sizeof(extra));
+      if (n == 0)
+        return false;
+      left -= n;
+    }
+    return true;
+  }
+
+  bool have = false;
+  while (!have)
+  {
+    size_t used = decoder.decode(in, inLen, rec, have);
+    if (used == 0)
+    {
+      // The frame goes on past what is buffered
+      if (framed && frameLeft == 0)
+      {
+        if (!nextFrame())
+          return false;
+
+        // What was buffered does not go on in this frame
+        if (gap)
+        {
+          decoder.reset();
+          inLen = 0;
+          gap = false;
+        }
+      }
+
+      size_t n = readData(in + inLen, sizeof(in) - inLen);
+      if (n == 0)
+        return false;
+      inLen += n;
+      continue;
+    }
+
+    inLen -= used;
+    memmove(in, in + used, inLen);
+  }
+
+  return true;
+}
+
+// Up to len bytes of the track's data, within the current frame of a journal
+size_t TrackReader::readData(uint8_t *buf, size_t len)
+{
+  uint32_t pos = file.position();
+  if (!framed)
+  {
+    size_t want = pos < dataEnd ? dataEnd - pos : 0;
+    return want > 0 ? file.read(buf, want < len ? want : len) : 0;
+  }
+
+  if (frameLeft == 0 && !nextFrame())
+    return 0;
+
+  size_t n = file.read(buf, frameLeft < len ? frameLeft : len);
+  frameLeft -= n;
+  return n;
+}
+
+// Moves to the data of the next good frame, hunting for one past any damage
+bool TrackReader::nextFrame()
+{
+  uint32_t pos = file.position();
+  LogFrameHeader h;
+
+  while (pos + sizeof(h) < dataEnd)
+  {
+    file.seek(pos);
+    if (file.read((uint8_t *)&h, sizeof(h)) != sizeof(h))
+      return false;
+
+    if (logFrameCheckHeader(h) && pos + sizeof(h) + h.length <= dataEnd && checkFrame(h))
+    {
+      if (haveSequence && h.sequence != sequence)
+        gap = true;
+      sequence = h.sequence + 1;
+      haveSequence = true;
+
+      file.seek(pos + sizeof(h));
+      frameLeft = h.length;
+      return true;
+    }
+
+    // On to the next byte that could start a frame
+    gap = true;
+    pos++;
+    bad++;
+    file.seek(pos);
+
+    uint8_t look[32];
+    size_t n;
+    while ((n = file.read(look, sizeof(look))) > 0)
+    {
+      size_t i = 0;
+      while (i < n && look[i] != (LOG_FRAME_SYNC & 0xFF))
+        i++;
+      pos += i;
+      bad += i;
+      if (i < n)
+        break;
+    }
+  }
+
+  return false;
+}
+
+/*
+  Moves to offset inside the good frame that holds it, for an index entry
+  in a journal. The frame's header is less than a frame back, so the
+  bytes before offset are searched back that far for one that checks.
+*/
+bool TrackReader::enterFrame(uint32_t offset)
+{
+  uint32_t lowest = offset > dataStart + LOG_FRAME_MAX ? offset - LOG_FRAME_MAX : dataStart;
+  LogFrameHeader h;
+  uint8_t look[32];
+
+  // to is one past the last byte that could start the header
+  for (uint32_t to = offset >= lowest + sizeof(h) ? offset - sizeof(h) + 1 : lowest; to > lowest;)
+  {
+    uint32_t from = to - lowest > sizeof(look) ? to - sizeof(look) : lowest;
+    file.seek(from);
+    size_t n = file.read(look, to - from);
+    for (size_t i = n; i-- > 0;)
+    {
+      if (look[i] != (LOG_FRAME_SYNC & 0xFF))
+        continue;
+
+      uint32_t pos = from + i;
+      uint32_t end = pos + sizeof(h);
+      file.seek(pos);
+      if (file.read((uint8_t *)&h, sizeof(h)) == sizeof(h) && logFrameCheckHeader(h) &&
+          offset < end + h.length && end + h.length <= dataEnd && checkFrame(h))
+      {
+        sequence = h.sequence + 1;
+        haveSequence = true;
+        frameLeft = end + h.length - offset;
+        file.seek(offset);
+        return true;
+      }
+    }
+    to = from;
+  }
+
+  return false;
+}
+
+// Reads the frame's data through the CRC, leaving the file anywhere
+bool TrackReader::checkFrame(const LogFrameHeader &h)
+{
+  uint32_t crc = logCrc32(0, &h, offsetof(LogFrameHeader, crc));
+  uint8_t buf[64];
+  for (size_t left = h.length; left > 0;)
+  {
+    size_t n = file.read(buf, left < sizeof(buf) ? left : sizeof(buf));
+    if (n == 0)
+      return false;
+    crc = logCrc32(crc, buf, n);
+    left -= n;
+  }
+
+  return crc == h.crc;
+}
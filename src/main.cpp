@@ -5,6 +5,14 @@
 #include <SPI.h>
 #include <SD.h>
 
+#include "CaptureRecorder.h"
+#include "GpsReceiver.h"
+#include "LogPolicy.h"
+#include "LogWriter.h"
+#include "ReplaySource.h"
+#include "StatusScreen.h"
+#include "TrackCodec.h"
+
 /* Select your board model. By uncomment */
 
 // #define T4_V12
@@ -18,6 +26,24 @@
 #error "Please select board version."
 #endif
 
+/* Also record every byte from the receiver to /capNNNN.gcap, for field debugging */
+
+// #define GPS_CAPTURE
+
+/* Feed the parser from a capture, track or NMEA file on the SD card instead of the receiver,
+   at GPS_REPLAY_SPEED times real time, 0 for as fast as the firmware takes it */
+
+// #define GPS_REPLAY "/cap0000.gcap"
+#ifndef GPS_REPLAY_SPEED
+#define GPS_REPLAY_SPEED 1
+#endif
+
+/* Draw the status screen into a RAM canvas (76.8 kbytes) and send only the areas that
+   changed, merged into fewer windows, instead of drawing each field on the panel.
+   Needs TFT_CANVAS in the TFT_eSPI setup */
+
+// #define STATUS_CANVAS
+
 /* 0, 223 */
 
 SPIClass sdSPI(VSPI);
@@ -29,21 +55,77 @@ SPIClass sdSPI(VSPI);
 
 static const uint32_t GPSBaud = 9600;
 
+// Track file space allocated at a time, about 8 hours of fixes every second
+static const uint32_t TrackPrealloc = 256 * 1024;
+
 HardwareSerial hs(2);
+GpsReceiver receiver;
 TinyGPSPlus gps;
 TFT_eSPI tft = TFT_eSPI();
+LogWriter logger;
+TrackEncoder encoder;
+#if defined(GPS_CAPTURE)
+CaptureRecorder capture;
+uint32_t captureDropped = 0;
+#endif
+#if defined(GPS_REPLAY)
+ReplaySource replay;
+bool replayReported = true;
+#endif
+
+// Which epochs are worth a record, EveryFixPolicy or IntervalPolicy plug in the same way
+AdaptivePolicy adaptive;
+LogPolicy &policy = adaptive;
 
 static void smartDelay(unsigned long ms);
-static void printFloat(float val, bool valid, int len, int prec);
-static void printInt(unsigned long val, bool valid, int len);
-static void printDate(TinyGPSDate &d);
-static void printTime(TinyGPSTime &t);
-String setFilename(TinyGPSDate &d);
-void writeRoot(fs::FS &fs);
+static void formatFloat(char *sz, float val, bool valid, int len, int prec);
+static void formatInt(char *sz, unsigned long val, bool valid, int len);
+static void formatDate(char *sz, const TinyGPSFix &fix, bool valid);
+static void formatTime(char *sz, const TinyGPSFix &fix, bool valid);
+static void setupScreen();
+static void updateScreen();
+static void logFix();
+static void printLatency();
+static void fillRecord(TrackRecord &rec, const TinyGPSFix &fix);
+String setFilename(const TinyGPSFix &fix, bool valid);
+void writeRoot(fs::FS &fs, const TinyGPSFix &fix, const TrackRecord &rec);
+
+#if defined(STATUS_CANVAS)
+#if !defined(TFT_CANVAS)
+#error "STATUS_CANVAS needs TFT_CANVAS defined in the TFT_eSPI setup"
+#endif
+TFT_eCanvas canvas(&tft);
+bool canvasReady = false;
+StatusScreen screen(canvas);
+#else
+StatusScreen screen(tft);
+#endif
+
+enum
+{
+  FIELD_SATELLITES,
+  FIELD_HDOP,
+  FIELD_LATITUDE,
+  FIELD_LONGITUDE,
+  FIELD_FIX_AGE,
+  FIELD_DATE,
+  FIELD_TIME,
+  FIELD_ALTITUDE,
+  FIELD_COURSE,
+  FIELD_SPEED,
+  FIELD_CHARS,
+  FIELD_SENTENCES,
+  FIELD_CHECKSUM,
+  FIELD_SD_CARD,
+  FIELD_WARNING
+};
 
 uint32_t last1 = 0;
-uint32_t last2 = 0;
-char filename[12];
+uint32_t loggedSeq = 0;
+uint32_t worstWrite = 0;
+uint32_t lastLatency = 0;
+char filename[16];
+char indexname[16];
 bool writeOk = false;
 bool isReady = false;
 
@@ -51,7 +133,13 @@ void setup()
 {
   Serial.begin(115200);
 
+#if !defined(GPS_REPLAY)
   hs.begin(GPSBaud, SERIAL_8N1, RXPin, TXPin, false);
+  receiver.begin(hs);
+#endif
+  logger.begin();
+  logger.setPreallocation(TrackPrealloc, offsetof(TrackHeader, length));
+  logger.setJournal(sizeof(TrackHeader));
 
   tft.init();
   tft.setRotation(1);
@@ -90,10 +178,34 @@ void setup()
       delay(1000);
 
       isReady = true;
+
+#if defined(GPS_CAPTURE)
+      if (capture.begin(SD, GPSBaud))
+      {
+        Serial.print("Capturing to ");
+        Serial.println(capture.path());
+      }
+#endif
+
+#if defined(GPS_REPLAY)
+      if (replay.begin(SD, GPS_REPLAY, GPS_REPLAY_SPEED))
+      {
+        // A file can wait for the parser, nothing it holds should be lost
+        receiver.setBackpressure(true);
+#if defined(ESP32)
+        receiver.begin(replay, GPS_TASK_CORE, GPS_FILE_TASK_STACK);
+#else
+        receiver.begin(replay);
+#endif
+        replayReported = false;
+        Serial.print("Replaying ");
+        Serial.println(GPS_REPLAY);
+      }
+#endif
     }
   }
 
-  tft.setTextSize(2);
+  setupScreen();
 }
 
 void loop()
@@ -102,214 +214,368 @@ void loop()
   {
     last1 = millis();
 
-    tft.fillScreen(TFT_BLACK);
-    tft.setTextColor(TFT_WHITE);
+    updateScreen();
 
-    if (millis() > 5000 && gps.charsProcessed() < 10)
-    {
-      tft.print(F("No GPS data received: check wiring"));
-    }
+    smartDelay(1800);
+  }
 
-    tft.setCursor(0, 0);
-    tft.print("Satellites: ");
-    printInt(gps.satellites.value(), gps.satellites.isValid(), 5);
-    tft.print("\nHDOP: ");
-    printFloat(gps.hdop.hdop(), gps.hdop.isValid(), 6, 1);
-    tft.print("\nLatitude: ");
-    printFloat(gps.location.lat(), gps.location.isValid(), 11, 6);
-    tft.print("\nLongitude: ");
-    printFloat(gps.location.lng(), gps.location.isValid(), 12, 6);
-    tft.print("\nFix (Age): ");
-    printInt(gps.location.age(), gps.location.isValid(), 5);
-    tft.print("\nDate: ");
-    printDate(gps.date);
-    tft.print("\nTime: ");
-    printTime(gps.time);
-    tft.print("\nDate (Age): ");
-    printFloat(gps.altitude.meters(), gps.altitude.isValid(), 7, 2);
-    tft.print("\nAltitude (m): ");
-    printFloat(gps.course.deg(), gps.course.isValid(), 7, 2);
-    tft.print("\nCourse Speed Card: ");
-    printFloat(gps.speed.kmph(), gps.speed.isValid(), 6, 2);
-    tft.print("\nChars: ");
-    printInt(gps.charsProcessed(), true, 6);
-    tft.print("\nSentences: ");
-    printInt(gps.sentencesWithFix(), true, 10);
-    tft.print("\nChecksum: ");
-    printInt(gps.failedChecksum(), true, 9);
-
-    if (writeOk == true && isReady == true)
-    {
-      tft.setTextSize(1.3);
-      tft.setCursor(0, 223);
-      tft.print("SD Card: Writing");
-      tft.setTextSize(2);
-    }
-    else if (writeOk == false && isReady == true)
-    {
-      tft.setTextSize(1.3);
-      tft.setCursor(0, 223);
-      tft.print("SD Card: Attempting to write");
-      tft.setTextSize(2);
-    }
-    else if (writeOk == false && isReady == false)
-    {
-      tft.setTextSize(1.3);
-      tft.setCursor(0, 223);
-      tft.println("SD Card: Mount failed!");
-      tft.setTextSize(2);
-    }
+  logger.poll();
 
-    smartDelay(1800);
+  if (millis() - lastLatency >= 3600000L)
+  {
+    lastLatency = millis();
+    printLatency();
+#if defined(TFT_PROFILE)
+    tft.printProfile(Serial);
+    tft.resetProfile();
+#endif
   }
 
-  if ((millis() - last2) >= 20000L && isReady == true)
+#if defined(GPS_CAPTURE)
+  if (receiver.bytesDropped() != captureDropped)
   {
-    writeRoot(SD);
+    captureDropped = receiver.bytesDropped();
+    capture.markGap();
+  }
+  capture.poll();
+#endif
 
-    last2 = millis();
+#if defined(GPS_REPLAY)
+  if (replay.finished() && !replayReported && receiver.available() == 0)
+  {
+    replayReported = true;
+    uint32_t ms = replay.elapsedMillis();
+    Serial.print("Replay done: ");
+    Serial.print(replay.bytesReplayed());
+    Serial.print(" bytes, ");
+    Serial.print(replay.recordingMillis() / 1000);
+    Serial.print(" s of recording in ");
+    Serial.print(ms);
+    Serial.print(" ms, ");
+    Serial.print(ms ? (uint32_t)((uint64_t)replay.bytesReplayed() * 1000 / ms) : 0);
+    Serial.println(" bytes/s");
+  }
+#endif
+}
+
+static void setupScreen()
+{
+#if defined(STATUS_CANVAS)
+  // Without the RAM the fields are drawn on the panel as they change
+  canvasReady = canvas.createSprite(tft.width(), tft.height()) != nullptr;
+  if (!canvasReady)
+  {
+    Serial.println("No memory for the screen canvas, drawing on the panel");
+    screen.setDisplay(tft);
+  }
+#endif
+
+  screen.addField("Satellites: ", 0, 0, 5);
+  screen.addField("HDOP: ", 0, 16, 6);
+  screen.addField("Latitude: ", 0, 32, 11);
+  screen.addField("Longitude: ", 0, 48, 12);
+  screen.addField("Fix (Age): ", 0, 64, 5);
+  screen.addField("Date: ", 0, 80, 16);
+  screen.addField("Time: ", 0, 96, 14);
+  screen.addField("Altitude (m): ", 0, 112, 7);
+  screen.addField("Course: ", 0, 128, 7);
+  screen.addField("Speed (km/h): ", 0, 144, 6);
+  screen.addField("Chars: ", 0, 160, 10);
+  screen.addField("Sentences: ", 0, 176, 10);
+  screen.addField("Checksum: ", 0, 192, 9);
+  screen.addField("SD Card: ", 0, 223, 28, 1);
+  screen.addField("", 0, 232, 34, 1, TFT_RED);
+}
+
+static void updateScreen()
+{
+  // Room for the widest field, the 34 character warning line
+  char sz[STATUS_MAX_CHARS + 1];
+
+  // One epoch for every field, not whatever each getter holds right now
+  TinyGPSFix fix;
+  bool valid = gps.readFix(fix) != 0;
+  bool located = valid && fix.hasFix;
+
+  formatInt(sz, fix.satellites, valid, 5);
+  screen.setValue(FIELD_SATELLITES, sz);
+  formatFloat(sz, fix.hdop / 100.0, valid, 6, 1);
+  screen.setValue(FIELD_HDOP, sz);
+  formatFloat(sz, fix.lat(), located, 11, 6);
+  screen.setValue(FIELD_LATITUDE, sz);
+  formatFloat(sz, fix.lng(), located, 12, 6);
+  screen.setValue(FIELD_LONGITUDE, sz);
+  formatInt(sz, fix.age(), located, 5);
+  screen.setValue(FIELD_FIX_AGE, sz);
+  formatDate(sz, fix, valid);
+  screen.setValue(FIELD_DATE, sz);
+  formatTime(sz, fix, valid);
+  screen.setValue(FIELD_TIME, sz);
+  formatFloat(sz, fix.meters(), located, 7, 2);
+  screen.setValue(FIELD_ALTITUDE, sz);
+  formatFloat(sz, fix.deg(), located, 7, 2);
+  screen.setValue(FIELD_COURSE, sz);
+  formatFloat(sz, fix.kmph(), located, 6, 2);
+  screen.setValue(FIELD_SPEED, sz);
+  formatInt(sz, gps.charsProcessed(), true, 10);
+  screen.setValue(FIELD_CHARS, sz);
+  formatInt(sz, gps.sentencesWithFix(), true, 10);
+  screen.setValue(FIELD_SENTENCES, sz);
+  formatInt(sz, gps.failedChecksum(), true, 9);
+  screen.setValue(FIELD_CHECKSUM, sz);
+
+  if (writeOk == true && isReady == true)
+    screen.setValue(FIELD_SD_CARD, "Writing");
+  else if (writeOk == false && isReady == true)
+    screen.setValue(FIELD_SD_CARD, "Attempting to write");
+  else
+    screen.setValue(FIELD_SD_CARD, "Mount failed!");
+
+  if (millis() > 5000 && gps.charsProcessed() < 10)
+  {
+    screen.setValue(FIELD_WARNING, "No GPS data received: check wiring");
+  }
+  else if (receiver.bytesDropped() > 0)
+  {
+    snprintf(sz, sizeof(sz), "GPS overrun: %lu bytes lost", (unsigned long)receiver.bytesDropped());
+    screen.setValue(FIELD_WARNING, sz);
+  }
+  else if (logger.droppedRecords() > 0)
+  {
+    snprintf(sz, sizeof(sz), "SD behind: %lu fixes lost", (unsigned long)logger.droppedRecords());
+    screen.setValue(FIELD_WARNING, sz);
+  }
+  else
+  {
+    screen.setValue(FIELD_WARNING, "");
+  }
+
+  uint32_t bytes = screen.update();
+#if defined(STATUS_CANVAS)
+  if (canvasReady)
+    bytes = canvas.flush();
+#endif
+#if defined(TFT_PROFILE)
+  tft.profileFrame();
+#endif
+
+  if (bytes > 0)
+  {
+    Serial.print("Screen update: ");
+    Serial.print(screen.fieldsLastUpdate());
+    Serial.print(" fields, ");
+    Serial.print(bytes);
+    Serial.println(" bytes");
+  }
+
+  if (logger.maxWriteMicros() > worstWrite)
+  {
+    worstWrite = logger.maxWriteMicros();
+    Serial.print("SD worst write: ");
+    Serial.print(worstWrite);
+    Serial.print(" us, ");
+    Serial.print(logger.queuedBytes());
+    Serial.println(" bytes queued");
   }
 }
 
 static void smartDelay(unsigned long ms)
 {
   unsigned long start = millis();
+  char buf[64];
   do
   {
-    while (hs.available())
-      gps.encode(hs.read());
+    // The receiver task has queued the UART bytes, parse them in blocks
+    size_t n;
+    while ((n = receiver.read(buf, sizeof(buf))) > 0)
+    {
+      gps.encode(buf, n);
+#if defined(GPS_CAPTURE)
+      capture.write((const uint8_t *)buf, n);
+#endif
+      logFix();
+    }
   } while (millis() - start < ms);
 }
 
-static void printFloat(float val, bool valid, int len, int prec)
+static void formatFloat(char *sz, float val, bool valid, int len, int prec)
 {
   if (!valid)
   {
-    while (len-- > 1)
-      tft.print('*');
-    tft.print(' ');
+    memset(sz, '*', len - 1);
+    sz[len - 1] = 0;
   }
   else
   {
-    tft.print(val, prec);
-    int vi = abs((int)val);
-    int flen = prec + (val < 0.0 ? 2 : 1); // . and -
-    flen += vi >= 1000 ? 4 : vi >= 100 ? 3 : vi >= 10 ? 2 : 1;
-    for (int i = flen; i < len; ++i)
-      tft.print(' ');
+    snprintf(sz, len + 1, "%.*f", prec, val);
   }
-  smartDelay(0);
 }
 
-static void printInt(unsigned long val, bool valid, int len)
+static void formatInt(char *sz, unsigned long val, bool valid, int len)
 {
-  char sz[32] = "*****************";
-  if (valid)
-    sprintf(sz, "%ld", val);
-  sz[len] = 0;
-  for (int i = strlen(sz); i < len; ++i)
-    sz[i] = ' ';
-  if (len > 0)
-    sz[len - 1] = ' ';
-  tft.print(sz);
-  smartDelay(0);
+  if (!valid)
+  {
+    memset(sz, '*', len - 1);
+    sz[len - 1] = 0;
+  }
+  else
+  {
+    // A value wider than the field shows as the largest that fits, not its leading digits
+    char digits[24];
+    int n = snprintf(digits, sizeof(digits), "%lu", val);
+    if (n > len)
+    {
+      memset(sz, '9', len);
+      sz[len] = 0;
+    }
+    else
+    {
+      memcpy(sz, digits, n + 1);
+    }
+  }
 }
 
-static void printDate(TinyGPSDate &d)
+static void formatDate(char *sz, const TinyGPSFix &fix, bool valid)
 {
-  if (!d.isValid())
+  if (!valid)
   {
-    tft.print(F("********** "));
+    strcpy(sz, "********** ");
   }
   else
   {
-    char sz[32];
-    sprintf(sz, "%02d/%02d/%04d ", d.month(), d.day(), d.year());
-    tft.print(sz);
+    sprintf(sz, "%02d/%02d/%04d ", fix.month(), fix.day(), fix.year());
   }
-  printInt(d.age(), d.isValid(), 5);
-  smartDelay(0);
+  formatInt(sz + strlen(sz), fix.age(), valid, 5);
 }
 
-static void printTime(TinyGPSTime &t)
+static void formatTime(char *sz, const TinyGPSFix &fix, bool valid)
 {
-  char sz[32];
-  if (t.isValid())
+  if (!valid)
+  {
+    strcpy(sz, "******** ");
+  }
+  else
   {
-    sprintf(sz, "%02d:%02d:%02d ", t.hour(), t.minute(), t.second());
+    sprintf(sz, "%02d:%02d:%02d ", fix.hour(), fix.minute(), fix.second());
   }
+  formatInt(sz + strlen(sz), fix.age(), valid, 5);
+}
+
+// Shows every epoch the parser publishes to the policy once, logs those it picks
+static void logFix()
+{
+  TinyGPSFix fix;
+  uint32_t seq = gps.readFix(fix);
+
+  if (seq == loggedSeq || isReady == false)
+    return;
 
-  printInt(t.age(), t.isValid(), 5);
-  smartDelay(0);
+  loggedSeq = seq;
+
+  TrackRecord rec;
+  fillRecord(rec, fix);
+  if (policy.log(rec))
+    writeRoot(SD, fix, rec);
 }
 
-String setFilename(TinyGPSDate &d)
+// How long the card took over each write of the track log, by powers of two
+static void printLatency()
 {
-  if (!d.isValid())
+  static const char *const labels[LOG_LATENCY_BUCKETS] = {
+      "<1", "1-2", "2-4", "4-8", "8-16", "16-32", "32-64", "64-128", "128-256", "256-512",
+      "512-1024", ">1024"};
+
+  Serial.print("SD write ms:");
+  for (int i = 0; i < LOG_LATENCY_BUCKETS; i++)
   {
-    sprintf(filename, "/NULLFiles.csv");
+    if (logger.latency(i) == 0)
+      continue;
+    Serial.print(" ");
+    Serial.print(labels[i]);
+    Serial.print(":");
+    Serial.print(logger.latency(i));
+  }
+  Serial.println();
+}
+
+String setFilename(const TinyGPSFix &fix, bool valid)
+{
+  if (!valid)
+  {
+    sprintf(filename, "/NULLFiles.trk");
+    sprintf(indexname, "/NULLFiles.idx");
   }
   else
   {
-    sprintf(filename, "/%02d%02d%04d.csv", d.day(), d.month(), d.year());
+    sprintf(filename, "/%02d%02d%04d.trk", fix.day(), fix.month(), fix.year());
+    sprintf(indexname, "/%02d%02d%04d.idx", fix.day(), fix.month(), fix.year());
   }
 
   return (String)filename;
 }
 
-void writeRoot(fs::FS &fs)
+static void fillRecord(TrackRecord &rec, const TinyGPSFix &fix)
+{
+  rec.time = trackTime(fix.date, fix.time);
+  rec.latE7 = fix.latE7;
+  rec.lngE7 = fix.lngE7;
+  rec.altitude = fix.altitude;
+  rec.speed = fix.speed > 0xFFFF ? 0xFFFF : fix.speed;
+  rec.course = fix.course;
+  rec.hdop = fix.hdop > 0xFFFF ? 0xFFFF : fix.hdop;
+  rec.satellites = fix.satellites > 0xFF ? 0xFF : fix.satellites;
+  rec.flags = (fix.hasFix ? TRACK_FLAG_FIX : 0) | (fix.date ? TRACK_FLAG_DATE : 0);
+}
+
+void writeRoot(fs::FS &fs, const TinyGPSFix &fix, const TrackRecord &rec)
 {
-  File root = fs.open(setFilename(gps.date), FILE_APPEND);
-  Serial.print("SD Card Write...   ");
+  setFilename(fix, fix.date != 0);
+  bool reopened = !logger.isOpen() || strcmp(logger.path(), filename) != 0;
 
-  if (root)
+  // The day's file and its index stay open until the date changes
+  if (!logger.open(fs, filename, indexname))
   {
-    writeOk = true;
-
-    Serial.println("Success");
-
-    root.print(gps.satellites.isValid());
-    root.print(",");
-    root.print(gps.satellites.value());
-    root.print(",");
-    root.print(gps.hdop.hdop());
-    root.print(",");
-    root.print(gps.location.lat());
-    root.print(",");
-    root.print(gps.location.lng());
-    root.print(",");
-    root.print(gps.location.age());
-    root.print(",");
-    root.print(gps.date.month());
-    root.print("/");
-    root.print(gps.date.day());
-    root.print("/");
-    root.print(gps.date.year());
-    root.print(",");
-    root.print(gps.time.hour());
-    root.print(":");
-    root.print(gps.time.minute());
-    root.print(":");
-    root.print(gps.time.second());
-    root.print(",");
-    root.print(gps.altitude.meters());
-    root.print(",");
-    root.print(gps.course.deg());
-    root.print(",");
-    root.print(gps.speed.kmph());
-    root.print(",");
-    root.print(gps.charsProcessed());
-    root.print(",");
-    root.print(gps.sentencesWithFix());
-    root.print(",");
-    root.println(gps.failedChecksum());
-
-    root.close();
+    writeOk = false;
+    return;
   }
-  else
+
+  if (reopened && logger.bytesRecovered() > 0)
   {
-    writeOk = false;
+    Serial.print("Recovered ");
+    Serial.print(logger.bytesRecovered());
+    Serial.print(" bytes after the last flush of ");
+    Serial.println(filename);
+  }
+
+  if (reopened && logger.bytesTorn() > 0)
+  {
+    Serial.print("Dropped ");
+    Serial.print(logger.bytesTorn());
+    Serial.print(" torn bytes at the end of ");
+    Serial.println(filename);
+  }
 
-    Serial.println("Failed");
+  if (logger.size() == 0)
+  {
+    TrackHeader header;
+    trackInitHeader(header, TRACK_ENCODING_DELTA, TRACK_FRAMING_JOURNAL);
+    logger.write((const uint8_t *)&header, sizeof(header));
   }
+
+  // Deltas only make sense after a keyframe in the same file
+  if (reopened)
+    encoder.reset();
+
+  uint8_t frame[TRACK_MAX_FRAME];
+  size_t len = encoder.encode(rec, frame);
+
+  // Keyframes are where a reader can start, so they are what the index points at
+  if (encoder.lastWasKeyframe())
+    logger.mark(rec.time);
+
+  // A dropped frame breaks the chain of deltas, start a new one
+  if (logger.write(frame, len) == 0)
+    encoder.reset();
+
+  writeOk = logger.isOpen();
 }
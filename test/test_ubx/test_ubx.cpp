@@ -0,0 +1,193 @@
+/*
+  Checks TinyGPS++'s UBX NAV-PVT decoding against a capture of a u-blox
+  receiver's mixed NMEA and UBX output (ubx_capture.h), on the host:
+
+    pio test -e native
+
+  HostSim's main() runs setup(), which runs the tests.
+*/
+#include <Arduino.h>
+#include <TinyGPS++.h>
+#include <unity.h>
+
+#include "ubx_capture.h"
+
+#define UBX_EPOCHS (sizeof(ubxExpected) / sizeof(ubxExpected[0]))
+
+// A NAV-PVT frame: sync, class, id, length, 92 byte payload and checksum
+#define UBX_FRAME_SIZE 100
+
+// Where each epoch's NAV-PVT frame starts in the capture
+static size_t frameAt[UBX_EPOCHS];
+static size_t frameCount;
+
+static const uint8_t *frame(size_t epoch)
+{
+  return ubxCapture + frameAt[epoch];
+}
+
+static size_t feed(TinyGPSPlus &gps, const uint8_t *data, size_t len)
+{
+  return gps.encode((const char *)data, len);
+}
+
+static void checkEpoch(TinyGPSPlus &gps, size_t epoch)
+{
+  const UbxExpected &e = ubxExpected[epoch];
+  TinyGPSFix fix;
+  gps.readFix(fix);
+
+  TEST_ASSERT_TRUE(fix.hasFix);
+  TEST_ASSERT_EQUAL_UINT32(e.date, fix.date);
+  TEST_ASSERT_EQUAL_UINT32(e.time, fix.time);
+  TEST_ASSERT_EQUAL_INT32(e.latE7, fix.latE7);
+  TEST_ASSERT_EQUAL_INT32(e.lngE7, fix.lngE7);
+  TEST_ASSERT_EQUAL_INT32(e.altitude, fix.altitude);
+  TEST_ASSERT_EQUAL_INT32(e.speed, fix.speed);
+  TEST_ASSERT_EQUAL_INT32(e.course, fix.course);
+  TEST_ASSERT_EQUAL_UINT32(e.satellites, fix.satellites);
+  TEST_ASSERT_EQUAL_INT32(e.hdop, fix.hdop);
+}
+
+// Each epoch is RMC, GGA and one NAV-PVT frame
+static void test_capture_layout(void)
+{
+  TEST_ASSERT_EQUAL(UBX_EPOCHS, frameCount);
+  TEST_ASSERT_EQUAL(0x01, frame(0)[2]);
+  TEST_ASSERT_EQUAL(0x07, frame(0)[3]);
+}
+
+// The NAV-PVT frames alone, as from a receiver with NMEA turned off
+static void test_frames_decode(void)
+{
+  TinyGPSPlus gps;
+  TinyGPSFix fix;
+
+  for (size_t i = 0; i < UBX_EPOCHS; i++)
+  {
+    TEST_ASSERT_EQUAL(1, feed(gps, frame(i), UBX_FRAME_SIZE));
+    TEST_ASSERT_EQUAL_UINT32(i + 1, gps.readFix(fix));
+    checkEpoch(gps, i);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(0, gps.failedChecksum());
+}
+
+// The whole capture in small blocks, so frames and sentences are split across calls
+static void test_capture_decodes(void)
+{
+  TinyGPSPlus gps;
+  size_t from = 0;
+
+  for (size_t i = 0; i < UBX_EPOCHS; i++)
+  {
+    size_t to = frameAt[i] + UBX_FRAME_SIZE;
+    for (size_t p = from; p < to; p += 7)
+      feed(gps, ubxCapture + p, to - p < 7 ? to - p : 7);
+    from = to;
+
+    checkEpoch(gps, i);
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(3 * UBX_EPOCHS, gps.passedChecksum());
+  TEST_ASSERT_EQUAL_UINT32(0, gps.failedChecksum());
+}
+
+// RMC, a NAV-PVT frame, then GGA: the frame does not upset either sentence
+static void test_frame_between_sentences(void)
+{
+  const uint8_t *rmc = ubxCapture;
+  const uint8_t *gga = (const uint8_t *)memchr(rmc, '\n', frameAt[0]) + 1;
+  size_t rmcLen = gga - rmc;
+  size_t ggaLen = frame(0) - gga;
+
+  TinyGPSPlus gps;
+  TEST_ASSERT_EQUAL(1, feed(gps, rmc, rmcLen));
+  TEST_ASSERT_EQUAL(1, feed(gps, frame(0), UBX_FRAME_SIZE));
+  TEST_ASSERT_EQUAL(1, feed(gps, gga, ggaLen));
+
+  TEST_ASSERT_EQUAL_UINT32(3, gps.passedChecksum());
+  TEST_ASSERT_EQUAL_UINT32(0, gps.failedChecksum());
+  checkEpoch(gps, 0);
+}
+
+// A frame whose payload or checksum was corrupted publishes nothing
+static void test_bad_checksum(void)
+{
+  uint8_t bad[UBX_FRAME_SIZE];
+  TinyGPSPlus gps;
+  TinyGPSFix fix;
+
+  memcpy(bad, frame(0), sizeof(bad));
+  bad[6 + 24] ^= 0x10; // longitude
+  TEST_ASSERT_EQUAL(0, feed(gps, bad, sizeof(bad)));
+
+  memcpy(bad, frame(0), sizeof(bad));
+  bad[UBX_FRAME_SIZE - 1] ^= 0x01; // CK_B
+  TEST_ASSERT_EQUAL(0, feed(gps, bad, sizeof(bad)));
+
+  TEST_ASSERT_EQUAL_UINT32(2, gps.failedChecksum());
+  TEST_ASSERT_EQUAL_UINT32(0, gps.readFix(fix));
+  TEST_ASSERT_FALSE(gps.location.isValid());
+
+  // The next good frame is decoded
+  TEST_ASSERT_EQUAL(1, feed(gps, frame(1), UBX_FRAME_SIZE));
+  checkEpoch(gps, 1);
+}
+
+// A frame cut short swallows what follows as its payload, then the parser
+// picks up again at the next sync characters
+static void test_truncated_frame_resyncs(void)
+{
+  TinyGPSPlus gps;
+  TinyGPSFix fix;
+
+  feed(gps, frame(0), 40);
+  feed(gps, frame(1), UBX_FRAME_SIZE);
+  TEST_ASSERT_EQUAL_UINT32(1, gps.failedChecksum());
+  TEST_ASSERT_EQUAL_UINT32(0, gps.readFix(fix));
+
+  TEST_ASSERT_EQUAL(1, feed(gps, frame(2), UBX_FRAME_SIZE));
+  TEST_ASSERT_EQUAL_UINT32(1, gps.readFix(fix));
+  checkEpoch(gps, 2);
+
+  // NMEA is read again too
+  size_t from = frameAt[2] + UBX_FRAME_SIZE;
+  TEST_ASSERT_EQUAL(2, feed(gps, ubxCapture + from, frameAt[3] - from));
+}
+
+// Without a resolved date and time the epoch carries none, not the last one's
+static void test_unresolved_date_time(void)
+{
+  TinyGPSPlus gps;
+  TinyGPSFix fix;
+
+  feed(gps, frame(4), UBX_FRAME_SIZE);
+  TEST_ASSERT_EQUAL(1, feed(gps, ubxNoDate, sizeof(ubxNoDate)));
+  TEST_ASSERT_EQUAL_UINT32(2, gps.readFix(fix));
+
+  TEST_ASSERT_FALSE(fix.hasFix);
+  TEST_ASSERT_EQUAL_UINT32(0, fix.date);
+  TEST_ASSERT_EQUAL_UINT32(0, fix.time);
+}
+
+void setup()
+{
+  for (size_t p = 0; p + 1 < sizeof(ubxCapture) && frameCount < UBX_EPOCHS; p++)
+    if (ubxCapture[p] == 0xB5 && ubxCapture[p + 1] == 0x62)
+      frameAt[frameCount++] = p;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_capture_layout);
+  RUN_TEST(test_frames_decode);
+  RUN_TEST(test_capture_decodes);
+  RUN_TEST(test_frame_between_sentences);
+  RUN_TEST(test_bad_checksum);
+  RUN_TEST(test_truncated_frame_resyncs);
+  RUN_TEST(test_unresolved_date_time);
+  UNITY_END();
+}
+
+void loop()
+{
+}
@@ -0,0 +1,146 @@
+#ifndef UBX_CAPTURE_H
+#define UBX_CAPTURE_H
+
+// Five 1 Hz epochs of a recorded drive, laid out as a u-blox receiver sends
+// them with NMEA RMC and GGA left on next to UBX NAV-PVT: RMC, GGA and then
+// a 100 byte NAV-PVT frame for the same fix. The NAV-PVT frames are encoded
+// from the recorded fixes, with the sub-second nano field a receiver reports.
+const uint8_t ubxCapture[] =
+{
+  0x24, 0x47, 0x50, 0x52, 0x4D, 0x43, 0x2C, 0x31, 0x32, 0x31, 0x30, 0x30,
+  0x30, 0x2E, 0x30, 0x30, 0x2C, 0x41, 0x2C, 0x33, 0x30, 0x31, 0x34, 0x2E,
+  0x30, 0x37, 0x30, 0x39, 0x2C, 0x4E, 0x2C, 0x30, 0x39, 0x37, 0x34, 0x38,
+  0x2E, 0x37, 0x33, 0x34, 0x33, 0x2C, 0x57, 0x2C, 0x31, 0x32, 0x2E, 0x30,
+  0x30, 0x2C, 0x37, 0x34, 0x2E, 0x30, 0x30, 0x2C, 0x31, 0x37, 0x30, 0x39,
+  0x32, 0x36, 0x2C, 0x2C, 0x2C, 0x41, 0x2A, 0x34, 0x43, 0x0D, 0x0A, 0x24,
+  0x47, 0x50, 0x47, 0x47, 0x41, 0x2C, 0x31, 0x32, 0x31, 0x30, 0x30, 0x30,
+  0x2E, 0x30, 0x30, 0x2C, 0x33, 0x30, 0x31, 0x34, 0x2E, 0x30, 0x37, 0x30,
+  0x39, 0x2C, 0x4E, 0x2C, 0x30, 0x39, 0x37, 0x34, 0x38, 0x2E, 0x37, 0x33,
+  0x34, 0x33, 0x2C, 0x57, 0x2C, 0x31, 0x2C, 0x30, 0x39, 0x2C, 0x30, 0x2E,
+  0x39, 0x2C, 0x32, 0x30, 0x30, 0x2E, 0x30, 0x2C, 0x4D, 0x2C, 0x2D, 0x32,
+  0x32, 0x2E, 0x35, 0x2C, 0x4D, 0x2C, 0x2C, 0x2A, 0x35, 0x46, 0x0D, 0x0A,
+  0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0xC0, 0xC5, 0x35, 0x17, 0xEA, 0x07,
+  0x09, 0x11, 0x0C, 0x0A, 0x00, 0x07, 0x19, 0x00, 0x00, 0x00, 0xC7, 0xCF,
+  0xFF, 0xFF, 0x03, 0x01, 0xEA, 0x09, 0x71, 0x09, 0xB3, 0xC5, 0xBE, 0x6B,
+  0x05, 0x12, 0x5C, 0xB5, 0x02, 0x00, 0x40, 0x0D, 0x03, 0x00, 0xC4, 0x09,
+  0x00, 0x00, 0xAC, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D, 0x18, 0x00, 0x00, 0x40, 0xEA,
+  0x70, 0x00, 0xA4, 0x01, 0x00, 0x00, 0xF0, 0x49, 0x02, 0x00, 0x7E, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x49, 0x49, 0x24, 0x47, 0x50, 0x52, 0x4D, 0x43, 0x2C, 0x31,
+  0x32, 0x31, 0x30, 0x30, 0x31, 0x2E, 0x30, 0x30, 0x2C, 0x41, 0x2C, 0x33,
+  0x30, 0x31, 0x34, 0x2E, 0x30, 0x37, 0x31, 0x38, 0x2C, 0x4E, 0x2C, 0x30,
+  0x39, 0x37, 0x34, 0x38, 0x2E, 0x37, 0x33, 0x30, 0x36, 0x2C, 0x57, 0x2C,
+  0x31, 0x32, 0x2E, 0x30, 0x30, 0x2C, 0x37, 0x34, 0x2E, 0x30, 0x30, 0x2C,
+  0x31, 0x37, 0x30, 0x39, 0x32, 0x36, 0x2C, 0x2C, 0x2C, 0x41, 0x2A, 0x34,
+  0x43, 0x0D, 0x0A, 0x24, 0x47, 0x50, 0x47, 0x47, 0x41, 0x2C, 0x31, 0x32,
+  0x31, 0x30, 0x30, 0x31, 0x2E, 0x30, 0x30, 0x2C, 0x33, 0x30, 0x31, 0x34,
+  0x2E, 0x30, 0x37, 0x31, 0x38, 0x2C, 0x4E, 0x2C, 0x30, 0x39, 0x37, 0x34,
+  0x38, 0x2E, 0x37, 0x33, 0x30, 0x36, 0x2C, 0x57, 0x2C, 0x31, 0x2C, 0x30,
+  0x39, 0x2C, 0x30, 0x2E, 0x39, 0x2C, 0x32, 0x30, 0x30, 0x2E, 0x30, 0x2C,
+  0x4D, 0x2C, 0x2D, 0x32, 0x32, 0x2E, 0x35, 0x2C, 0x4D, 0x2C, 0x2C, 0x2A,
+  0x35, 0x46, 0x0D, 0x0A, 0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0xA8, 0xC9,
+  0x35, 0x17, 0xEA, 0x07, 0x09, 0x11, 0x0C, 0x0A, 0x01, 0x07, 0x19, 0x00,
+  0x00, 0x00, 0x73, 0x10, 0x00, 0x00, 0x03, 0x01, 0xEA, 0x09, 0xD9, 0x0B,
+  0xB3, 0xC5, 0x54, 0x6C, 0x05, 0x12, 0x5C, 0xB5, 0x02, 0x00, 0x40, 0x0D,
+  0x03, 0x00, 0xC4, 0x09, 0x00, 0x00, 0xAC, 0x0D, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D, 0x18,
+  0x00, 0x00, 0x40, 0xEA, 0x70, 0x00, 0xA4, 0x01, 0x00, 0x00, 0xF0, 0x49,
+  0x02, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0xFA, 0x24, 0x47, 0x50, 0x52,
+  0x4D, 0x43, 0x2C, 0x31, 0x32, 0x31, 0x30, 0x30, 0x32, 0x2E, 0x30, 0x30,
+  0x2C, 0x41, 0x2C, 0x33, 0x30, 0x31, 0x34, 0x2E, 0x30, 0x37, 0x32, 0x38,
+  0x2C, 0x4E, 0x2C, 0x30, 0x39, 0x37, 0x34, 0x38, 0x2E, 0x37, 0x32, 0x36,
+  0x39, 0x2C, 0x57, 0x2C, 0x31, 0x32, 0x2E, 0x30, 0x30, 0x2C, 0x37, 0x34,
+  0x2E, 0x30, 0x30, 0x2C, 0x31, 0x37, 0x30, 0x39, 0x32, 0x36, 0x2C, 0x2C,
+  0x2C, 0x41, 0x2A, 0x34, 0x34, 0x0D, 0x0A, 0x24, 0x47, 0x50, 0x47, 0x47,
+  0x41, 0x2C, 0x31, 0x32, 0x31, 0x30, 0x30, 0x32, 0x2E, 0x30, 0x30, 0x2C,
+  0x33, 0x30, 0x31, 0x34, 0x2E, 0x30, 0x37, 0x32, 0x38, 0x2C, 0x4E, 0x2C,
+  0x30, 0x39, 0x37, 0x34, 0x38, 0x2E, 0x37, 0x32, 0x36, 0x39, 0x2C, 0x57,
+  0x2C, 0x31, 0x2C, 0x30, 0x39, 0x2C, 0x30, 0x2E, 0x39, 0x2C, 0x32, 0x30,
+  0x30, 0x2E, 0x30, 0x2C, 0x4D, 0x2C, 0x2D, 0x32, 0x32, 0x2E, 0x35, 0x2C,
+  0x4D, 0x2C, 0x2C, 0x2A, 0x35, 0x37, 0x0D, 0x0A, 0xB5, 0x62, 0x01, 0x07,
+  0x5C, 0x00, 0x90, 0xCD, 0x35, 0x17, 0xEA, 0x07, 0x09, 0x11, 0x0C, 0x0A,
+  0x02, 0x07, 0x19, 0x00, 0x00, 0x00, 0x80, 0xD1, 0xF0, 0x08, 0x03, 0x01,
+  0xEA, 0x09, 0x42, 0x0E, 0xB3, 0xC5, 0xFB, 0x6C, 0x05, 0x12, 0x5C, 0xB5,
+  0x02, 0x00, 0x40, 0x0D, 0x03, 0x00, 0xC4, 0x09, 0x00, 0x00, 0xAC, 0x0D,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x1D, 0x18, 0x00, 0x00, 0x40, 0xEA, 0x70, 0x00, 0xA4, 0x01,
+  0x00, 0x00, 0xF0, 0x49, 0x02, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xEC, 0x94,
+  0x24, 0x47, 0x50, 0x52, 0x4D, 0x43, 0x2C, 0x31, 0x32, 0x31, 0x30, 0x30,
+  0x33, 0x2E, 0x30, 0x30, 0x2C, 0x41, 0x2C, 0x33, 0x30, 0x31, 0x34, 0x2E,
+  0x30, 0x37, 0x33, 0x37, 0x2C, 0x4E, 0x2C, 0x30, 0x39, 0x37, 0x34, 0x38,
+  0x2E, 0x37, 0x32, 0x33, 0x32, 0x2C, 0x57, 0x2C, 0x31, 0x32, 0x2E, 0x30,
+  0x30, 0x2C, 0x37, 0x34, 0x2E, 0x30, 0x30, 0x2C, 0x31, 0x37, 0x30, 0x39,
+  0x32, 0x36, 0x2C, 0x2C, 0x2C, 0x41, 0x2A, 0x34, 0x35, 0x0D, 0x0A, 0x24,
+  0x47, 0x50, 0x47, 0x47, 0x41, 0x2C, 0x31, 0x32, 0x31, 0x30, 0x30, 0x33,
+  0x2E, 0x30, 0x30, 0x2C, 0x33, 0x30, 0x31, 0x34, 0x2E, 0x30, 0x37, 0x33,
+  0x37, 0x2C, 0x4E, 0x2C, 0x30, 0x39, 0x37, 0x34, 0x38, 0x2E, 0x37, 0x32,
+  0x33, 0x32, 0x2C, 0x57, 0x2C, 0x31, 0x2C, 0x30, 0x39, 0x2C, 0x30, 0x2E,
+  0x39, 0x2C, 0x32, 0x30, 0x30, 0x2E, 0x30, 0x2C, 0x4D, 0x2C, 0x2D, 0x32,
+  0x32, 0x2E, 0x35, 0x2C, 0x4D, 0x2C, 0x2C, 0x2A, 0x35, 0x36, 0x0D, 0x0A,
+  0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x78, 0xD1, 0x35, 0x17, 0xEA, 0x07,
+  0x09, 0x11, 0x0C, 0x0A, 0x03, 0x07, 0x19, 0x00, 0x00, 0x00, 0xDD, 0xFC,
+  0xFF, 0xFF, 0x03, 0x01, 0xEA, 0x09, 0xAB, 0x10, 0xB3, 0xC5, 0x91, 0x6D,
+  0x05, 0x12, 0x5C, 0xB5, 0x02, 0x00, 0x40, 0x0D, 0x03, 0x00, 0xC4, 0x09,
+  0x00, 0x00, 0xAC, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D, 0x18, 0x00, 0x00, 0x40, 0xEA,
+  0x70, 0x00, 0xA4, 0x01, 0x00, 0x00, 0xF0, 0x49, 0x02, 0x00, 0x7E, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x69, 0xD5, 0x24, 0x47, 0x50, 0x52, 0x4D, 0x43, 0x2C, 0x31,
+  0x32, 0x31, 0x30, 0x30, 0x34, 0x2E, 0x30, 0x30, 0x2C, 0x41, 0x2C, 0x33,
+  0x30, 0x31, 0x34, 0x2E, 0x30, 0x37, 0x34, 0x36, 0x2C, 0x4E, 0x2C, 0x30,
+  0x39, 0x37, 0x34, 0x38, 0x2E, 0x37, 0x31, 0x39, 0x35, 0x2C, 0x57, 0x2C,
+  0x31, 0x32, 0x2E, 0x30, 0x30, 0x2C, 0x37, 0x34, 0x2E, 0x30, 0x30, 0x2C,
+  0x31, 0x37, 0x30, 0x39, 0x32, 0x36, 0x2C, 0x2C, 0x2C, 0x41, 0x2A, 0x34,
+  0x41, 0x0D, 0x0A, 0x24, 0x47, 0x50, 0x47, 0x47, 0x41, 0x2C, 0x31, 0x32,
+  0x31, 0x30, 0x30, 0x34, 0x2E, 0x30, 0x30, 0x2C, 0x33, 0x30, 0x31, 0x34,
+  0x2E, 0x30, 0x37, 0x34, 0x36, 0x2C, 0x4E, 0x2C, 0x30, 0x39, 0x37, 0x34,
+  0x38, 0x2E, 0x37, 0x31, 0x39, 0x35, 0x2C, 0x57, 0x2C, 0x31, 0x2C, 0x30,
+  0x39, 0x2C, 0x30, 0x2E, 0x39, 0x2C, 0x32, 0x30, 0x30, 0x2E, 0x30, 0x2C,
+  0x4D, 0x2C, 0x2D, 0x32, 0x32, 0x2E, 0x35, 0x2C, 0x4D, 0x2C, 0x2C, 0x2A,
+  0x35, 0x39, 0x0D, 0x0A, 0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x60, 0xD5,
+  0x35, 0x17, 0xEA, 0x07, 0x09, 0x11, 0x0C, 0x0A, 0x04, 0x07, 0x19, 0x00,
+  0x00, 0x00, 0x94, 0x26, 0x00, 0x00, 0x03, 0x01, 0xEA, 0x09, 0x13, 0x13,
+  0xB3, 0xC5, 0x27, 0x6E, 0x05, 0x12, 0x5C, 0xB5, 0x02, 0x00, 0x40, 0x0D,
+  0x03, 0x00, 0xC4, 0x09, 0x00, 0x00, 0xAC, 0x0D, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D, 0x18,
+  0x00, 0x00, 0x40, 0xEA, 0x70, 0x00, 0xA4, 0x01, 0x00, 0x00, 0xF0, 0x49,
+  0x02, 0x00, 0x7E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3B, 0x50,
+};
+
+// What NAV-PVT decodes to for each epoch, in TinyGPSFix units
+struct UbxExpected
+{
+  uint32_t date, time;
+  int32_t latE7, lngE7, altitude, speed, course;
+  uint32_t satellites;
+  int32_t hdop;
+};
+
+const UbxExpected ubxExpected[] =
+{
+  {170926, 12100000, 302345150, -978122383, 20000, 1199, 7400, 9, 126},
+  {170926, 12100100, 302345300, -978121767, 20000, 1199, 7400, 9, 126},
+  {170926, 12100215, 302345467, -978121150, 20000, 1199, 7400, 9, 126},
+  {170926, 12100300, 302345617, -978120533, 20000, 1199, 7400, 9, 126},
+  {170926, 12100400, 302345767, -978119917, 20000, 1199, 7400, 9, 126},
+};
+
+// A NAV-PVT frame sent before the receiver has resolved the date, time or a fix
+const uint8_t ubxNoDate[] =
+{
+  0xB5, 0x62, 0x01, 0x07, 0x5C, 0x00, 0x48, 0xD9, 0x35, 0x17, 0xEA, 0x07,
+  0x09, 0x11, 0x0C, 0x0A, 0x05, 0x00, 0x19, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0xEA, 0x09, 0x13, 0x13, 0xB3, 0xC5, 0x27, 0x6E,
+  0x05, 0x12, 0x5C, 0xB5, 0x02, 0x00, 0x40, 0x0D, 0x03, 0x00, 0xC4, 0x09,
+  0x00, 0x00, 0xAC, 0x0D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1D, 0x18, 0x00, 0x00, 0x40, 0xEA,
+  0x70, 0x00, 0xA4, 0x01, 0x00, 0x00, 0xF0, 0x49, 0x02, 0x00, 0x7E, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x63, 0x06,
+};
+
+#endif
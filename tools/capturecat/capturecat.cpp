@@ -0,0 +1,121 @@
+/*
+  Reads the firmware's raw receiver captures (include/CaptureFormat.h).
+
+  Build from the repository root:
+    g++ -std=c++11 -O2 -Iinclude tools/capturecat/capturecat.cpp -o capturecat
+
+  Usage:
+    capturecat [-t] file.gcap ... > out
+  Writes the bytes the receiver sent, e.g. to feed the native build or
+  any NMEA tool. With -t it lists the frames instead: the millis() stamp,
+  the gap since the previous frame, the length and whether bytes were
+  lost before it. A summary goes to standard error.
+*/
+
+#include "CaptureFormat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void usage()
+{
+  fprintf(stderr, "usage: capturecat [-t] file.gcap ...\n");
+  exit(2);
+}
+
+// Returns false if the file is not a capture
+static bool dump(FILE *in, const char *name, bool timing)
+{
+  CaptureHeader header;
+  if (fread(&header, sizeof(header), 1, in) != 1 || !captureCheckHeader(header))
+  {
+    fprintf(stderr, "capturecat: %s is not a capture\n", name);
+    return false;
+  }
+
+  // Skip any header fields a later version added
+  for (int skip = header.headerSize - (int)sizeof(header); skip > 0; skip--)
+    fgetc(in);
+
+  // A preallocated capture that was not closed cleanly ends before the file does
+  unsigned long left = header.length > header.headerSize ? header.length - header.headerSize
+                       : header.length > 0               ? 0
+                                                         : ~0UL;
+
+  unsigned long frames = 0, bytes = 0, gaps = 0;
+  uint32_t first = 0, last = 0;
+  uint8_t buf[65536];
+  uint8_t head[256];
+
+  while (left >= header.frameHeaderSize && fread(head, header.frameHeaderSize, 1, in) == 1)
+  {
+    CaptureFrame frame;
+    memcpy(&frame, head, sizeof(frame));
+    if (frame.sync != CAPTURE_SYNC)
+    {
+      fprintf(stderr, "capturecat: %s: bad frame after %lu bytes, stopping\n", name, bytes);
+      break;
+    }
+
+    left -= header.frameHeaderSize;
+    if (left < frame.length || fread(buf, 1, frame.length, in) != frame.length)
+    {
+      fprintf(stderr, "capturecat: %s: last frame is torn\n", name);
+      break;
+    }
+
+    if (frames == 0)
+      first = last = frame.millis;
+
+    if (timing)
+      printf("%10lu ms %+7ld ms %5u bytes%s\n", (unsigned long)frame.millis,
+             (long)(frame.millis - last), frame.length,
+             frame.flags & CAPTURE_FLAG_GAP ? "  after lost bytes" : "");
+    else
+      fwrite(buf, 1, frame.length, stdout);
+
+    left -= frame.length;
+    last = frame.millis;
+    frames++;
+    bytes += frame.length;
+    gaps += (frame.flags & CAPTURE_FLAG_GAP) != 0;
+  }
+
+  fprintf(stderr, "capturecat: %s: %lu bytes at %lu baud in %lu frames over %.1f s, %lu gaps\n",
+          name, bytes, (unsigned long)header.baud, frames, (last - first) / 1000.0, gaps);
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  bool timing = false;
+  int first = 1;
+
+  if (argc > 1 && !strcmp(argv[1], "-t"))
+  {
+    timing = true;
+    first = 2;
+  }
+
+  if (first == argc)
+    usage();
+
+  int status = 0;
+  for (int i = first; i < argc; i++)
+  {
+    FILE *in = fopen(argv[i], "rb");
+    if (!in)
+    {
+      fprintf(stderr, "capturecat: cannot open %s\n", argv[i]);
+      status = 1;
+      continue;
+    }
+
+    if (!dump(in, argv[i], timing))
+      status = 1;
+    fclose(in);
+  }
+
+  return status;
+}
@@ -0,0 +1,200 @@
+/*
+  Compares logging policies on about an hour of synthetic fixes at 1 Hz.
+
+  The fixes are parked, city driving with right-angle turns and traffic
+  lights, a motorway, another stop and a walk, with receiver noise on
+  position, speed and course. Each policy picks its records; fidelity is
+  how far the true path strays from the line through the logged points,
+  taken at every fix.
+
+  Build from the repository root:
+    g++ -std=c++11 -O2 -Iinclude tools/policybench/policybench.cpp src/LogPolicy.cpp -o policybench
+
+  Usage:
+    policybench [interval_ms]
+  interval_ms is the IntervalPolicy period, 20000 by default like the old
+  timer.
+*/
+
+#include "LogPolicy.h"
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+#define ORIGIN_LAT 30.2345
+#define ORIGIN_LNG -97.8123
+#define METERS_PER_DEG 111226.0 // same sphere as LogPolicy
+
+static std::mt19937 rng(4321);
+
+static double gauss(double sigma)
+{
+  return std::normal_distribution<double>(0, sigma)(rng);
+}
+
+struct Leg
+{
+  const char *what;
+  int seconds;
+  double speed; // m/s
+  double turn;  // degrees per second
+};
+
+struct Point
+{
+  double x, y; // true position, meters east and north of the origin
+};
+
+// A block with a right turn at the end of every 200 m, stopping at every other corner
+static void city(std::vector<Leg> &legs, int blocks)
+{
+  for (int i = 0; i < blocks; i++)
+  {
+    legs.push_back({"city", 16, 11, 0});
+    legs.push_back({"city", 2, 5, 0});
+    if (i % 2)
+      legs.push_back({"light", 40, 0, 0});
+    legs.push_back({"city", 6, 4, i % 3 ? 15.0 : -15.0});
+  }
+}
+
+static void makeHour(std::vector<TrackRecord> &fixes, std::vector<Point> &truth)
+{
+  std::vector<Leg> legs;
+  legs.push_back({"parked", 600, 0, 0});
+  city(legs, 30);
+  legs.push_back({"motorway", 300, 31, 0});
+  legs.push_back({"motorway", 600, 31, 0.05});
+  legs.push_back({"motorway", 300, 31, -0.1});
+  legs.push_back({"stopped", 300, 0, 0});
+  legs.push_back({"walk", 120, 1.4, 0});
+  legs.push_back({"walk", 10, 1.4, 9});
+  legs.push_back({"walk", 120, 1.4, 0});
+  legs.push_back({"walk", 10, 1.4, -9});
+  legs.push_back({"walk", 300, 1.4, 0.3});
+
+  double x = 0, y = 0, heading = 30, speed = 0;
+  double nx = 0, ny = 0;
+  int64_t time = trackTime(170926, 8000000);
+
+  for (size_t l = 0; l < legs.size(); l++)
+  {
+    for (int s = 0; s < legs[l].seconds; s++)
+    {
+      // Speed eases towards the leg's, as a car brakes and pulls away
+      speed += (legs[l].speed - speed) * 0.5;
+      if (speed < 0.05)
+        speed = 0;
+      heading = fmod(heading + legs[l].turn + 360, 360);
+      x += speed * sin(heading * M_PI / 180);
+      y += speed * cos(heading * M_PI / 180);
+
+      // Receiver noise wanders slowly, like multipath does
+      nx = nx * 0.95 + gauss(0.5);
+      ny = ny * 0.95 + gauss(0.5);
+
+      double lat = ORIGIN_LAT + (y + ny) / METERS_PER_DEG;
+      double lng = ORIGIN_LNG + (x + nx) / (METERS_PER_DEG * cos(ORIGIN_LAT * M_PI / 180));
+      double knots = fabs(speed + gauss(0.1)) / 0.514444;
+      double course = speed > 1 ? heading + gauss(2) : fmod(360 + gauss(90), 360);
+
+      TrackRecord r;
+      r.time = time;
+      r.latE7 = (int32_t)lround(lat * 1e7);
+      r.lngE7 = (int32_t)lround(lng * 1e7);
+      r.altitude = 20000;
+      r.speed = (uint16_t)lround(knots * 100);
+      r.course = (uint16_t)lround(fmod(course + 360, 360) * 100) % 36000;
+      r.hdop = 90;
+      r.satellites = 9;
+      r.flags = TRACK_FLAG_FIX | TRACK_FLAG_DATE;
+
+      fixes.push_back(r);
+      truth.push_back({x, y});
+      time += 1000;
+    }
+  }
+}
+
+static void toMeters(const TrackRecord &r, double &x, double &y)
+{
+  y = (r.latE7 / 1e7 - ORIGIN_LAT) * METERS_PER_DEG;
+  x = (r.lngE7 / 1e7 - ORIGIN_LNG) * METERS_PER_DEG * cos(ORIGIN_LAT * M_PI / 180);
+}
+
+static double segmentDistance(double px, double py, double ax, double ay, double bx, double by)
+{
+  double dx = bx - ax, dy = by - ay;
+  double len = dx * dx + dy * dy;
+  double t = len > 0 ? ((px - ax) * dx + (py - ay) * dy) / len : 0;
+  t = t < 0 ? 0 : t > 1 ? 1 : t;
+  return hypot(px - ax - t * dx, py - ay - t * dy);
+}
+
+static void run(const char *name, LogPolicy &policy, const std::vector<TrackRecord> &fixes,
+                const std::vector<Point> &truth)
+{
+  std::vector<size_t> kept;
+
+  Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < fixes.size(); i++)
+  {
+    TrackRecord rec = fixes[i];
+    if (policy.log(rec))
+      kept.push_back(i);
+  }
+  double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / fixes.size();
+
+  // Each true point against the segment between the logged fixes around it
+  double worst = 0, sum = 0;
+  size_t k = 0, end = kept.size() > 1 ? kept.back() + 1 : 0;
+  for (size_t i = 0; i < end; i++)
+  {
+    while (k + 2 < kept.size() && kept[k + 1] <= i)
+      k++;
+
+    double ax, ay, bx, by;
+    toMeters(fixes[kept[k]], ax, ay);
+    toMeters(fixes[kept[k + 1]], bx, by);
+    double d = segmentDistance(truth[i].x, truth[i].y, ax, ay, bx, by);
+    sum += d;
+    if (d > worst)
+      worst = d;
+  }
+
+  printf("%-10s %5u records %7.1f m worst %6.2f m mean %6.1f ns/fix\n", name, policy.logged(),
+         worst, end ? sum / end : 0, ns);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t interval = argc > 1 ? atoi(argv[1]) : 20000;
+  std::vector<TrackRecord> fixes;
+  std::vector<Point> truth;
+  makeHour(fixes, truth);
+
+  printf("%zu fixes\n\n", fixes.size());
+
+  EveryFixPolicy every;
+  IntervalPolicy timer(interval);
+  AdaptivePolicy adaptive;
+
+  run("every fix", every, fixes, truth);
+  run("interval", timer, fixes, truth);
+  run("adaptive", adaptive, fixes, truth);
+
+  static const char *names[] = {"", "first", "fix", "distance", "heading", "speed",
+                                "interval", "stop", "move"};
+  printf("\nadaptive:");
+  for (int r = LogPolicy::REASON_FIRST; r < LogPolicy::REASON_COUNT; r++)
+    printf(" %s %u", names[r], adaptive.loggedFor((LogPolicy::Reason)r));
+  printf("\n");
+
+  return 0;
+}
@@ -0,0 +1,193 @@
+/*
+  Host benchmark for GpsReceiver and its ring buffer.
+
+  A writer thread plays synthetic NMEA into a pipe at a given baud rate,
+  the receiver thread moves it into the ring, and the main thread drains
+  the ring like the Arduino loop does, checking every sentence and
+  stalling now and then the way an SD write or full redraw would.
+
+  Build from the repository root:
+    g++ -std=c++11 -O2 -pthread -Iinclude tools/ringbench/ringbench.cpp src/GpsReceiver.cpp -o ringbench
+
+  Usage:
+    ringbench [baud] [seconds] [stall_ms] [stall_every_ms]
+  A baud of 0 writes as fast as the pipe allows and reports throughput.
+*/
+
+#include "GpsReceiver.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static int makeSentence(char *out, size_t size, unsigned n)
+{
+  char body[96];
+  snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.000,3014.%04u,N,09749.%04u,W,1,09,1.2,211.6,M,-22.5,M,,0000",
+           (n / 3600) % 24, (n / 60) % 60, n % 60, n % 10000, (n * 7) % 10000);
+
+  unsigned char sum = 0;
+  for (const char *p = body; *p; p++)
+    sum ^= (unsigned char)*p;
+
+  return snprintf(out, size, "$%s*%02X\r\n", body, sum);
+}
+
+// Checks sentences as they come out of the ring, split anywhere
+class SentenceCounter
+{
+public:
+  SentenceCounter() : good(0), bad(0), length(0) {}
+
+  void feed(const char *buf, size_t len)
+  {
+    for (size_t i = 0; i < len; i++)
+    {
+      char c = buf[i];
+      if (c == '$')
+        length = 0;
+      if (length < sizeof(line) - 1)
+        line[length++] = c;
+      if (c == '\n')
+        check();
+    }
+  }
+
+  unsigned good, bad;
+
+private:
+  void check()
+  {
+    line[length] = 0;
+    const char *star = strchr(line, '*');
+    if (line[0] != '$' || !star)
+    {
+      bad++;
+      length = 0;
+      return;
+    }
+
+    unsigned char sum = 0;
+    for (const char *p = line + 1; p < star; p++)
+      sum ^= (unsigned char)*p;
+
+    if (strtoul(star + 1, NULL, 16) == sum)
+      good++;
+    else
+      bad++;
+    length = 0;
+  }
+
+  char line[128];
+  size_t length;
+};
+
+int main(int argc, char **argv)
+{
+  long baud = argc > 1 ? atol(argv[1]) : 115200;
+  double seconds = argc > 2 ? atof(argv[2]) : 5;
+  long stallMs = argc > 3 ? atol(argv[3]) : 300;
+  long stallEveryMs = argc > 4 ? atol(argv[4]) : 1000;
+
+  int fds[2];
+  if (pipe(fds) != 0)
+  {
+    perror("pipe");
+    return 1;
+  }
+
+  GpsReceiver receiver;
+  receiver.begin(fds[0]);
+
+  unsigned long long sent = 0;
+  unsigned sentences = 0;
+  std::atomic<bool> writerDone(false);
+
+  std::thread writer([&] {
+    // 10 bits per byte on the wire, 8N1
+    double bytesPerSecond = baud / 10.0;
+    char sentence[128];
+    Clock::time_point start = Clock::now();
+
+    while (secondsSince(start) < seconds)
+    {
+      int len = makeSentence(sentence, sizeof(sentence), sentences);
+      if (write(fds[1], sentence, len) != len)
+        break;
+      sent += len;
+      sentences++;
+
+      if (baud > 0)
+      {
+        double due = sent / bytesPerSecond;
+        double now = secondsSince(start);
+        if (due > now)
+          usleep((useconds_t)((due - now) * 1e6));
+      }
+    }
+    close(fds[1]);
+    writerDone = true;
+  });
+
+  SentenceCounter counter;
+  char buf[64];
+  unsigned long long drained = 0;
+  Clock::time_point start = Clock::now();
+  Clock::time_point lastStall = start;
+
+  for (;;)
+  {
+    size_t n = receiver.read(buf, sizeof(buf));
+    if (n > 0)
+    {
+      counter.feed(buf, n);
+      drained += n;
+      continue;
+    }
+
+    if (writerDone)
+    {
+      // The receiver sees end of file once the pipe is empty
+      receiver.end();
+      if (receiver.available() == 0)
+        break;
+      continue;
+    }
+
+    if (stallMs > 0 && secondsSince(lastStall) * 1000 >= stallEveryMs)
+    {
+      // Pretend to be busy with the SD card or the display
+      usleep(stallMs * 1000);
+      lastStall = Clock::now();
+    }
+    else
+    {
+      usleep(200);
+    }
+  }
+
+  double elapsed = secondsSince(start);
+  writer.join();
+
+  printf("baud %ld, %.1f s, stall %ld ms every %ld ms, ring %u bytes\n",
+         baud, elapsed, stallMs, stallEveryMs, (unsigned)GPS_RING_SIZE);
+  printf("sent      %llu bytes, %u sentences\n", sent, sentences);
+  printf("received  %u bytes, drained %llu\n", receiver.bytesReceived(), drained);
+  printf("dropped   %u bytes in %u overflows, high water %u bytes\n",
+         receiver.bytesDropped(), receiver.overflows(), receiver.highWater());
+  printf("sentences %u good, %u bad\n", counter.good, counter.bad);
+  if (baud == 0)
+    printf("throughput %.1f MB/s\n", drained / elapsed / 1e6);
+
+  return 0;
+}
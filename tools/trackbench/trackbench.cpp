@@ -0,0 +1,459 @@
+/*
+  Round trip, damage and throughput checks for the track delta codec.
+
+  Synthetic tracks (driving, walking, standing still, at 1, 5 and 10 Hz,
+  plus awkward values) are encoded and decoded and must come back bit for
+  bit. The size per record is compared with the fixed records and with
+  the CSV rows the firmware used to write. Then bytes are flipped in an
+  encoded stream to check that the decoder picks up again at the next
+  keyframe, and a million records are timed each way. Last, random
+  times are looked up in logs of an hour to a week, through the sidecar
+  index (LogIndex.h) and by scanning, to show the indexed seek staying
+  flat as the log grows. Finally the journal's CRC-32 (LogJournal.h) is
+  checked against the standard check value and timed against a byte at a
+  time, and finding the end of journaled logs of a day and a week from
+  their tail is timed against checking every frame.
+
+  Build from the repository root:
+    g++ -std=c++11 -O2 -Iinclude tools/trackbench/trackbench.cpp src/TrackCodec.cpp -o trackbench
+
+  Usage:
+    trackbench [keyframe_interval]
+  Exits non-zero if any round trip differs.
+*/
+
+#include "LogIndex.h"
+#include "LogJournal.h"
+#include "TrackCodec.h"
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static std::mt19937 rng(12345);
+
+static double secondsSince(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static double uniform(double lo, double hi)
+{
+  return std::uniform_real_distribution<double>(lo, hi)(rng);
+}
+
+/*
+  A vehicle at speed m/s turning at turn degrees/s, sampled at hz, with a
+  random walk of noise meters on the position like a real receiver.
+*/
+static std::vector<TrackRecord> makeTrack(size_t count, double hz, double speed, double turn,
+                                          double noise)
+{
+  std::vector<TrackRecord> track(count);
+  double lat = 30.2345, lng = -97.8123, alt = 200, course = 10;
+  double nLat = 0, nLng = 0;
+  int64_t time = trackTime(170926, 12000000);
+
+  for (size_t i = 0; i < count; i++)
+  {
+    double dt = 1 / hz;
+    double meters = speed * dt;
+    course = fmod(course + turn * dt + 360, 360);
+    lat += meters * cos(course * M_PI / 180) / 111320;
+    lng += meters * sin(course * M_PI / 180) / (111320 * cos(lat * M_PI / 180));
+    alt += uniform(-0.05, 0.05);
+    nLat = nLat * 0.9 + uniform(-noise, noise) / 111320;
+    nLng = nLng * 0.9 + uniform(-noise, noise) / 96000;
+
+    TrackRecord &r = track[i];
+    r.time = time + (int64_t)(i * 1000 / hz);
+    r.latE7 = (int32_t)lround((lat + nLat) * 1e7);
+    r.lngE7 = (int32_t)lround((lng + nLng) * 1e7);
+    r.altitude = (int32_t)lround(alt * 100);
+    r.speed = (uint16_t)lround(speed / 0.514444 * 100 + uniform(-3, 3) * (speed > 0));
+    r.course = speed > 0 ? (uint16_t)lround(course * 100) : 0;
+    r.hdop = i % 97 == 0 ? 120 : 90;
+    r.satellites = i % 331 < 10 ? 8 : 9;
+    r.flags = TRACK_FLAG_FIX | TRACK_FLAG_DATE;
+  }
+
+  return track;
+}
+
+// Values at the edges of every field and jumps in time
+static std::vector<TrackRecord> makeAwkward()
+{
+  std::vector<TrackRecord> track;
+  const int32_t lats[] = {900000000, -900000000, 0, 1, -1, 899999999};
+  const int32_t lngs[] = {1800000000, -1800000000, 0, -1799999999, 1799999999, 1};
+  const int64_t times[] = {0, 86399990, trackTime(10100, 0), trackTime(311299, 23595999),
+                           trackTime(280224, 12000000), -1};
+
+  for (int i = 0; i < 200; i++)
+  {
+    TrackRecord r;
+    r.time = times[i % 6] + i;
+    r.latE7 = lats[i % 6];
+    r.lngE7 = lngs[(i / 6) % 6];
+    r.altitude = i % 2 ? 2147483647 : -2147483647 - 1;
+    r.speed = i % 3 ? 65535 : 0;
+    r.course = i % 2 ? 35999 : 0;
+    r.hdop = i % 5 ? 9999 : 0;
+    r.satellites = i;
+    r.flags = i % 4;
+    track.push_back(r);
+  }
+
+  return track;
+}
+
+// What writeRoot() printed per fix before the binary log
+static size_t csvBytes(const std::vector<TrackRecord> &track)
+{
+  size_t total = 0;
+  char row[256];
+  unsigned long chars = 0, sentences = 0;
+
+  for (size_t i = 0; i < track.size(); i++)
+  {
+    const TrackRecord &r = track[i];
+    int64_t ms = r.time % 86400000;
+    chars += 400;
+    sentences += 2;
+    total += snprintf(row, sizeof(row), "1,%u,%.2f,%.2f,%.2f,%u,9/17/2026,%d:%d:%d,%.2f,%.2f,%.2f,%lu,%lu,0\r\n",
+                      r.satellites, r.hdop / 100.0, r.latE7 / 1e7, r.lngE7 / 1e7, 120u,
+                      (int)(ms / 3600000), (int)(ms / 60000 % 60), (int)(ms / 1000 % 60),
+                      r.altitude / 100.0, r.course / 100.0, r.speed * 0.01852, chars, sentences);
+  }
+
+  return total;
+}
+
+static std::vector<uint8_t> encodeAll(const std::vector<TrackRecord> &track, uint16_t interval)
+{
+  TrackEncoder encoder(interval);
+  std::vector<uint8_t> out;
+  uint8_t frame[TRACK_MAX_FRAME];
+
+  for (size_t i = 0; i < track.size(); i++)
+  {
+    size_t n = encoder.encode(track[i], frame);
+    out.insert(out.end(), frame, frame + n);
+  }
+
+  return out;
+}
+
+static std::vector<TrackRecord> decodeAll(const std::vector<uint8_t> &data, TrackDecoder &decoder)
+{
+  std::vector<TrackRecord> out;
+  size_t pos = 0;
+
+  while (pos < data.size())
+  {
+    TrackRecord rec;
+    bool have;
+    size_t n = decoder.decode(&data[pos], data.size() - pos, rec, have);
+    if (n == 0)
+      break;
+
+    pos += n;
+    if (have)
+      out.push_back(rec);
+  }
+
+  return out;
+}
+
+static bool sameRecord(const TrackRecord &a, const TrackRecord &b)
+{
+  return memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+static bool roundTrip(const char *name, const std::vector<TrackRecord> &track, uint16_t interval)
+{
+  std::vector<uint8_t> data = encodeAll(track, interval);
+  TrackDecoder decoder;
+  std::vector<TrackRecord> back = decodeAll(data, decoder);
+
+  bool ok = back.size() == track.size();
+  for (size_t i = 0; ok && i < track.size(); i++)
+    ok = sameRecord(track[i], back[i]);
+
+  double perRecord = (double)data.size() / track.size();
+  printf("%-22s %6zu records %8.2f bytes each %6.1fx fixed %6.1fx CSV  %s\n", name, track.size(),
+         perRecord, sizeof(TrackRecord) / perRecord, csvBytes(track) / (double)data.size(),
+         ok ? "ok" : "MISMATCH");
+
+  return ok;
+}
+
+// Flips a byte every so often and checks what comes out of the decoder
+static void damage(const std::vector<TrackRecord> &track, uint16_t interval, size_t every)
+{
+  std::vector<uint8_t> data = encodeAll(track, interval);
+  size_t flips = 0;
+
+  for (size_t pos = every / 2; pos < data.size(); pos += every)
+  {
+    data[pos] ^= 1 << (rng() % 8);
+    flips++;
+  }
+
+  TrackDecoder decoder;
+  std::vector<TrackRecord> back = decodeAll(data, decoder);
+
+  // Match decoded records to the originals by time, which only grows
+  size_t good = 0, wrong = 0, j = 0;
+  for (size_t i = 0; i < back.size(); i++)
+  {
+    while (j < track.size() && track[j].time < back[i].time)
+      j++;
+
+    if (j < track.size() && sameRecord(track[j], back[i]))
+      good++;
+    else
+      wrong++;
+  }
+
+  printf("%zu flips in %zu bytes: %zu of %zu records intact, %zu wrong, %lu resyncs, %lu bytes skipped\n",
+         flips, data.size(), good, track.size(), wrong, (unsigned long)decoder.resyncs(),
+         (unsigned long)decoder.skippedBytes());
+}
+
+static void throughput(const std::vector<TrackRecord> &track, uint16_t interval)
+{
+  Clock::time_point start = Clock::now();
+  std::vector<uint8_t> data = encodeAll(track, interval);
+  double encodeSeconds = secondsSince(start);
+
+  TrackDecoder decoder;
+  start = Clock::now();
+  std::vector<TrackRecord> back = decodeAll(data, decoder);
+  double decodeSeconds = secondsSince(start);
+
+  printf("encode %.1f M records/s, decode %.1f M records/s (%zu records, %.1f MB/s decoded)\n",
+         track.size() / encodeSeconds / 1e6, back.size() / decodeSeconds / 1e6, track.size(),
+         data.size() / decodeSeconds / 1e6);
+}
+
+/*
+  Decodes from offset until the first record at or after time, returns
+  the records decoded to get there.
+*/
+static size_t decodeUntil(const std::vector<uint8_t> &data, size_t offset, int64_t time)
+{
+  TrackDecoder decoder;
+  size_t records = 0;
+
+  while (offset < data.size())
+  {
+    TrackRecord rec;
+    bool have;
+    size_t n = decoder.decode(&data[offset], data.size() - offset, rec, have);
+    if (n == 0)
+      break;
+
+    offset += n;
+    if (have && (records++, rec.time >= time))
+      break;
+  }
+
+  return records;
+}
+
+// Random lookups in a log of count records, with the index LogWriter keeps and without
+static void seeks(size_t count, uint16_t interval)
+{
+  std::vector<TrackRecord> track = makeTrack(count, 1, 15, 2, 1.5);
+
+  // What writeRoot() does: an entry for every keyframe
+  TrackEncoder encoder(interval);
+  std::vector<uint8_t> data;
+  std::vector<LogIndexEntry> index;
+  uint8_t frame[TRACK_MAX_FRAME];
+  for (size_t i = 0; i < track.size(); i++)
+  {
+    size_t n = encoder.encode(track[i], frame);
+    if (encoder.lastWasKeyframe())
+      index.push_back({track[i].time, (uint32_t)data.size()});
+    data.insert(data.end(), frame, frame + n);
+  }
+
+  const int lookups = 200;
+  std::vector<int64_t> targets;
+  for (int i = 0; i < lookups; i++)
+    targets.push_back(track[rng() % count].time);
+
+  size_t probes = 0, indexed = 0;
+  Clock::time_point start = Clock::now();
+  for (int64_t t : targets)
+  {
+    LogIndexEntry entry;
+    auto read = [&](uint32_t i, LogIndexEntry &e)
+    {
+      probes++;
+      e = index[i];
+      return true;
+    };
+    size_t offset = logIndexFind(index.size(), t, read, entry) ? entry.offset : 0;
+    indexed += decodeUntil(data, offset, t);
+  }
+  double indexSeconds = secondsSince(start);
+
+  size_t scanned = 0;
+  start = Clock::now();
+  for (int64_t t : targets)
+    scanned += decodeUntil(data, 0, t);
+  double scanSeconds = secondsSince(start);
+
+  printf("%7zu records, %5zu entries: indexed %4.1f probes %5.1f records %7.2f us, "
+         "scan %9.1f records %8.1f us\n",
+         count, index.size(), (double)probes / lookups, (double)indexed / lookups,
+         indexSeconds / lookups * 1e6, (double)scanned / lookups, scanSeconds / lookups * 1e6);
+}
+
+// The CRC a table lookup per byte, as the slice-by-8 one is measured against
+static uint32_t crcBytewise(uint32_t crc, const uint8_t *p, size_t len)
+{
+  const uint32_t *t = logCrcTable().t[0];
+  crc = ~crc;
+  while (len--)
+    crc = t[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+static bool crcs()
+{
+  bool ok = logCrc32(0, "123456789", 9) == 0xCBF43926;
+
+  std::vector<uint8_t> data(4 << 20);
+  for (size_t i = 0; i < data.size(); i++)
+    data[i] = rng();
+  ok &= logCrc32(0, data.data(), data.size()) == crcBytewise(0, data.data(), data.size());
+
+  const int rounds = 20;
+  volatile uint32_t sink = 0;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < rounds; i++)
+    sink ^= crcBytewise(0, data.data(), data.size());
+  double bytewiseSeconds = secondsSince(start);
+
+  start = Clock::now();
+  for (int i = 0; i < rounds; i++)
+    sink ^= logCrc32(0, data.data(), data.size());
+  double sliceSeconds = secondsSince(start);
+
+  double mb = (double)data.size() * rounds / 1e6;
+  printf("crc32 %s: bytewise %.0f MB/s, slice-by-8 %.0f MB/s, %.1fx, a 4 KB block in %.2f us\n",
+         ok ? "ok" : "WRONG", mb / bytewiseSeconds, mb / sliceSeconds, bytewiseSeconds / sliceSeconds,
+         sliceSeconds / (mb * 1e6 / 4096) * 1e6);
+  return ok;
+}
+
+/*
+  A journaled log of count records at 1 Hz, flushed every 10 s as the
+  sketch does, with a torn last frame. Finds the last good frame from the
+  tail as LogWriter::open() does, and by checking every frame.
+*/
+static void recovery(size_t count, uint16_t interval)
+{
+  std::vector<TrackRecord> track = makeTrack(count, 1, 15, 2, 1.5);
+  TrackEncoder encoder(interval);
+  std::vector<uint8_t> data(sizeof(TrackHeader));
+  uint8_t chunk[10 * TRACK_MAX_FRAME];
+  uint32_t sequence = 0;
+
+  for (size_t i = 0; i < track.size(); i += 10)
+  {
+    size_t len = 0;
+    for (size_t j = i; j < i + 10 && j < track.size(); j++)
+      len += encoder.encode(track[j], chunk + len);
+
+    LogFrameHeader h;
+    logFrameInit(h, sequence++, chunk, len);
+    data.insert(data.end(), (uint8_t *)&h, (uint8_t *)&h + sizeof(h));
+    data.insert(data.end(), chunk, chunk + len);
+  }
+  size_t good = data.size();
+  data.resize(good + 40, 0xA5);
+
+  const int rounds = 20;
+  size_t tailEnd = 0, fullEnd = 0;
+  Clock::time_point start = Clock::now();
+  for (int r = 0; r < rounds; r++)
+  {
+    size_t from = data.size() > LOG_FRAME_MAX ? data.size() - LOG_FRAME_MAX : 0;
+    for (size_t p = data.size() - sizeof(LogFrameHeader) + 1; p-- > from;)
+    {
+      if (logFrameCheck(&data[p], data.size() - p))
+      {
+        LogFrameHeader h;
+        memcpy(&h, &data[p], sizeof(h));
+        tailEnd = p + sizeof(h) + h.length;
+        break;
+      }
+    }
+  }
+  double tailSeconds = secondsSince(start);
+
+  start = Clock::now();
+  for (int r = 0; r < rounds; r++)
+  {
+    size_t p = sizeof(TrackHeader);
+    while (logFrameCheck(&data[p], data.size() - p))
+    {
+      LogFrameHeader h;
+      memcpy(&h, &data[p], sizeof(h));
+      p += sizeof(h) + h.length;
+    }
+    fullEnd = p;
+  }
+  double fullSeconds = secondsSince(start);
+
+  printf("%7zu records, %5u frames, %8zu bytes: end from the tail %7.2f us, every frame %8.1f us%s\n",
+         count, sequence, data.size(), tailSeconds / rounds * 1e6, fullSeconds / rounds * 1e6,
+         tailEnd == good && fullEnd == good ? "" : " WRONG END");
+}
+
+int main(int argc, char **argv)
+{
+  uint16_t interval = argc > 1 ? atoi(argv[1]) : TRACK_KEYFRAME_INTERVAL;
+  bool ok = true;
+
+  printf("keyframe every %u records\n\n", interval);
+
+  ok &= roundTrip("drive 1 Hz", makeTrack(3600, 1, 15, 2, 1.5), interval);
+  ok &= roundTrip("drive 10 Hz", makeTrack(36000, 10, 15, 2, 1.5), interval);
+  ok &= roundTrip("walk 1 Hz", makeTrack(3600, 1, 1.4, 5, 2.5), interval);
+  ok &= roundTrip("walk 5 Hz", makeTrack(18000, 5, 1.4, 5, 2.5), interval);
+  ok &= roundTrip("stationary 1 Hz", makeTrack(3600, 1, 0, 0, 3), interval);
+  ok &= roundTrip("motorway 10 Hz", makeTrack(36000, 10, 33, 0.1, 0.5), interval);
+  ok &= roundTrip("awkward values", makeAwkward(), interval);
+  ok &= roundTrip("keyframe every 2nd", makeTrack(600, 1, 15, 2, 1.5), 1);
+
+  printf("\n");
+  std::vector<TrackRecord> drive = makeTrack(36000, 1, 15, 2, 1.5);
+  damage(drive, interval, 5000);
+  damage(drive, interval, 500);
+
+  printf("\n");
+  throughput(makeTrack(1000000, 10, 15, 2, 1.5), interval);
+
+  printf("\n");
+  seeks(3600, interval);
+  seeks(86400, interval);
+  seeks(7 * 86400, interval);
+
+  printf("\n");
+  ok &= crcs();
+  recovery(86400, interval);
+  recovery(7 * 86400, interval);
+
+  return ok ? 0 : 1;
+}
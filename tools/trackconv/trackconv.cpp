@@ -0,0 +1,536 @@
+/*
+  Converts the firmware's binary track logs (include/TrackFormat.h) to
+  CSV, GPX or GeoJSON, streaming one record at a time. Both the fixed
+  and the delta encoding are read; damage in a delta log is reported and
+  skipped up to the next keyframe. In a journaled log (LogJournal.h) only
+  frames whose CRC checks out are read, the rest is reported.
+
+  Build from the repository root:
+    g++ -std=c++11 -O2 -Iinclude tools/trackconv/trackconv.cpp src/TrackCodec.cpp -o trackconv
+
+  Usage:
+    trackconv [-f csv|gpx|geojson] [-s from] [-e to] [file.trk ...] > out
+  Reads standard input when no file is given. Several files are joined
+  into one track in the order given. CSV has every record, GPX and
+  GeoJSON only those with a fix.
+
+  -s and -e keep the records from one UTC time up to another, given as
+  2026-09-17T14:00[:00] or as a time of day such as 14:30, which applies
+  to the day of each file. A file's sidecar index (include/LogIndex.h),
+  e.g. 17092026.idx next to 17092026.trk, takes the reader straight to
+  the keyframe before the start and it stops after the end, so a range
+  costs the same however long the day's log is.
+*/
+
+#include "LogIndex.h"
+#include "LogJournal.h"
+#include "TrackCodec.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum Format
+{
+  FORMAT_CSV,
+  FORMAT_GPX,
+  FORMAT_GEOJSON
+};
+
+#define DAY_MS 86400000LL
+
+// A time limit of -s or -e, whole or as a time of day
+struct Limit
+{
+  int64_t ms;
+  bool timeOfDay;
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage: trackconv [-f csv|gpx|geojson] [-s from] [-e to] [file.trk ...]\n");
+  exit(2);
+}
+
+static bool parseLimit(const char *s, Limit &limit)
+{
+  int y, mo, d, h, mi, sec = 0;
+  char tail = 0;
+
+  if (sscanf(s, "%d-%d-%dT%d:%d:%d%c", &y, &mo, &d, &h, &mi, &sec, &tail) >= 5)
+  {
+    limit.ms = trackDaysFromCivil(y, mo, d) * DAY_MS + (h * 3600 + mi * 60 + sec) * 1000LL;
+    limit.timeOfDay = false;
+  }
+  else if (sscanf(s, "%d:%d:%d", &h, &mi, &sec) >= 2)
+  {
+    limit.ms = (h * 3600 + mi * 60 + sec) * 1000LL;
+    limit.timeOfDay = true;
+  }
+  else
+    return false;
+
+  return tail == 0 || tail == 'Z';
+}
+
+// ms since midnight, for comparing with a time of day
+static int64_t timeOfDay(int64_t ms)
+{
+  return (ms % DAY_MS + DAY_MS) % DAY_MS;
+}
+
+// The records -s and -e keep
+struct Range
+{
+  bool hasFrom, hasTo;
+  Limit from, to;
+
+  Range() : hasFrom(false), hasTo(false) {}
+
+  static int64_t key(const TrackRecord &rec, const Limit &limit)
+  {
+    return limit.timeOfDay ? timeOfDay(rec.time) : rec.time;
+  }
+
+  bool before(const TrackRecord &rec) const { return hasFrom && key(rec, from) < from.ms; }
+  bool after(const TrackRecord &rec) const { return hasTo && key(rec, to) > to.ms; }
+};
+
+// ISO 8601 UTC, or only the time of day when the record has no date
+static void formatTime(char *out, size_t size, const TrackRecord &rec)
+{
+  int64_t ms = rec.time;
+  int32_t days = (int32_t)(ms / 86400000);
+  int32_t msOfDay = (int32_t)(ms % 86400000);
+  if (msOfDay < 0)
+  {
+    msOfDay += 86400000;
+    days--;
+  }
+
+  char clock[16];
+  snprintf(clock, sizeof(clock), "%02d:%02d:%02d.%03d", msOfDay / 3600000, msOfDay / 60000 % 60,
+           msOfDay / 1000 % 60, msOfDay % 1000);
+
+  if (!(rec.flags & TRACK_FLAG_DATE))
+  {
+    snprintf(out, size, "%s", clock);
+    return;
+  }
+
+  int32_t y;
+  uint32_t m, d;
+  trackCivilFromDays(days, y, m, d);
+  snprintf(out, size, "%04d-%02u-%02uT%sZ", (int)y, m, d, clock);
+}
+
+// Degrees * 1e7 as a decimal string without going through a double
+static void formatE7(char *out, size_t size, int32_t e7)
+{
+  int64_t v = e7;
+  snprintf(out, size, "%s%" PRId64 ".%07" PRId64, v < 0 ? "-" : "", (v < 0 ? -v : v) / 10000000,
+           (v < 0 ? -v : v) % 10000000);
+}
+
+class Writer
+{
+public:
+  Writer(Format format) : format(format), points(0) {}
+
+  void begin()
+  {
+    switch (format)
+    {
+    case FORMAT_CSV:
+      printf("time,lat,lng,altitude_m,speed_kmph,course_deg,hdop,satellites,fix,stopped\n");
+      break;
+    case FORMAT_GPX:
+      printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+             "<gpx version=\"1.1\" creator=\"trackconv\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n"
+             "<trk><trkseg>\n");
+      break;
+    case FORMAT_GEOJSON:
+      printf("{\"type\":\"FeatureCollection\",\"features\":[\n");
+      break;
+    }
+  }
+
+  void record(const TrackRecord &rec)
+  {
+    bool hasFix = rec.flags & TRACK_FLAG_FIX;
+    char time[40], lat[16], lng[16];
+
+    if (format != FORMAT_CSV && !hasFix)
+      return;
+
+    formatTime(time, sizeof(time), rec);
+    formatE7(lat, sizeof(lat), rec.latE7);
+    formatE7(lng, sizeof(lng), rec.lngE7);
+
+    switch (format)
+    {
+    case FORMAT_CSV:
+      printf("%s,%s,%s,%.2f,%.2f,%.2f,%.2f,%u,%d,%d\n", time, lat, lng, rec.altitude / 100.0,
+             rec.speed * 0.0185200, rec.course / 100.0, rec.hdop / 100.0, rec.satellites, hasFix,
+             (rec.flags & TRACK_FLAG_STOPPED) != 0);
+      break;
+    case FORMAT_GPX:
+      printf("<trkpt lat=\"%s\" lon=\"%s\"><ele>%.2f</ele>", lat, lng, rec.altitude / 100.0);
+      if (rec.flags & TRACK_FLAG_DATE)
+        printf("<time>%s</time>", time);
+      printf("<sat>%u</sat><hdop>%.2f</hdop></trkpt>\n", rec.satellites, rec.hdop / 100.0);
+      break;
+    case FORMAT_GEOJSON:
+      printf("%s{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\",\"coordinates\":[%s,%s,%.2f]},"
+             "\"properties\":{\"time\":\"%s\",\"speed_kmph\":%.2f,\"course_deg\":%.2f,\"hdop\":%.2f,\"satellites\":%u}}",
+             points ? ",\n" : "", lng, lat, rec.altitude / 100.0, time, rec.speed * 0.0185200,
+             rec.course / 100.0, rec.hdop / 100.0, rec.satellites);
+      break;
+    }
+
+    points++;
+  }
+
+  void end()
+  {
+    switch (format)
+    {
+    case FORMAT_CSV:
+      break;
+    case FORMAT_GPX:
+      printf("</trkseg></trk>\n</gpx>\n");
+      break;
+    case FORMAT_GEOJSON:
+      printf("\n]}\n");
+      break;
+    }
+  }
+
+private:
+  Format format;
+  unsigned long points;
+};
+
+/*
+  The track's data from in, left bytes of the file at most. Of a journal
+  only the data of good frames comes out; damage is skipped up to the
+  next good frame, which works on standard input too as frames are
+  checked in a buffer of two.
+*/
+class Source
+{
+public:
+  Source(FILE *in, uint64_t left, bool framed)
+      : in(in), left(left), framed(framed), len(0), pos(0), frameLeft(0), sequence(0),
+        haveSequence(false), gap(false), bad(0)
+  {
+  }
+
+  // Up to size bytes, 0 at the end, from one frame at a time of a journal
+  size_t read(uint8_t *out, size_t size)
+  {
+    if (!framed)
+    {
+      size_t n = fread(out, 1, size < left ? size : left, in);
+      left -= n;
+      return n;
+    }
+
+    if (frameLeft == 0 && !nextFrame())
+      return 0;
+
+    size_t n = size < frameLeft ? size : frameLeft;
+    memcpy(out, buf + pos, n);
+    pos += n;
+    frameLeft -= n;
+    return n;
+  }
+
+  // True once if data was lost before what read() last returned
+  bool takeGap()
+  {
+    bool was = gap;
+    gap = false;
+    return was;
+  }
+
+  uint64_t badBytes() const { return bad; }
+
+private:
+  // At least want bytes from pos in buf, false if the file ends first
+  bool fill(size_t want)
+  {
+    if (len - pos >= want)
+      return true;
+
+    memmove(buf, buf + pos, len - pos);
+    len -= pos;
+    pos = 0;
+
+    size_t room = sizeof(buf) - len;
+    size_t n = fread(buf + len, 1, room < left ? room : left, in);
+    len += n;
+    left -= n;
+    return len >= want;
+  }
+
+  bool nextFrame()
+  {
+    LogFrameHeader h;
+    while (fill(sizeof(h) + 1))
+    {
+      memcpy(&h, buf + pos, sizeof(h));
+      if (logFrameCheckHeader(h) && fill(sizeof(h) + h.length) && logFrameCheck(buf + pos, len - pos))
+      {
+        if (haveSequence && h.sequence != sequence)
+          gap = true;
+        sequence = h.sequence + 1;
+        haveSequence = true;
+
+        pos += sizeof(h);
+        frameLeft = h.length;
+        return true;
+      }
+
+      pos++;
+      bad++;
+      gap = true;
+    }
+
+    bad += len - pos;
+    pos = len;
+    return false;
+  }
+
+  FILE *in;
+  uint64_t left;
+  bool framed;
+
+  uint8_t buf[2 * LOG_FRAME_MAX];
+  size_t len;
+  size_t pos;
+  size_t frameLeft;
+  uint32_t sequence;
+  bool haveSequence;
+  bool gap;
+  uint64_t bad;
+};
+
+// Passes on the records in range, returns false once past its end
+static bool emit(const TrackRecord &rec, const Range &range, Writer &writer)
+{
+  if (range.after(rec))
+    return false;
+  if (!range.before(rec))
+    writer.record(rec);
+  return true;
+}
+
+static long convertDelta(Source &source, const char *name, const Range &range, Writer &writer)
+{
+  TrackDecoder decoder;
+  uint8_t buf[4096];
+  size_t len = 0;
+  bool more = true;
+
+  while (more)
+  {
+    size_t n = source.read(buf + len, sizeof(buf) - len);
+    if (n == 0)
+      break;
+
+    // A frame of the journal is missing, what is buffered does not go on here
+    if (source.takeGap())
+    {
+      memmove(buf, buf + len, n);
+      len = 0;
+      decoder.reset();
+    }
+    len += n;
+
+    size_t pos = 0;
+    while (pos < len && more)
+    {
+      TrackRecord rec;
+      bool have;
+      size_t n = decoder.decode(buf + pos, len - pos, rec, have);
+      if (n == 0)
+        break;
+
+      pos += n;
+      if (have)
+        more = emit(rec, range, writer);
+    }
+
+    // What is left is the start of a frame, or a torn one at the end
+    memmove(buf, buf + pos, len - pos);
+    len -= pos;
+  }
+
+  if (decoder.skippedBytes() > 0 || (len > 0 && more))
+    fprintf(stderr, "trackconv: %s: skipped %lu damaged bytes, %lu resyncs, %lu torn bytes at the end\n",
+            name, (unsigned long)decoder.skippedBytes(), (unsigned long)decoder.resyncs(),
+            (unsigned long)len);
+  if (source.badBytes() > 0)
+    fprintf(stderr, "trackconv: %s: %lu bytes in no good journal frame\n", name,
+            (unsigned long)source.badBytes());
+
+  return decoder.records();
+}
+
+/*
+  Looks the start of the range up in the file's index and returns the
+  offset of the keyframe before it, or 0 if there is no index to use.
+*/
+static long indexedStart(const char *name, const Range &range)
+{
+  size_t len = strlen(name);
+  if (!range.hasFrom || len < 4 || strcmp(name + len - 4, ".trk"))
+    return 0;
+
+  char path[4096];
+  snprintf(path, sizeof(path), "%.*s.idx", (int)(len - 4), name);
+  FILE *f = fopen(path, "rb");
+  if (!f)
+    return 0;
+
+  LogIndexHeader header;
+  LogIndexEntry entry;
+  long offset = 0;
+
+  if (fread(&header, sizeof(header), 1, f) == 1 && logIndexCheckHeader(header))
+  {
+    auto read = [&](uint32_t i, LogIndexEntry &e)
+    {
+      return fseek(f, header.headerSize + (long)i * header.entrySize, SEEK_SET) == 0 &&
+             fread(&e, sizeof(e), 1, f) == 1;
+    };
+
+    fseek(f, 0, SEEK_END);
+    uint32_t count = (ftell(f) - header.headerSize) / header.entrySize;
+
+    // A time of day is on the day the log starts
+    int64_t from = range.from.ms;
+    if (range.from.timeOfDay && count > 0 && read(0, entry))
+      from += entry.key - timeOfDay(entry.key);
+
+    if (logIndexFind(count, from, read, entry))
+      offset = entry.offset;
+  }
+
+  fclose(f);
+  return offset;
+}
+
+// Returns the number of records, or -1 if the file is not a track log
+static long convert(FILE *in, const char *name, const Range &range, Writer &writer)
+{
+  TrackHeader header;
+  if (fread(&header, sizeof(header), 1, in) != 1 || !trackCheckHeader(header))
+  {
+    fprintf(stderr, "trackconv: %s is not a track log\n", name);
+    return -1;
+  }
+
+  // Skip any header fields a later version added
+  for (int skip = header.headerSize - (int)sizeof(header); skip > 0; skip--)
+    fgetc(in);
+
+  long start = indexedStart(name, range);
+  if (start > 0)
+    fseek(in, start, SEEK_SET);
+
+  // A preallocated log that was not closed cleanly ends before the file does
+  uint64_t position = start > 0 ? start : header.headerSize;
+  uint64_t left = header.length > position ? header.length - position
+                  : header.length > 0     ? 0
+                                          : UINT64_MAX;
+
+  Source source(in, left, trackFraming(header) == TRACK_FRAMING_JOURNAL);
+  if (trackEncoding(header) == TRACK_ENCODING_DELTA)
+    return convertDelta(source, name, range, writer);
+
+  unsigned char buf[256];
+  long count = 0;
+  for (;;)
+  {
+    // A record may span two frames of a journal
+    size_t got = 0, n;
+    while (got < header.recordSize && (n = source.read(buf + got, header.recordSize - got)) > 0)
+      got += n;
+    if (got < header.recordSize)
+      break;
+
+    TrackRecord rec;
+    memcpy(&rec, buf, sizeof(rec));
+    count++;
+    if (!emit(rec, range, writer))
+      break;
+  }
+
+  return count;
+}
+
+int main(int argc, char **argv)
+{
+  Format format = FORMAT_CSV;
+  Range range;
+  int first = 1;
+
+  while (first < argc && argv[first][0] == '-' && argv[first][1])
+  {
+    const char *opt = argv[first];
+    const char *value = first + 1 < argc ? argv[first + 1] : NULL;
+    if (!value)
+      usage();
+
+    if (!strcmp(opt, "-f"))
+    {
+      if (!strcmp(value, "csv"))
+        format = FORMAT_CSV;
+      else if (!strcmp(value, "gpx"))
+        format = FORMAT_GPX;
+      else if (!strcmp(value, "geojson"))
+        format = FORMAT_GEOJSON;
+      else
+        usage();
+    }
+    else if (!strcmp(opt, "-s") && parseLimit(value, range.from))
+      range.hasFrom = true;
+    else if (!strcmp(opt, "-e") && parseLimit(value, range.to))
+      range.hasTo = true;
+    else
+      usage();
+
+    first += 2;
+  }
+
+  Writer writer(format);
+  writer.begin();
+
+  int status = 0;
+  if (first == argc)
+  {
+    if (convert(stdin, "standard input", range, writer) < 0)
+      status = 1;
+  }
+
+  for (int i = first; i < argc; i++)
+  {
+    FILE *in = fopen(argv[i], "rb");
+    if (!in)
+    {
+      fprintf(stderr, "trackconv: cannot open %s\n", argv[i]);
+      status = 1;
+      continue;
+    }
+
+    if (convert(in, argv[i], range, writer) < 0)
+      status = 1;
+    fclose(in);
+  }
+
+  writer.end();
+  return status;
+}